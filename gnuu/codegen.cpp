@@ -21,13 +21,68 @@ void CodeGenContext::generateCode(NBlock& root)
 	ReturnInst::Create(getGlobalContext(), bblock);
 	popBlock();
 	
+	std::cout << "Code is generated.\n";
+	optimize();
+
 	/* Print the bytecode in a human-readable format 
 	   to see if our program compiled properly
 	 */
-	std::cout << "Code is generated.\n";
-	PassManager pm;
-	pm.add(createPrintModulePass(outs()));
-	pm.run(*module);
+	if (printIR) {
+		PassManager pm;
+		pm.add(createPrintModulePass(outs()));
+		pm.run(*module);
+	}
+}
+
+/* Optimize the module at optLevel: -O1 turns the allocas into SSA
+   values and cleans up each function, -O2 adds GVN, inlining and
+   the loop passes, -O3 inlines more and unrolls loops */
+void CodeGenContext::optimize()
+{
+	if (optLevel <= 0)
+		return;
+	std::cout << "Optimizing code at -O" << optLevel << "...\n";
+
+	FunctionPassManager fpm(module);
+	fpm.add(createPromoteMemoryToRegisterPass());
+	fpm.add(createSROAPass());
+	fpm.add(createEarlyCSEPass());
+	fpm.add(createInstructionCombiningPass());
+	fpm.add(createReassociatePass());
+	if (optLevel >= 2)
+		fpm.add(createGVNPass());
+	fpm.add(createCFGSimplificationPass());
+	fpm.doInitialization();
+	for (Module::iterator f = module->begin(); f != module->end(); f++) {
+		if (!f->isDeclaration())
+			fpm.run(*f);
+	}
+	fpm.doFinalization();
+
+	if (optLevel < 2)
+		return;
+
+	/* main is internal and nothing calls it, so the inliner
+	   would remove it as dead */
+	mainFunction->setLinkage(GlobalValue::ExternalLinkage);
+
+	PassManager mpm;
+	mpm.add(createFunctionInliningPass(optLevel >= 3 ? 275 : 225));
+	/* what was inlined brings its own allocas and loads */
+	mpm.add(createSROAPass());
+	mpm.add(createEarlyCSEPass());
+	mpm.add(createInstructionCombiningPass());
+	mpm.add(createCFGSimplificationPass());
+	mpm.add(createLoopRotatePass());
+	mpm.add(createLICMPass());
+	mpm.add(createIndVarSimplifyPass());
+	mpm.add(createLoopDeletionPass());
+	if (optLevel >= 3)
+		mpm.add(createLoopUnrollPass());
+	mpm.add(createGVNPass());
+	mpm.add(createInstructionCombiningPass());
+	mpm.add(createCFGSimplificationPass());
+	mpm.run(*module);
 }
 
 /* Executes the AST by running the main function */
@@ -6,6 +6,8 @@
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/PassManager.h>
+#include <llvm/Transforms/Scalar.h>
+#include <llvm/Transforms/IPO.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/CallingConv.h>
 #include <llvm/IR/IRPrintingPasses.h>
@@ -30,10 +32,13 @@ public:
 class CodeGenContext {
     std::stack<CodeGenBlock *> blocks;
     Function *mainFunction;
+    void optimize();
 
 public:
     Module *module;
-    CodeGenContext() { module = new Module("main", getGlobalContext()); }
+    int optLevel;       /* 0 to 3, as -O0 to -O3 */
+    bool printIR;       /* print the module before it is run */
+    CodeGenContext() { module = new Module("main", getGlobalContext()); optLevel = 0; printIR = false; }
     
     void generateCode(NBlock& root);
     GenericValue runCode();
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <string>
 #include "codegen.h"
 #include "node.h"
 
@@ -11,11 +12,27 @@ void createCoreFunctions(CodeGenContext& context);
 
 int main(int argc, char **argv)
 {
+	int optLevel = 0;
+	bool printIR = false;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg.size() == 3 && arg[0] == '-' && arg[1] == 'O' && arg[2] >= '0' && arg[2] <= '3')
+			optLevel = arg[2] - '0';
+		else if (arg == "-print-ir")
+			printIR = true;
+		else {
+			cerr << "usage: " << argv[0] << " [-O0 | -O1 | -O2 | -O3] [-print-ir] < program" << endl;
+			return 1;
+		}
+	}
+
 	yyparse();
 	cout << programBlock << endl;
     // see http://comments.gmane.org/gmane.comp.compilers.llvm.devel/33877
 	InitializeNativeTarget();
 	CodeGenContext context;
+	context.optLevel = optLevel;
+	context.printIR = printIR;
 	createCoreFunctions(context);
 	context.generateCode(*programBlock);
 	context.runCode();
@@ -9,55 +9,85 @@
 #include "globals.h"
 #include "symtab.h"
 #include "analyze.h"
+#include "arena.h"
+#include "stats.h"
 
-/* counter for variable memory locations */
-static int location = 0;
+/* ctx->location counts variable memory locations */
 
-/* Procedure traverse is a generic recursive 
+/* a traversal frame: the node and the index
+ * of the next child of it to visit; ctx->stack
+ * holds these, and only ever grows as deep as
+ * the statements are nested
+ */
+typedef struct FrameRec
+   { NodeId node;
+     int next;
+   } Frame;
+
+/* Procedure traverse is a generic iterative
  * syntax tree traversal routine:
  * it applies preProc in preorder and postProc 
- * in postorder to tree pointed to by t
+ * in postorder to tree n and its siblings.
+ * Siblings replace their predecessor's frame
+ * instead of being pushed, so a long statement
+ * sequence does not deepen the stack
  */
-static void traverse( TreeNode * t,
-               void (* preProc) (TreeNode *),
-               void (* postProc) (TreeNode *) )
-{ if (t != NULL)
-  { preProc(t);
-    { int i;
-      for (i=0; i < MAXCHILDREN; i++)
-        traverse(t->child[i],preProc,postProc);
+static void traverse( CompileCtx * ctx, NodeId n,
+               void (* preProc) (CompileCtx *, TreeNode *),
+               void (* postProc) (CompileCtx *, TreeNode *) )
+{ int depth = 0;
+  if (n == NIL_NODE) return;
+  if (ctx->maxdepth == 0)
+  { ctx->maxdepth = 64;
+    ctx->stack = (Frame *) malloc(ctx->maxdepth*sizeof(Frame));
+    countAlloc(ctx,ctx->maxdepth*sizeof(Frame));
+  }
+  ctx->stack[0].node = n;
+  ctx->stack[0].next = 0;
+  preProc(ctx,NODE(ctx,n));
+  while (depth >= 0)
+  { Frame * f = &ctx->stack[depth];
+    TreeNode * t = NODE(ctx,f->node);
+    if (f->next < MAXCHILDREN)
+    { NodeId c = t->child[f->next++];
+      if (c != NIL_NODE)
+      { if (++depth == ctx->maxdepth)
+        { ctx->maxdepth *= 2;
+          ctx->stack = (Frame *) realloc(ctx->stack,ctx->maxdepth*sizeof(Frame));
+          countAlloc(ctx,ctx->maxdepth*sizeof(Frame));
+        }
+        ctx->stack[depth].node = c;
+        ctx->stack[depth].next = 0;
+        preProc(ctx,NODE(ctx,c));
+      }
+    }
+    else
+    { postProc(ctx,t);
+      if (t->sibling != NIL_NODE)
+      { f->node = t->sibling;
+        f->next = 0;
+        preProc(ctx,NODE(ctx,f->node));
+      }
+      else depth--;
     }
-    postProc(t);
-    traverse(t->sibling,preProc,postProc);
   }
 }
 
-/* nullProc is a do-nothing procedure to 
- * generate preorder-only or postorder-only
- * traversals from traverse
- */
-static void nullProc(TreeNode * t)
-{ if (t==NULL) return;
-  else return;
-}
-
 /* Procedure insertNode inserts 
  * identifiers stored in t into 
  * the symbol table 
  */
-static void insertNode( TreeNode * t)
+static void insertNode( CompileCtx * ctx, TreeNode * t)
 { switch (t->nodekind)
   { case StmtK:
       switch (t->kind.stmt)
       { case AssignK:
         case ReadK:
-          if (st_lookup(t->attr.name) == -1)
-          /* not yet in table, so treat as new definition */
-            st_insert(t->attr.name,t->lineno,location++);
-          else
-          /* already in table, so ignore location, 
-             add line number of use only */ 
-            st_insert(t->attr.name,t->lineno,0);
+          /* location is used only if name is not yet in
+             the table, in which case it is a new definition;
+             otherwise just the line number of use is added */
+          if (st_insert(ctx,t->attr.sym,t->lineno,ctx->location))
+            ctx->location++;
           break;
         default:
           break;
@@ -66,13 +96,11 @@ static void insertNode( TreeNode * t)
     case ExpK:
       switch (t->kind.exp)
       { case IdK:
-          if (st_lookup(t->attr.name) == -1)
-          /* not yet in table, so treat as new definition */
-            st_insert(t->attr.name,t->lineno,location++);
-          else
-          /* already in table, so ignore location, 
-             add line number of use only */ 
-            st_insert(t->attr.name,t->lineno,0);
+          /* location is used only if name is not yet in
+             the table, in which case it is a new definition;
+             otherwise just the line number of use is added */
+          if (st_insert(ctx,t->attr.sym,t->lineno,ctx->location))
+            ctx->location++;
           break;
         default:
           break;
@@ -83,33 +111,40 @@ static void insertNode( TreeNode * t)
   }
 }
 
-/* Function buildSymtab constructs the symbol 
- * table by preorder traversal of the syntax tree
+/* a type error found during the pass; these are
+ * held back in ctx->typeErrors and listed after
+ * the symbol table, so the listing reads as it did
+ * when building the table and checking types were
+ * separate passes
  */
-void buildSymtab(TreeNode * syntaxTree)
-{ traverse(syntaxTree,insertNode,nullProc);
-  if (TraceAnalyze)
-  { fprintf(listing,"\nSymbol table:\n\n");
-    printSymTab(listing);
-  }
-}
+typedef struct TypeErrorRec
+   { int lineno;
+     char * message;
+   } TypeErrorRec;
 
-static void typeError(TreeNode * t, char * message)
-{ fprintf(listing,"Type error at line %d: %s\n",t->lineno,message);
-  Error = TRUE;
+static void typeError(CompileCtx * ctx, TreeNode * t, char * message)
+{ if (ctx->ntypeErrors == ctx->maxtypeErrors)
+  { ctx->maxtypeErrors = (ctx->maxtypeErrors == 0) ? 16 : 2*ctx->maxtypeErrors;
+    ctx->typeErrors = (TypeErrorRec *)
+       realloc(ctx->typeErrors,ctx->maxtypeErrors*sizeof(TypeErrorRec));
+    countAlloc(ctx,ctx->maxtypeErrors*sizeof(TypeErrorRec));
+  }
+  ctx->typeErrors[ctx->ntypeErrors].lineno = t->lineno;
+  ctx->typeErrors[ctx->ntypeErrors].message = message;
+  ctx->ntypeErrors++;
 }
 
 /* Procedure checkNode performs
  * type checking at a single tree node
  */
-static void checkNode(TreeNode * t)
+static void checkNode(CompileCtx * ctx, TreeNode * t)
 { switch (t->nodekind)
   { case ExpK:
       switch (t->kind.exp)
       { case OpK:
-          if ((t->child[0]->type != Integer) ||
-              (t->child[1]->type != Integer))
-            typeError(t,"Op applied to non-integer");
+          if ((NODE(ctx,t->child[0])->type != Integer) ||
+              (NODE(ctx,t->child[1])->type != Integer))
+            typeError(ctx,t,"Op applied to non-integer");
           if ((t->attr.op == EQ) || (t->attr.op == LT))
             t->type = Boolean;
           else
@@ -126,20 +161,20 @@ static void checkNode(TreeNode * t)
     case StmtK:
       switch (t->kind.stmt)
       { case IfK:
-          if (t->child[0]->type == Integer)
-            typeError(t->child[0],"if test is not Boolean");
+          if (NODE(ctx,t->child[0])->type == Integer)
+            typeError(ctx,NODE(ctx,t->child[0]),"if test is not Boolean");
           break;
         case AssignK:
-          if (t->child[0]->type != Integer)
-            typeError(t->child[0],"assignment of non-integer value");
+          if (NODE(ctx,t->child[0])->type != Integer)
+            typeError(ctx,NODE(ctx,t->child[0]),"assignment of non-integer value");
           break;
         case WriteK:
-          if (t->child[0]->type != Integer)
-            typeError(t->child[0],"write of non-integer value");
+          if (NODE(ctx,t->child[0])->type != Integer)
+            typeError(ctx,NODE(ctx,t->child[0]),"write of non-integer value");
           break;
         case RepeatK:
-          if (t->child[1]->type == Integer)
-            typeError(t->child[1],"repeat test is not Boolean");
+          if (NODE(ctx,t->child[1])->type == Integer)
+            typeError(ctx,NODE(ctx,t->child[1]),"repeat test is not Boolean");
           break;
         default:
           break;
@@ -151,9 +186,47 @@ static void checkNode(TreeNode * t)
   }
 }
 
-/* Procedure typeCheck performs type checking 
- * by a postorder syntax tree traversal
+/* Procedure analyzeStmt enters the identifiers
+ * of one top-level statement into the symbol
+ * table and checks its types; type errors are
+ * held back until analyzeEnd
+ */
+void analyzeStmt(CompileCtx * ctx, NodeId stmt)
+{ traverse(ctx,stmt,insertNode,checkNode); }
+
+/* Function analyzeFailed returns TRUE if some
+ * statement analyzed so far has a type error
+ */
+int analyzeFailed(CompileCtx * ctx)
+{ return ctx->ntypeErrors > 0; }
+
+/* Procedure analyzeEnd lists the symbol table
+ * (if TraceAnalyze) and the type errors of the
+ * statements analyzed so far, setting Error if
+ * there were any
+ */
+void analyzeEnd(CompileCtx * ctx)
+{ int i;
+  if (TraceAnalyze) fprintf(ctx->listing,"\nBuilding Symbol Table...\n");
+  if (TraceAnalyze)
+  { fprintf(ctx->listing,"\nSymbol table:\n\n");
+    printSymTab(ctx,ctx->listing);
+    fprintf(ctx->listing,"\nChecking Types...\n");
+  }
+  for (i=0;i<ctx->ntypeErrors;i++)
+    fprintf(ctx->listing,"Type error at line %d: %s\n",
+            ctx->typeErrors[i].lineno,ctx->typeErrors[i].message);
+  if (ctx->ntypeErrors > 0) ctx->Error = TRUE;
+  ctx->ntypeErrors = 0;
+  if (TraceAnalyze) fprintf(ctx->listing,"\nType Checking Finished\n");
+}
+
+/* Procedure analyze constructs the symbol table
+ * and performs type checking in a single traversal
+ * of the syntax tree: identifiers are inserted in
+ * preorder and types are checked in postorder
  */
-void typeCheck(TreeNode * syntaxTree)
-{ traverse(syntaxTree,nullProc,checkNode);
+void analyze(CompileCtx * ctx, NodeId syntaxTree)
+{ analyzeStmt(ctx,syntaxTree);
+  analyzeEnd(ctx);
 }
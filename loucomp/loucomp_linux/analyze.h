@@ -8,14 +8,36 @@
 #ifndef _ANALYZE_H_
 #define _ANALYZE_H_
 
-/* Function buildSymtab constructs the symbol 
- * table by preorder traversal of the syntax tree
+/* Procedure analyze constructs the symbol table
+ * and performs type checking in a single traversal
+ * of the syntax tree: identifiers are inserted in
+ * preorder and types are checked in postorder
  */
-void buildSymtab(TreeNode *);
+void analyze(CompileCtx *, NodeId);
 
-/* Procedure typeCheck performs type checking 
- * by a postorder syntax tree traversal
+/* In streaming mode the program is analyzed one
+ * top-level statement at a time: analyzeStmt for
+ * each statement, then analyzeEnd, which lists
+ * what analyze would have listed
  */
-void typeCheck(TreeNode *);
+
+/* Procedure analyzeStmt enters the identifiers
+ * of one top-level statement into the symbol
+ * table and checks its types; type errors are
+ * held back until analyzeEnd
+ */
+void analyzeStmt(CompileCtx *, NodeId);
+
+/* Function analyzeFailed returns TRUE if some
+ * statement analyzed so far has a type error
+ */
+int analyzeFailed(CompileCtx *);
+
+/* Procedure analyzeEnd lists the symbol table
+ * (if TraceAnalyze) and the type errors of the
+ * statements analyzed so far, setting Error if
+ * there were any
+ */
+void analyzeEnd(CompileCtx *);
 
 #endif
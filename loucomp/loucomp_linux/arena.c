@@ -0,0 +1,111 @@
+/****************************************************/
+/* File: arena.c                                    */
+/* Node and string arena implementation             */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "globals.h"
+#include "arena.h"
+#include "stats.h"
+
+/* INITNODES is the initial capacity of the node
+ * array; it doubles each time it fills up
+ */
+#define INITNODES 1024
+
+/* STRBLOCK is the size of each block of string
+ * storage; longer strings get a block of their own
+ */
+#define STRBLOCK 65536
+
+/* the blocks of string storage, newest first */
+typedef struct StrBlockRec
+   { struct StrBlockRec * next;
+     int used;
+     int size;
+   } * StrBlock;
+
+/* Function allocNode returns the index of a fresh
+ * zero-filled node, or NIL_NODE if out of memory
+ */
+NodeId allocNode(CompileCtx * ctx)
+{ if (ctx->nodeTop >= ctx->nodeCap)
+  { NodeId n = (ctx->nodeCap == 0) ? INITNODES : 2*ctx->nodeCap;
+    TreeNode * a = (TreeNode *) realloc(ctx->nodeArena,n*sizeof(TreeNode));
+    if ((a == NULL) || (n <= ctx->nodeCap)) return NIL_NODE;
+    countAlloc(ctx,n*sizeof(TreeNode));
+    ctx->nodeArena = a;
+    ctx->nodeCap = n;
+  }
+  memset(&ctx->nodeArena[ctx->nodeTop],0,sizeof(TreeNode));
+  return ctx->nodeTop++;
+}
+
+/* Function nodeCount returns the number of nodes
+ * currently allocated in the arena
+ */
+NodeId nodeCount(CompileCtx * ctx)
+{ return ctx->nodeTop-1; }
+
+/* Function allocString returns n bytes of string
+ * storage from the arena, or NULL if out of memory.
+ * Unlike nodes, strings never move
+ */
+char * allocString(CompileCtx * ctx, int n)
+{ StrBlock b = ctx->strBlocks;
+  if ((b == NULL) || (b->size - b->used < n))
+  { int size = (n > STRBLOCK) ? n : STRBLOCK;
+    b = (StrBlock) malloc(sizeof(struct StrBlockRec)+size);
+    if (b == NULL) return NULL;
+    countAlloc(ctx,sizeof(struct StrBlockRec)+size);
+    b->used = 0;
+    b->size = size;
+    b->next = ctx->strBlocks;
+    ctx->strBlocks = b;
+  }
+  b->used += n;
+  return (char *) (b+1) + b->used - n;
+}
+
+/* Procedure resetNodes gives back every node
+ * allocated so far, keeping the array and all
+ * strings; NodeIds handed out earlier become
+ * invalid
+ */
+void resetNodes(CompileCtx * ctx)
+{ ctx->nodesReleased += ctx->nodeTop-1;
+  ctx->nodeTop = 1;
+}
+
+/* Procedure resetArena gives back every node and
+ * string allocated so far, keeping the array and
+ * one block of strings for the next compilation
+ */
+void resetArena(CompileCtx * ctx)
+{ StrBlock b = ctx->strBlocks;
+  if (b != NULL)
+  { while (b->next != NULL)
+    { StrBlock n = b->next;
+      b->next = n->next;
+      free(n);
+    }
+    b->used = 0;
+  }
+  ctx->nodeTop = 1;
+  ctx->nodesReleased = 0;
+}
+
+/* Procedure freeArena releases all nodes and strings
+ * allocated so far; the arena may be reused afterwards
+ */
+void freeArena(CompileCtx * ctx)
+{ while (ctx->strBlocks != NULL)
+  { StrBlock b = ctx->strBlocks;
+    ctx->strBlocks = b->next;
+    free(b);
+  }
+  free(ctx->nodeArena);
+  ctx->nodeArena = NULL;
+  ctx->nodeTop = 1;
+  ctx->nodeCap = 0;
+}
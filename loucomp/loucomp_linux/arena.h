@@ -0,0 +1,59 @@
+/****************************************************/
+/* File: arena.h                                    */
+/* Node and string arena for the TINY compiler      */
+/* Syntax tree nodes live in one contiguous array   */
+/* and are linked by 32-bit indices (NodeId);       */
+/* strings are carved out of large blocks. All of   */
+/* it is released by a single call to freeArena     */
+/****************************************************/
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+/* ctx->nodeArena is the contiguous array holding
+ * every syntax tree node; slot 0 is never handed out
+ * (newContext starts nodeTop at 1) so that NIL_NODE
+ * can play the role of NULL
+ */
+
+/* NODE maps a NodeId to the node it names. The
+ * pointer it yields is only valid until the next
+ * call to allocNode, which may move the array
+ */
+#define NODE(ctx,id) (&(ctx)->nodeArena[id])
+
+/* Function allocNode returns the index of a fresh
+ * zero-filled node, or NIL_NODE if out of memory
+ */
+NodeId allocNode(CompileCtx * ctx);
+
+/* Function nodeCount returns the number of nodes
+ * currently allocated in the arena
+ */
+NodeId nodeCount(CompileCtx * ctx);
+
+/* Function allocString returns n bytes of string
+ * storage from the arena, or NULL if out of memory.
+ * Unlike nodes, strings never move
+ */
+char * allocString(CompileCtx * ctx, int n);
+
+/* Procedure resetNodes gives back every node
+ * allocated so far, keeping the array and all
+ * strings; NodeIds handed out earlier become
+ * invalid
+ */
+void resetNodes(CompileCtx * ctx);
+
+/* Procedure resetArena gives back every node and
+ * string allocated so far, keeping the array and
+ * one block of strings for the next compilation
+ */
+void resetArena(CompileCtx * ctx);
+
+/* Procedure freeArena releases all nodes and strings
+ * allocated so far; the arena may be reused afterwards
+ */
+void freeArena(CompileCtx * ctx);
+
+#endif
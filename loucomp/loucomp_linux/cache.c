@@ -0,0 +1,161 @@
+/****************************************************/
+/* File: cache.c                                    */
+/* Content-addressed compilation cache              */
+/* implementation for the TINY compiler             */
+/****************************************************/
+
+#include "globals.h"
+#include "cache.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/* the first line of every cache entry */
+#define CACHEMAGIC "TINYCACHE 1\n"
+
+/* Two unrelated 64-bit hashes make up the key:
+ * FNV-1a, and a multiply-rotate hash seeded
+ * differently. They are run over the version,
+ * the options and the source bytes, each
+ * terminated so that they cannot run together
+ */
+typedef struct
+   { unsigned long long h1;
+     unsigned long long h2;
+   } Hash;
+
+static void hashBytes( Hash * h, const char * p, size_t n )
+{ size_t i;
+  for (i=0;i<n;i++)
+  { unsigned char c = (unsigned char) p[i];
+    h->h1 = (h->h1 ^ c) * 0x100000001b3ULL;
+    h->h2 = (h->h2 + c + 1) * 0x9e3779b97f4a7c15ULL;
+    h->h2 = (h->h2 << 23) | (h->h2 >> 41);
+  }
+}
+
+static void hashString( Hash * h, const char * s )
+{ hashBytes(h,s,strlen(s)+1); }
+
+/* Function cacheKey computes the cache key of
+ * the program in file source, compiled with the
+ * given options, into key (CACHEKEYLEN+1 chars).
+ * source is rewound afterwards. Returns FALSE if
+ * the source could not be read
+ */
+int cacheKey( char * key, FILE * source, const char * options )
+{ Hash h;
+  char buf[4096];
+  size_t n;
+  h.h1 = 0xcbf29ce484222325ULL;
+  h.h2 = 0x243f6a8885a308d3ULL;
+  hashString(&h,TINYVERSION);
+  hashString(&h,options);
+  while ((n = fread(buf,1,sizeof(buf),source)) > 0)
+    hashBytes(&h,buf,n);
+  if (ferror(source)) return FALSE;
+  rewind(source);
+  /* mix the tails so that every input bit
+     reaches every bit of the key */
+  h.h1 ^= h.h1 >> 33; h.h1 *= 0xff51afd7ed558ccdULL; h.h1 ^= h.h1 >> 33;
+  h.h2 ^= h.h2 >> 29; h.h2 *= 0xc4ceb9fe1a85ec53ULL; h.h2 ^= h.h2 >> 32;
+  sprintf(key,"%016llx%016llx",h.h1,h.h2);
+  return TRUE;
+}
+
+/* copyBytes copies n bytes (or up to EOF if n
+   is negative) from in to out; returns FALSE
+   if in ended early or out could not be written */
+static int copyBytes( FILE * in, FILE * out, long n )
+{ char buf[4096];
+  while (n != 0)
+  { size_t want = ((n < 0) || (n > (long) sizeof(buf))) ? sizeof(buf) : (size_t) n;
+    size_t got = fread(buf,1,want,in);
+    if (got == 0) return n < 0;
+    if (fwrite(buf,1,got,out) != got) return FALSE;
+    if (n > 0) n -= got;
+  }
+  return TRUE;
+}
+
+/* entryName builds the file name of an entry */
+static void entryName( char * name, const char * dir, const char * key )
+{ sprintf(name,"%s/%s",dir,key); }
+
+/* Function cacheFetch looks key up in the cache
+ * directory dir. On a hit it copies the cached
+ * listing to listing and the cached code, if any,
+ * to codefile, and returns TRUE
+ */
+int cacheFetch( const char * dir, const char * key,
+                FILE * listing, const char * codefile )
+{ char * name = (char *) malloc(strlen(dir)+CACHEKEYLEN+2);
+  char magic[sizeof(CACHEMAGIC)];
+  FILE * entry;
+  long listLen, codeLen;
+  int ok = FALSE;
+  entryName(name,dir,key);
+  entry = fopen(name,"rb");
+  free(name);
+  if (entry == NULL) return FALSE;
+  if ((fgets(magic,sizeof(magic),entry) != NULL) &&
+      (strcmp(magic,CACHEMAGIC) == 0) &&
+      (fscanf(entry,"%ld %ld",&listLen,&codeLen) == 2) &&
+      (getc(entry) == '\n'))
+  { /* write the code first: a listing is only
+       produced once the entry proved complete */
+    ok = TRUE;
+    if ((codeLen >= 0) && (codefile != NULL))
+    { FILE * code;
+      fseek(entry,listLen,SEEK_CUR);
+      code = fopen(codefile,"w");
+      ok = (code != NULL) && copyBytes(entry,code,codeLen);
+      if (code != NULL) fclose(code);
+      fseek(entry,-(listLen+codeLen),SEEK_CUR);
+    }
+    ok = ok && copyBytes(entry,listing,listLen);
+  }
+  fclose(entry);
+  return ok;
+}
+
+/* Procedure cacheStore enters the listing read
+ * from listing (from its start) and the code in
+ * codefile (NULL if none was written) under key
+ * in the cache directory dir. Entries appear
+ * atomically, so concurrent compilations may
+ * share a directory
+ */
+void cacheStore( const char * dir, const char * key,
+                 FILE * listing, const char * codefile )
+{ char * name = (char *) malloc(strlen(dir)+CACHEKEYLEN+2);
+  char * tmpname = (char *) malloc(strlen(dir)+CACHEKEYLEN+48);
+  FILE * code = NULL;
+  FILE * entry;
+  long listLen, codeLen = -1;
+  int ok;
+  entryName(name,dir,key);
+  sprintf(tmpname,"%s.%ld.%lx",name,(long) getpid(),
+          (unsigned long) pthread_self());
+  fseek(listing,0,SEEK_END);
+  listLen = ftell(listing);
+  if (codefile != NULL)
+  { code = fopen(codefile,"r");
+    if (code != NULL)
+    { fseek(code,0,SEEK_END);
+      codeLen = ftell(code);
+      rewind(code);
+    }
+  }
+  entry = fopen(tmpname,"wb");
+  if (entry != NULL)
+  { rewind(listing);
+    fprintf(entry,"%s%ld %ld\n",CACHEMAGIC,listLen,codeLen);
+    ok = copyBytes(listing,entry,listLen);
+    if (code != NULL) ok = ok && copyBytes(code,entry,codeLen);
+    ok = (fclose(entry) == 0) && ok;
+    if (!ok || (rename(tmpname,name) != 0)) remove(tmpname);
+  }
+  if (code != NULL) fclose(code);
+  free(tmpname);
+  free(name);
+}
@@ -0,0 +1,51 @@
+/****************************************************/
+/* File: cache.h                                    */
+/* Content-addressed compilation cache interface    */
+/* for the TINY compiler                            */
+/* A cache entry is named by a hash of the source   */
+/* bytes, the compiler version and the options, and */
+/* holds the listing and the TM code of the run     */
+/****************************************************/
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+/* TINYVERSION identifies the compiler in cache keys;
+ * change it whenever the listing or the generated
+ * code for some program changes, so that entries
+ * made by older compilers are no longer used
+ */
+#define TINYVERSION "TINY 1.6"
+
+/* CACHEKEYLEN is the length of a cache key
+ * (128 bits in hex), not counting the '\0'
+ */
+#define CACHEKEYLEN 32
+
+/* Function cacheKey computes the cache key of
+ * the program in file source, compiled with the
+ * given options, into key (CACHEKEYLEN+1 chars).
+ * source is rewound afterwards. Returns FALSE if
+ * the source could not be read
+ */
+int cacheKey( char * key, FILE * source, const char * options );
+
+/* Function cacheFetch looks key up in the cache
+ * directory dir. On a hit it copies the cached
+ * listing to listing and the cached code, if any,
+ * to codefile, and returns TRUE
+ */
+int cacheFetch( const char * dir, const char * key,
+                FILE * listing, const char * codefile );
+
+/* Procedure cacheStore enters the listing read
+ * from listing (from its start) and the code in
+ * codefile (NULL if none was written) under key
+ * in the cache directory dir. Entries appear
+ * atomically, so concurrent compilations may
+ * share a directory
+ */
+void cacheStore( const char * dir, const char * key,
+                 FILE * listing, const char * codefile );
+
+#endif
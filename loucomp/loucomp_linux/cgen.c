@@ -11,83 +11,184 @@
 #include "symtab.h"
 #include "code.h"
 #include "cgen.h"
+#include "cse.h"
+#include "arena.h"
+#include "stats.h"
+#include "tmeng.h"
 
-/* tmpOffset is the memory offset for temps
+/* ctx->tmpOffset is the memory offset for temps
    It is decremented each time a temp is
-   stored, and incremeted when loaded again
+   stored, and incremeted when loaded again;
+   with ctx->optimize, temps start below the
+   CSESLOTS temporaries of cse.c
 */
-static int tmpOffset = 0;
+
+/* With a profile (ctx->profile), the arm of an if
+   that ran most often follows its test, and the
+   other arm is placed after the HALT at the end of
+   the program, from where it jumps back: the path
+   that runs most is straight-line code, and pays
+   no jump over the other arm. The profile counts
+   the runs of the plain code, so codeGen first
+   makes the plain code without writing it, to
+   learn where the jump of each if was
+*/
+
+#define HOT_NONE 0 /* not in the profile: plain layout */
+#define HOT_THEN 1 /* the then part ran most */
+#define HOT_ELSE 2 /* the else part ran most */
+
+/* an arm placed after the end of the program */
+typedef struct
+   { NodeId arm; /* its statements */
+     int jump; /* location of the jump to it */
+     char * op; /* that jump: JEQ or JNE */
+     int back; /* location it jumps back to */
+     int line; /* source line of the if */
+   } ColdArm;
+
+typedef struct LayoutRec
+   { int planning; /* TRUE while the plain code is made */
+     NodeId nnodes; /* entries in jumpLoc and hot */
+     int * jumpLoc; /* plain location of each if's jump, or -1 */
+     char * hot; /* HOT_NONE, HOT_THEN or HOT_ELSE of each if */
+     ColdArm * cold; /* arms left for codeGenEnd */
+     int ncold;
+     int maxcold;
+   } LayoutRec;
 
 /* prototype for internal recursive code generator */
-static void cGen (TreeNode * tree);
+static void cGen (CompileCtx * ctx, NodeId tree);
+
+/* Procedure deferArm leaves arm, reached by the
+ * op jump at location jump, for codeGenEnd to
+ * place; it then jumps back to location back
+ */
+static void deferArm( CompileCtx * ctx, NodeId arm, int jump, char * op, int back)
+{ LayoutRec * l = ctx->layout;
+  if (l->ncold == l->maxcold)
+  { int size = l->maxcold ? 2*l->maxcold : 16;
+    ColdArm * cold = (ColdArm *) realloc(l->cold,size*sizeof(ColdArm));
+    if (cold == NULL)
+    { fprintf(ctx->listing,"Out of memory laying out code\n");
+      ctx->Error = TRUE;
+      return;
+    }
+    countAlloc(ctx,(size-l->maxcold)*sizeof(ColdArm));
+    l->cold = cold;
+    l->maxcold = size;
+  }
+  l->cold[l->ncold].arm = arm;
+  l->cold[l->ncold].jump = jump;
+  l->cold[l->ncold].op = op;
+  l->cold[l->ncold].back = back;
+  l->cold[l->ncold].line = ctx->codeLine;
+  l->ncold++;
+} /* deferArm */
+
+/* Procedure genHotIf generates code at an if node
+ * whose arm hot ran most often: the test jumps to
+ * the other arm, which is deferred, and the hot
+ * arm follows the test. An if without an else
+ * whose then part runs most just jumps over it
+ */
+static void genHotIf( CompileCtx * ctx, TreeNode * tree, int hot)
+{ NodeId hotArm = (hot == HOT_THEN) ? tree->child[1] : tree->child[2];
+  NodeId coldArm = (hot == HOT_THEN) ? tree->child[2] : tree->child[1];
+  /* the test leaves 0 for the else part */
+  char * op = (hot == HOT_THEN) ? "JEQ" : "JNE";
+  int savedLoc,currentLoc;
+  if (TraceCode) emitComment(ctx,"-> if") ;
+  /* generate code for test expression */
+  cGen(ctx,tree->child[0]);
+  savedLoc = emitSkip(ctx,1) ;
+  emitComment(ctx,"if: jump to cold part belongs here");
+  /* recurse on the part that ran most */
+  cGen(ctx,hotArm);
+  currentLoc = emitSkip(ctx,0) ;
+  if (coldArm == NIL_NODE)
+  { emitBackup(ctx,savedLoc) ;
+    emitRM_Abs(ctx,op,ac,currentLoc,"if: jmp to end");
+    emitRestore(ctx) ;
+  }
+  else deferArm(ctx,coldArm,savedLoc,op,currentLoc);
+  if (TraceCode)  emitComment(ctx,"<- if") ;
+} /* genHotIf */
 
 /* Procedure genStmt generates code at a statement node */
-static void genStmt( TreeNode * tree)
-{ TreeNode * p1, * p2, * p3;
+static void genStmt( CompileCtx * ctx, NodeId n)
+{ TreeNode * tree = NODE(ctx,n);
+  LayoutRec * l = ctx->layout;
+  NodeId p1, p2, p3;
   int savedLoc1,savedLoc2,currentLoc;
   int loc;
   switch (tree->kind.stmt) {
 
       case IfK :
-         if (TraceCode) emitComment("-> if") ;
+         if ((l != NULL) && (l->hot[n] != HOT_NONE))
+         { genHotIf(ctx,tree,l->hot[n]);
+           break;
+         }
+         if (TraceCode) emitComment(ctx,"-> if") ;
          p1 = tree->child[0] ;
          p2 = tree->child[1] ;
          p3 = tree->child[2] ;
          /* generate code for test expression */
-         cGen(p1);
-         savedLoc1 = emitSkip(1) ;
-         emitComment("if: jump to else belongs here");
+         cGen(ctx,p1);
+         savedLoc1 = emitSkip(ctx,1) ;
+         if ((l != NULL) && l->planning) l->jumpLoc[n] = savedLoc1;
+         emitComment(ctx,"if: jump to else belongs here");
          /* recurse on then part */
-         cGen(p2);
-         savedLoc2 = emitSkip(1) ;
-         emitComment("if: jump to end belongs here");
-         currentLoc = emitSkip(0) ;
-         emitBackup(savedLoc1) ;
-         emitRM_Abs("JEQ",ac,currentLoc,"if: jmp to else");
-         emitRestore() ;
+         cGen(ctx,p2);
+         savedLoc2 = emitSkip(ctx,1) ;
+         emitComment(ctx,"if: jump to end belongs here");
+         currentLoc = emitSkip(ctx,0) ;
+         emitBackup(ctx,savedLoc1) ;
+         emitRM_Abs(ctx,"JEQ",ac,currentLoc,"if: jmp to else");
+         emitRestore(ctx) ;
          /* recurse on else part */
-         cGen(p3);
-         currentLoc = emitSkip(0) ;
-         emitBackup(savedLoc2) ;
-         emitRM_Abs("LDA",pc,currentLoc,"jmp to end") ;
-         emitRestore() ;
-         if (TraceCode)  emitComment("<- if") ;
+         cGen(ctx,p3);
+         currentLoc = emitSkip(ctx,0) ;
+         emitBackup(ctx,savedLoc2) ;
+         emitRM_Abs(ctx,"LDA",pc,currentLoc,"jmp to end") ;
+         emitRestore(ctx) ;
+         if (TraceCode)  emitComment(ctx,"<- if") ;
          break; /* if_k */
 
       case RepeatK:
-         if (TraceCode) emitComment("-> repeat") ;
+         if (TraceCode) emitComment(ctx,"-> repeat") ;
          p1 = tree->child[0] ;
          p2 = tree->child[1] ;
-         savedLoc1 = emitSkip(0);
-         emitComment("repeat: jump after body comes back here");
+         savedLoc1 = emitSkip(ctx,0);
+         emitComment(ctx,"repeat: jump after body comes back here");
          /* generate code for body */
-         cGen(p1);
+         cGen(ctx,p1);
          /* generate code for test */
-         cGen(p2);
-         emitRM_Abs("JEQ",ac,savedLoc1,"repeat: jmp back to body");
-         if (TraceCode)  emitComment("<- repeat") ;
+         cGen(ctx,p2);
+         emitRM_Abs(ctx,"JEQ",ac,savedLoc1,"repeat: jmp back to body");
+         if (TraceCode)  emitComment(ctx,"<- repeat") ;
          break; /* repeat */
 
       case AssignK:
-         if (TraceCode) emitComment("-> assign") ;
+         if (TraceCode) emitComment(ctx,"-> assign") ;
          /* generate code for rhs */
-         cGen(tree->child[0]);
+         cGen(ctx,tree->child[0]);
          /* now store value */
-         loc = st_lookup(tree->attr.name);
-         emitRM("ST",ac,loc,gp,"assign: store value");
-         if (TraceCode)  emitComment("<- assign") ;
+         loc = st_lookup(ctx,tree->attr.sym);
+         emitRM(ctx,"ST",ac,loc,gp,"assign: store value");
+         if (TraceCode)  emitComment(ctx,"<- assign") ;
          break; /* assign_k */
 
       case ReadK:
-         emitRO("IN",ac,0,0,"read integer value");
-         loc = st_lookup(tree->attr.name);
-         emitRM("ST",ac,loc,gp,"read: store value");
+         emitRO(ctx,"IN",ac,0,0,"read integer value");
+         loc = st_lookup(ctx,tree->attr.sym);
+         emitRM(ctx,"ST",ac,loc,gp,"read: store value");
          break;
       case WriteK:
          /* generate code for expression to write */
-         cGen(tree->child[0]);
+         cGen(ctx,tree->child[0]);
          /* now output it */
-         emitRO("OUT",ac,0,0,"write ac");
+         emitRO(ctx,"OUT",ac,0,0,"write ac");
          break;
       default:
          break;
@@ -95,69 +196,76 @@ static void genStmt( TreeNode * tree)
 } /* genStmt */
 
 /* Procedure genExp generates code at an expression node */
-static void genExp( TreeNode * tree)
-{ int loc;
-  TreeNode * p1, * p2;
+static void genExp( CompileCtx * ctx, NodeId n)
+{ TreeNode * tree = NODE(ctx,n);
+  int loc;
+  NodeId p1, p2;
   switch (tree->kind.exp) {
 
     case ConstK :
-      if (TraceCode) emitComment("-> Const") ;
+      if (TraceCode) emitComment(ctx,"-> Const") ;
       /* gen code to load integer constant using LDC */
-      emitRM("LDC",ac,tree->attr.val,0,"load const");
-      if (TraceCode)  emitComment("<- Const") ;
+      emitRM(ctx,"LDC",ac,tree->attr.val,0,"load const");
+      if (TraceCode)  emitComment(ctx,"<- Const") ;
       break; /* ConstK */
     
     case IdK :
-      if (TraceCode) emitComment("-> Id") ;
-      loc = st_lookup(tree->attr.name);
-      emitRM("LD",ac,loc,gp,"load id value");
-      if (TraceCode)  emitComment("<- Id") ;
+      if (TraceCode) emitComment(ctx,"-> Id") ;
+      loc = st_lookup(ctx,tree->attr.sym);
+      emitRM(ctx,"LD",ac,loc,gp,"load id value");
+      if (TraceCode)  emitComment(ctx,"<- Id") ;
       break; /* IdK */
 
     case OpK :
-         if (TraceCode) emitComment("-> Op") ;
+         if (TraceCode) emitComment(ctx,"-> Op") ;
+         /* a value computed before is not computed again */
+         if (ctx->optimize && cseLoad(ctx,n))
+         { if (TraceCode)  emitComment(ctx,"<- Op") ;
+           break;
+         }
          p1 = tree->child[0];
          p2 = tree->child[1];
          /* gen code for ac = left arg */
-         cGen(p1);
+         cGen(ctx,p1);
          /* gen code to push left operand */
-         emitRM("ST",ac,tmpOffset--,mp,"op: push left");
+         emitRM(ctx,"ST",ac,ctx->tmpOffset--,mp,"op: push left");
          /* gen code for ac = right operand */
-         cGen(p2);
+         cGen(ctx,p2);
          /* now load left operand */
-         emitRM("LD",ac1,++tmpOffset,mp,"op: load left");
+         emitRM(ctx,"LD",ac1,++ctx->tmpOffset,mp,"op: load left");
          switch (tree->attr.op) {
             case PLUS :
-               emitRO("ADD",ac,ac1,ac,"op +");
+               emitRO(ctx,"ADD",ac,ac1,ac,"op +");
                break;
             case MINUS :
-               emitRO("SUB",ac,ac1,ac,"op -");
+               emitRO(ctx,"SUB",ac,ac1,ac,"op -");
                break;
             case TIMES :
-               emitRO("MUL",ac,ac1,ac,"op *");
+               emitRO(ctx,"MUL",ac,ac1,ac,"op *");
                break;
             case OVER :
-               emitRO("DIV",ac,ac1,ac,"op /");
+               emitRO(ctx,"DIV",ac,ac1,ac,"op /");
                break;
             case LT :
-               emitRO("SUB",ac,ac1,ac,"op <") ;
-               emitRM("JLT",ac,2,pc,"br if true") ;
-               emitRM("LDC",ac,0,ac,"false case") ;
-               emitRM("LDA",pc,1,pc,"unconditional jmp") ;
-               emitRM("LDC",ac,1,ac,"true case") ;
+               emitRO(ctx,"SUB",ac,ac1,ac,"op <") ;
+               emitRM(ctx,"JLT",ac,2,pc,"br if true") ;
+               emitRM(ctx,"LDC",ac,0,ac,"false case") ;
+               emitRM(ctx,"LDA",pc,1,pc,"unconditional jmp") ;
+               emitRM(ctx,"LDC",ac,1,ac,"true case") ;
                break;
             case EQ :
-               emitRO("SUB",ac,ac1,ac,"op ==") ;
-               emitRM("JEQ",ac,2,pc,"br if true");
-               emitRM("LDC",ac,0,ac,"false case") ;
-               emitRM("LDA",pc,1,pc,"unconditional jmp") ;
-               emitRM("LDC",ac,1,ac,"true case") ;
+               emitRO(ctx,"SUB",ac,ac1,ac,"op ==") ;
+               emitRM(ctx,"JEQ",ac,2,pc,"br if true");
+               emitRM(ctx,"LDC",ac,0,ac,"false case") ;
+               emitRM(ctx,"LDA",pc,1,pc,"unconditional jmp") ;
+               emitRM(ctx,"LDC",ac,1,ac,"true case") ;
                break;
             default:
-               emitComment("BUG: Unknown operator");
+               emitComment(ctx,"BUG: Unknown operator");
                break;
          } /* case op */
-         if (TraceCode)  emitComment("<- Op") ;
+         if (ctx->optimize) cseSave(ctx,n);
+         if (TraceCode)  emitComment(ctx,"<- Op") ;
          break; /* OpK */
 
     default:
@@ -166,22 +274,76 @@ static void genExp( TreeNode * tree)
 } /* genExp */
 
 /* Procedure cGen recursively generates code by
- * tree traversal
+ * tree traversal; it recurses into children only,
+ * and walks a sequence of siblings in a loop
  */
-static void cGen( TreeNode * tree)
-{ if (tree != NULL)
-  { switch (tree->nodekind) {
+static void cGen( CompileCtx * ctx, NodeId n)
+{ int line = ctx->codeLine;
+  while (n != NIL_NODE)
+  { TreeNode * tree = NODE(ctx,n);
+    /* the code made here is that of tree's line */
+    ctx->codeLine = tree->lineno;
+    switch (tree->nodekind) {
       case StmtK:
-        genStmt(tree);
+        genStmt(ctx,n);
         break;
       case ExpK:
-        genExp(tree);
+        genExp(ctx,n);
         break;
       default:
         break;
     }
-    cGen(tree->sibling);
+    n = tree->sibling;
   }
+  ctx->codeLine = line;
+}
+
+/* Procedure planLayout makes the plain code of
+ * tree, without writing or keeping it, to find the
+ * location of the jump of each if, and reads in
+ * ctx->profile which arm of each ran most
+ */
+static void planLayout(CompileCtx * ctx, NodeId tree, char * codefile)
+{  TMPROFILE * p = ctx->profile;
+   FILE * code = ctx->code;
+   int keepImage = ctx->keepImage;
+   long ninstructions = ctx->ninstructions;
+   LayoutRec * l;
+   NodeId n;
+   int loc;
+   l = (LayoutRec *) calloc(1,sizeof(LayoutRec));
+   if (l == NULL) return;
+   l->nnodes = ctx->nodeTop;
+   l->jumpLoc = (int *) malloc(l->nnodes*sizeof(int));
+   l->hot = (char *) calloc(l->nnodes,1);
+   if ((l->jumpLoc == NULL) || (l->hot == NULL))
+   { free(l->jumpLoc);
+     free(l->hot);
+     free(l);
+     return;
+   }
+   countAlloc(ctx,sizeof(LayoutRec)+l->nnodes*(sizeof(int)+1));
+   for (n = 0; n < l->nnodes; n++) l->jumpLoc[n] = -1;
+   ctx->layout = l;
+   l->planning = TRUE;
+   ctx->code = NULL;
+   ctx->keepImage = FALSE;
+   codeGenBegin(ctx,codefile);
+   cGen(ctx,tree);
+   codeGenEnd(ctx);
+   ctx->code = code;
+   ctx->keepImage = keepImage;
+   ctx->ninstructions = ninstructions;
+   ctx->emitLoc = ctx->highEmitLoc = 0;
+   ctx->tmpOffset = 0;
+   l->planning = FALSE;
+   for (n = 0; n < l->nnodes; n++)
+   { loc = l->jumpLoc[n];
+     /* the jump is taken to run the else part */
+     if ((loc >= 0) && (loc < p->size) && (p->counts[loc] > 0))
+       l->hot[n] = (p->counts[loc]-p->taken[loc] >= p->taken[loc])
+                   ? HOT_THEN : HOT_ELSE;
+   }
 }
 
 /**********************************************/
@@ -193,20 +355,84 @@ static void cGen( TreeNode * tree)
  * of the code file, and is used to print the
  * file name as a comment in the code file
  */
-void codeGen(TreeNode * syntaxTree, char * codefile)
+void codeGen(CompileCtx * ctx, NodeId syntaxTree, char * codefile)
+{  if (ctx->optimize) cseAnalyze(ctx,syntaxTree);
+   if (ctx->profile != NULL) planLayout(ctx,syntaxTree,codefile);
+   codeGenBegin(ctx,codefile);
+   /* generate code for TINY program */
+   cGen(ctx,syntaxTree);
+   codeGenEnd(ctx);
+}
+
+/* Procedure codeGenBegin emits the heading and
+ * the standard prelude to the code file
+ */
+void codeGenBegin(CompileCtx * ctx, char * codefile)
 {  char * s = malloc(strlen(codefile)+7);
+   countAlloc(ctx,strlen(codefile)+7);
    strcpy(s,"File: ");
    strcat(s,codefile);
-   emitComment("TINY Compilation to TM Code");
-   emitComment(s);
+   emitComment(ctx,"TINY Compilation to TM Code");
+   emitComment(ctx,s);
    /* generate standard prelude */
-   emitComment("Standard prelude:");
-   emitRM("LD",mp,0,ac,"load maxaddress from location 0");
-   emitRM("ST",ac,0,ac,"clear location 0");
-   emitComment("End of standard prelude.");
-   /* generate code for TINY program */
-   cGen(syntaxTree);
-   /* finish */
-   emitComment("End of execution.");
-   emitRO("HALT",0,0,0,"");
+   emitComment(ctx,"Standard prelude:");
+   emitRM(ctx,"LD",mp,0,ac,"load maxaddress from location 0");
+   emitRM(ctx,"ST",ac,0,ac,"clear location 0");
+   emitComment(ctx,"End of standard prelude.");
+   free(s);
+   if (ctx->optimize) ctx->tmpOffset = -CSESLOTS;
+}
+
+/* Procedure codeGenStmt emits the code of one
+ * top-level statement; a statement's jumps all
+ * stay within its own code, so they are
+ * backpatched before it returns, and the source
+ * lines of its code are written after it
+ */
+void codeGenStmt(CompileCtx * ctx, NodeId stmt)
+{  if (ctx->optimize) cseAnalyze(ctx,stmt);
+   cGen(ctx,stmt);
+   emitLinesSoFar(ctx);
+}
+
+/* Procedure codeGenEnd emits the end of the
+ * program to the code file, then the arms that
+ * the profile placed after it, and the table of
+ * the source line of each location
+ */
+void codeGenEnd(CompileCtx * ctx)
+{  LayoutRec * l = ctx->layout;
+   int i, loc;
+   emitComment(ctx,"End of execution.");
+   ctx->codeLine = 0;
+   emitRO(ctx,"HALT",0,0,0,"");
+   /* an arm may leave more arms, which go after it */
+   for (i = 0; (l != NULL) && (i < l->ncold); i++)
+   { ColdArm a = l->cold[i];
+     ctx->codeLine = a.line;
+     if (TraceCode) emitComment(ctx,"-> cold part") ;
+     loc = emitSkip(ctx,0) ;
+     emitBackup(ctx,a.jump) ;
+     emitRM_Abs(ctx,a.op,ac,loc,"if: jmp to cold part");
+     emitRestore(ctx) ;
+     cGen(ctx,a.arm);
+     emitRM_Abs(ctx,"LDA",pc,a.back,"jmp back after cold part");
+     if (TraceCode)  emitComment(ctx,"<- cold part") ;
+   }
+   if (l != NULL) l->ncold = 0;
+   ctx->codeLine = 0;
+   emitLines(ctx);
+}
+
+/* Procedure layoutFree releases the layout made
+ * from the profile
+ */
+void layoutFree(CompileCtx * ctx)
+{  LayoutRec * l = ctx->layout;
+   if (l == NULL) return;
+   free(l->jumpLoc);
+   free(l->hot);
+   free(l->cold);
+   free(l);
+   ctx->layout = NULL;
 }
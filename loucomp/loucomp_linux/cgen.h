@@ -14,6 +14,40 @@
  * of the code file, and is used to print the
  * file name as a comment in the code file
  */
-void codeGen(TreeNode * syntaxTree, char * codefile);
+void codeGen(CompileCtx * ctx, NodeId syntaxTree, char * codefile);
+
+/* codeGen is codeGenBegin, then codeGenStmt for
+ * each top-level statement, then codeGenEnd; the
+ * streaming mode calls these as it goes
+ */
+
+/* Procedure codeGenBegin emits the heading and
+ * the standard prelude to the code file
+ */
+void codeGenBegin(CompileCtx * ctx, char * codefile);
+
+/* Procedure codeGenStmt emits the code of one
+ * top-level statement; a statement's jumps all
+ * stay within its own code, so they are
+ * backpatched before it returns, and the source
+ * lines of its code are written after it
+ */
+void codeGenStmt(CompileCtx * ctx, NodeId stmt);
+
+/* Procedure codeGenEnd emits the end of the
+ * program to the code file, then the arms that
+ * the profile placed after it, and the table of
+ * the source line of each location
+ */
+void codeGenEnd(CompileCtx * ctx);
+
+/* With ctx->profile, codeGen lays out each if so
+ * that its arm that ran most follows the test
+ */
+
+/* Procedure layoutFree releases the layout made
+ * from the profile
+ */
+void layoutFree(CompileCtx * ctx);
 
 #endif
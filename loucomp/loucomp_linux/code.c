@@ -8,20 +8,239 @@
 
 #include "globals.h"
 #include "code.h"
+#include "stats.h"
+#include "tmeng.h"
+#include "rewrite.h"
+#include "cse.h"
 
-/* TM location number for current instruction emission */
-static int emitLoc = 0 ;
+/* ctx->emitLoc is the TM location number for
+   current instruction emission */
 
-/* Highest TM location emitted so far
-   For use in conjunction with emitSkip,
-   emitBackup, and emitRestore */
-static int highEmitLoc = 0;
+/* ctx->highEmitLoc is the highest TM location
+   emitted so far. For use in conjunction with
+   emitSkip, emitBackup, and emitRestore */
+
+/* ctx->code may be NULL, in which case nothing
+   is written; with ctx->keepImage set, each
+   instruction is also kept in ctx->image, so
+   that it can be run without reading it back */
+
+/* ctx->srcLines holds the source line that the
+   instruction at each location was made for,
+   ctx->codeLine when it was emitted, from
+   location ctx->srcLinesBase on; the lines of
+   the locations before it have been written */
+
+/* lineAt is the source line of location loc */
+#define lineAt(ctx,loc) ((ctx)->srcLines[(loc)-(ctx)->srcLinesBase])
+
+/* with -O, instructions emitted in turn wait in
+   ctx->peep, the peephole window, until they are
+   written, so that the rewrite rules (rewrite.h)
+   can replace the sequences cgen.c emits for an
+   operation by shorter ones */
+
+/* PEEPSIZE is the number of instructions and
+   comments the window holds */
+#define PEEPSIZE 16
+
+/* an instruction or comment in the window */
+typedef struct
+   { INSTRUCTION in; /* iop is -1 for a comment */
+     int loc;
+     int line;
+     char * comment;
+   } PeepEntry;
+
+typedef struct PeepRec
+   { PeepEntry e[PEEPSIZE];
+     int n;
+   } PeepRec;
+
+/* Procedure keep notes that the instruction
+ * emitted at location loc comes from source line
+ * line, and stores it in ctx->image, if it is kept
+ */
+static void keep( CompileCtx * ctx, int loc, int line,
+                  char * op, int r, int s, int t )
+{ int k = loc - ctx->srcLinesBase;
+  if (k >= ctx->srcLinesCap)
+  { int n = (ctx->srcLinesCap == 0) ? IADDR_SIZE : 2*ctx->srcLinesCap;
+    while (n <= k) n *= 2;
+    ctx->srcLines = (int *) realloc(ctx->srcLines,n*sizeof(int));
+    countAlloc(ctx,n*sizeof(int));
+    memset(ctx->srcLines+ctx->srcLinesCap,0,(n-ctx->srcLinesCap)*sizeof(int));
+    ctx->srcLinesCap = n;
+  }
+  if (k >= 0) ctx->srcLines[k] = line;
+  if (! ctx->keepImage) return;
+  if (loc >= ctx->imageCap)
+  { int n = (ctx->imageCap == 0) ? IADDR_SIZE : 2*ctx->imageCap;
+    while (n <= loc) n *= 2;
+    ctx->image = (INSTRUCTION *) realloc(ctx->image,n*sizeof(INSTRUCTION));
+    countAlloc(ctx,n*sizeof(INSTRUCTION));
+    /* all zeroes is HALT 0,0,0, as in an unloaded TM */
+    memset(ctx->image+ctx->imageCap,0,(n-ctx->imageCap)*sizeof(INSTRUCTION));
+    ctx->imageCap = n;
+  }
+  ctx->image[loc].iop = tmOpcode(op);
+  ctx->image[loc].iarg1 = r;
+  ctx->image[loc].iarg2 = s;
+  ctx->image[loc].iarg3 = t;
+}
+
+/* Procedure writeEntry writes entry p of the
+ * peephole window to the code file, keeping an
+ * instruction as it is emitted
+ */
+static void writeEntry( CompileCtx * ctx, PeepEntry * p )
+{ INSTRUCTION * i = &p->in;
+  if (i->iop < 0)
+  { if (ctx->code != NULL) fprintf(ctx->code,"* %s\n",p->comment);
+    return;
+  }
+  if (ctx->code != NULL)
+  { if (opClass(i->iop) == opclRR)
+      fprintf(ctx->code,"%3d:  %5s  %d,%d,%d ",p->loc,
+              opCodeTab[i->iop],i->iarg1,i->iarg2,i->iarg3);
+    else
+      fprintf(ctx->code,"%3d:  %5s  %d,%d(%d) ",p->loc,
+              opCodeTab[i->iop],i->iarg1,i->iarg2,i->iarg3);
+    if (TraceCode) fprintf(ctx->code,"\t%s",p->comment) ;
+    fprintf(ctx->code,"\n") ;
+  }
+  keep(ctx,p->loc,p->line,opCodeTab[i->iop],i->iarg1,i->iarg2,i->iarg3);
+  ctx->ninstructions++;
+}
+
+/* Procedure peepFlush writes out what waits in
+ * the peephole window; it is called before the
+ * code is patched or a location is taken, since
+ * no rule may then move code
+ */
+static void peepFlush( CompileCtx * ctx )
+{ PeepRec * w = ctx->peep;
+  int k;
+  if ((w == NULL) || (w->n == 0)) return;
+  for (k = 0; k < w->n; k++) writeEntry(ctx,&w->e[k]);
+  w->n = 0;
+}
+
+/* Function pinned is TRUE if a jump in the window
+ * before entry k lands past location loc, so that
+ * the code from loc on may not get shorter
+ */
+static int pinned( PeepRec * w, int k, int loc )
+{ int j;
+  for (j = 0; j < k; j++)
+  { INSTRUCTION * i = &w->e[j].in;
+    if ((i->iop < 0) || (i->iarg3 != pc)) continue;
+    if ((((i->iop >= opJLT) && (i->iop <= opJNE))
+         || ((i->iop == opLDA) && (i->iarg1 == pc)))
+        && (w->e[j].loc+1+i->iarg2 > loc))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+/* Function peepRewrite applies the first rule
+ * that matches the last instructions in the
+ * window, if any; FALSE if none applies
+ */
+static int peepRewrite( CompileCtx * ctx )
+{ PeepRec * w = ctx->peep;
+  INSTRUCTION code[RULEMAX];
+  int at[PEEPSIZE];
+  int param[NPARAMS];
+  int n = 0, i, k, m, first, loc, line;
+  for (k = 0; k < w->n; k++)
+    if (w->e[k].in.iop >= 0) at[n++] = k;
+  for (i = 0; i < tmNRules; i++)
+  { TMRULE * r = &tmRules[i];
+    if (r->nlhs > n) continue;
+    first = at[n-r->nlhs];
+    for (k = 0; k < r->nlhs; k++) code[k] = w->e[at[n-r->nlhs+k]].in;
+    if (!ruleMatch(r,code,param)) continue;
+    /* ac1 is only read by the operation right
+       after its load, so it is always dead; a
+       temporary of cgen.c is read once, but those
+       of cse.c may be read again */
+    if ((r->dead & DEAD_TMP) && (param[P_T] > -CSESLOTS)) continue;
+    loc = w->e[first].loc;
+    if (pinned(w,first,loc)) continue;
+    if (!ruleApply(r,param,code)) continue;
+    line = w->e[first].line;
+    /* the comments among the instructions
+       replaced stay, ahead of the new ones */
+    for (k = m = first; k < w->n; k++)
+      if (w->e[k].in.iop < 0) w->e[m++] = w->e[k];
+    for (k = 0; k < r->nrhs; k++, m++)
+    { w->e[m].in = code[k];
+      w->e[m].loc = loc+k;
+      w->e[m].line = line;
+      w->e[m].comment = "peephole: rewritten";
+    }
+    w->n = m;
+    ctx->emitLoc = ctx->highEmitLoc = loc+r->nrhs;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/* Function peepAdd puts an instruction or, if op
+ * is -1, a comment in the peephole window, and
+ * rewrites the code there; FALSE if there is no
+ * window, and the instruction must be written
+ * out at once
+ */
+static int peepAdd( CompileCtx * ctx, int op, int r, int s, int t, char * c)
+{ PeepRec * w = ctx->peep;
+  PeepEntry * p;
+  if (w == NULL)
+  { w = (PeepRec *) malloc(sizeof(PeepRec));
+    if (w == NULL) return FALSE;
+    countAlloc(ctx,sizeof(PeepRec));
+    w->n = 0;
+    ctx->peep = w;
+  }
+  if (w->n == PEEPSIZE)
+  { writeEntry(ctx,&w->e[0]);
+    memmove(w->e,w->e+1,(PEEPSIZE-1)*sizeof(PeepEntry));
+    w->n--;
+  }
+  p = &w->e[w->n++];
+  p->in.iop = op;
+  p->in.iarg1 = r;
+  p->in.iarg2 = s;
+  p->in.iarg3 = t;
+  p->loc = ctx->emitLoc;
+  p->line = ctx->codeLine;
+  p->comment = c;
+  if (op < 0) return TRUE;
+  ctx->emitLoc++;
+  ctx->highEmitLoc = ctx->emitLoc;
+  while (peepRewrite(ctx)) ;
+  return TRUE;
+}
+
+/* Procedure peepFree releases the peephole
+ * window of -O
+ */
+void peepFree( CompileCtx * ctx )
+{ free(ctx->peep);
+  ctx->peep = NULL;
+}
 
 /* Procedure emitComment prints a comment line 
  * with comment c in the code file
  */
-void emitComment( char * c )
-{ if (TraceCode) fprintf(code,"* %s\n",c);}
+void emitComment( CompileCtx * ctx, char * c )
+{ if (!TraceCode || (ctx->code == NULL)) return;
+  /* in turn with the instructions that wait */
+  if ((ctx->peep != NULL) && (ctx->peep->n > 0) && peepAdd(ctx,-1,0,0,0,c))
+    return;
+  fprintf(ctx->code,"* %s\n",c);
+}
 
 /* Procedure emitRO emits a register-only
  * TM instruction
@@ -31,11 +250,18 @@ void emitComment( char * c )
  * t = 2nd source register
  * c = a comment to be printed if TraceCode is TRUE
  */
-void emitRO( char *op, int r, int s, int t, char *c)
-{ fprintf(code,"%3d:  %5s  %d,%d,%d ",emitLoc++,op,r,s,t);
-  if (TraceCode) fprintf(code,"\t%s",c) ;
-  fprintf(code,"\n") ;
-  if (highEmitLoc < emitLoc) highEmitLoc = emitLoc ;
+void emitRO( CompileCtx * ctx, char *op, int r, int s, int t, char *c)
+{ if (ctx->optimize && (ctx->emitLoc == ctx->highEmitLoc)
+      && peepAdd(ctx,tmOpcode(op),r,s,t,c))
+    return;
+  if (ctx->code != NULL)
+  { fprintf(ctx->code,"%3d:  %5s  %d,%d,%d ",ctx->emitLoc,op,r,s,t);
+    if (TraceCode) fprintf(ctx->code,"\t%s",c) ;
+    fprintf(ctx->code,"\n") ;
+  }
+  keep(ctx,ctx->emitLoc++,ctx->codeLine,op,r,s,t);
+  ctx->ninstructions++;
+  if (ctx->highEmitLoc < ctx->emitLoc) ctx->highEmitLoc = ctx->emitLoc ;
 } /* emitRO */
 
 /* Procedure emitRM emits a register-to-memory
@@ -46,38 +272,50 @@ void emitRO( char *op, int r, int s, int t, char *c)
  * s = the base register
  * c = a comment to be printed if TraceCode is TRUE
  */
-void emitRM( char * op, int r, int d, int s, char *c)
-{ fprintf(code,"%3d:  %5s  %d,%d(%d) ",emitLoc++,op,r,d,s);
-  if (TraceCode) fprintf(code,"\t%s",c) ;
-  fprintf(code,"\n") ;
-  if (highEmitLoc < emitLoc)  highEmitLoc = emitLoc ;
+void emitRM( CompileCtx * ctx, char * op, int r, int d, int s, char *c)
+{ if (ctx->optimize && (ctx->emitLoc == ctx->highEmitLoc)
+      && peepAdd(ctx,tmOpcode(op),r,d,s,c))
+    return;
+  if (ctx->code != NULL)
+  { fprintf(ctx->code,"%3d:  %5s  %d,%d(%d) ",ctx->emitLoc,op,r,d,s);
+    if (TraceCode) fprintf(ctx->code,"\t%s",c) ;
+    fprintf(ctx->code,"\n") ;
+  }
+  keep(ctx,ctx->emitLoc++,ctx->codeLine,op,r,d,s);
+  ctx->ninstructions++;
+  if (ctx->highEmitLoc < ctx->emitLoc)  ctx->highEmitLoc = ctx->emitLoc ;
 } /* emitRM */
 
 /* Function emitSkip skips "howMany" code
  * locations for later backpatch. It also
  * returns the current code position
  */
-int emitSkip( int howMany)
-{  int i = emitLoc;
-   emitLoc += howMany ;
-   if (highEmitLoc < emitLoc)  highEmitLoc = emitLoc ;
+int emitSkip( CompileCtx * ctx, int howMany)
+{  int i;
+   peepFlush(ctx);
+   i = ctx->emitLoc;
+   ctx->emitLoc += howMany ;
+   if (ctx->highEmitLoc < ctx->emitLoc)  ctx->highEmitLoc = ctx->emitLoc ;
    return i;
 } /* emitSkip */
 
 /* Procedure emitBackup backs up to 
  * loc = a previously skipped location
  */
-void emitBackup( int loc)
-{ if (loc > highEmitLoc) emitComment("BUG in emitBackup");
-  emitLoc = loc ;
+void emitBackup( CompileCtx * ctx, int loc)
+{ peepFlush(ctx);
+  if (loc > ctx->highEmitLoc) emitComment(ctx,"BUG in emitBackup");
+  ctx->emitLoc = loc ;
 } /* emitBackup */
 
 /* Procedure emitRestore restores the current 
  * code position to the highest previously
  * unemitted position
  */
-void emitRestore(void)
-{ emitLoc = highEmitLoc;}
+void emitRestore(CompileCtx * ctx)
+{ peepFlush(ctx);
+  ctx->emitLoc = ctx->highEmitLoc;
+}
 
 /* Procedure emitRM_Abs converts an absolute reference 
  * to a pc-relative reference when emitting a
@@ -87,11 +325,77 @@ void emitRestore(void)
  * a = the absolute location in memory
  * c = a comment to be printed if TraceCode is TRUE
  */
-void emitRM_Abs( char *op, int r, int a, char * c)
-{ fprintf(code,"%3d:  %5s  %d,%d(%d) ",
-               emitLoc,op,r,a-(emitLoc+1),pc);
-  ++emitLoc ;
-  if (TraceCode) fprintf(code,"\t%s",c) ;
-  fprintf(code,"\n") ;
-  if (highEmitLoc < emitLoc) highEmitLoc = emitLoc ;
+void emitRM_Abs( CompileCtx * ctx, char *op, int r, int a, char * c)
+{ peepFlush(ctx);
+  if (ctx->code != NULL)
+  { fprintf(ctx->code,"%3d:  %5s  %d,%d(%d) ",
+                 ctx->emitLoc,op,r,a-(ctx->emitLoc+1),pc);
+    if (TraceCode) fprintf(ctx->code,"\t%s",c) ;
+    fprintf(ctx->code,"\n") ;
+  }
+  keep(ctx,ctx->emitLoc,ctx->codeLine,op,r,a-(ctx->emitLoc+1),pc);
+  ++ctx->emitLoc ;
+  ctx->ninstructions++;
+  if (ctx->highEmitLoc < ctx->emitLoc) ctx->highEmitLoc = ctx->emitLoc ;
 } /* emitRM_Abs */
+
+/* Function writeRuns writes the comment "loc
+ * a-b: line n" for each run of locations made for
+ * the same line, from ctx->srcLinesBase up to
+ * limit; unless all is set, the run that reaches
+ * limit is not, since the code after it may go on
+ * with it. Returns the first location not written
+ */
+static int writeRuns( CompileCtx * ctx, int limit, int all )
+{ int first = ctx->srcLinesBase, loc;
+  if (limit > ctx->srcLinesBase+ctx->srcLinesCap)
+    limit = ctx->srcLinesBase+ctx->srcLinesCap;
+  while (first < limit)
+  { loc = first;
+    while ((loc+1 < limit) && (lineAt(ctx,loc+1) == lineAt(ctx,first)))
+      loc++;
+    if (!all && (loc+1 == limit)) break;
+    if (lineAt(ctx,first) != 0)
+      fprintf(ctx->code,"* loc %d-%d: line %d\n",first,loc,lineAt(ctx,first));
+    first = loc+1;
+  }
+  return first;
+}
+
+/* Procedure emitLines prints the source line of
+ * each location emitted so far in the code file,
+ * as comments "loc a-b: line n" for each run of
+ * locations made for the same line, which the TM
+ * simulator reads back
+ */
+void emitLines( CompileCtx * ctx )
+{ peepFlush(ctx);
+  if (ctx->code == NULL) return;
+  fprintf(ctx->code,"* Source lines:\n");
+  writeRuns(ctx,ctx->highEmitLoc,TRUE);
+} /* emitLines */
+
+/* Procedure emitLinesSoFar prints, as emitLines
+ * does, the runs of locations that the code to
+ * come cannot change, and drops them from
+ * ctx->srcLines, so that a program compiled a
+ * statement at a time needs no table as long as
+ * all its code
+ */
+void emitLinesSoFar( CompileCtx * ctx )
+{ PeepRec * w = ctx->peep;
+  int limit = ctx->emitLoc, done, n;
+  /* without a code file, the table is kept whole
+     for tiny -run -lines */
+  if (ctx->code == NULL) return;
+  /* what waits in the peephole window may still
+     be rewritten */
+  if ((w != NULL) && (w->n > 0) && (w->e[0].loc < limit))
+    limit = w->e[0].loc;
+  done = writeRuns(ctx,limit,FALSE);
+  if (done == ctx->srcLinesBase) return;
+  n = ctx->srcLinesBase + ctx->srcLinesCap - done;
+  memmove(ctx->srcLines,ctx->srcLines+(done-ctx->srcLinesBase),n*sizeof(int));
+  memset(ctx->srcLines+n,0,(done-ctx->srcLinesBase)*sizeof(int));
+  ctx->srcLinesBase = done;
+} /* emitLinesSoFar */
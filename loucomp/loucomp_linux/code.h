@@ -34,7 +34,7 @@
 /* Procedure emitComment prints a comment line 
  * with comment c in the code file
  */
-void emitComment( char * c );
+void emitComment( CompileCtx * ctx, char * c );
 
 /* Procedure emitRO emits a register-only
  * TM instruction
@@ -44,7 +44,7 @@ void emitComment( char * c );
  * t = 2nd source register
  * c = a comment to be printed if TraceCode is TRUE
  */
-void emitRO( char *op, int r, int s, int t, char *c);
+void emitRO( CompileCtx * ctx, char *op, int r, int s, int t, char *c);
 
 /* Procedure emitRM emits a register-to-memory
  * TM instruction
@@ -54,24 +54,24 @@ void emitRO( char *op, int r, int s, int t, char *c);
  * s = the base register
  * c = a comment to be printed if TraceCode is TRUE
  */
-void emitRM( char * op, int r, int d, int s, char *c);
+void emitRM( CompileCtx * ctx, char * op, int r, int d, int s, char *c);
 
 /* Function emitSkip skips "howMany" code
  * locations for later backpatch. It also
  * returns the current code position
  */
-int emitSkip( int howMany);
+int emitSkip( CompileCtx * ctx, int howMany);
 
 /* Procedure emitBackup backs up to 
  * loc = a previously skipped location
  */
-void emitBackup( int loc);
+void emitBackup( CompileCtx * ctx, int loc);
 
 /* Procedure emitRestore restores the current 
  * code position to the highest previously
  * unemitted position
  */
-void emitRestore(void);
+void emitRestore(CompileCtx * ctx);
 
 /* Procedure emitRM_Abs converts an absolute reference 
  * to a pc-relative reference when emitting a
@@ -81,6 +81,28 @@ void emitRestore(void);
  * a = the absolute location in memory
  * c = a comment to be printed if TraceCode is TRUE
  */
-void emitRM_Abs( char *op, int r, int a, char * c);
+void emitRM_Abs( CompileCtx * ctx, char *op, int r, int a, char * c);
+
+/* Procedure emitLines prints the source line of
+ * each location emitted so far in the code file,
+ * as comments "loc a-b: line n" for each run of
+ * locations made for the same line, which the TM
+ * simulator reads back
+ */
+void emitLines( CompileCtx * ctx );
+
+/* Procedure emitLinesSoFar prints, as emitLines
+ * does, the runs of locations that the code to
+ * come cannot change, and drops them from
+ * ctx->srcLines, so that a program compiled a
+ * statement at a time needs no table as long as
+ * all its code
+ */
+void emitLinesSoFar( CompileCtx * ctx );
+
+/* Procedure peepFree releases the peephole
+ * window of -O
+ */
+void peepFree( CompileCtx * ctx );
 
 #endif
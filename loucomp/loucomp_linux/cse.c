@@ -0,0 +1,488 @@
+/****************************************************/
+/* File: cse.c                                      */
+/* Value numbering implementation for the TINY      */
+/* code generator                                   */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "code.h"
+#include "cse.h"
+#include "arena.h"
+#include "stats.h"
+
+/* Every value the program computes gets a value
+   number (VN): equal numbers mean equal values.
+   A constant's number depends on the constant, a
+   variable's on the last assignment to it, and an
+   operation's on the operator and the numbers of
+   its operands, so that an operation met again
+   with the same operands is found in a hash table
+   of the operations computed so far. An
+   assignment gives its variable a new number,
+   which is all it takes to make the operations
+   on the old value unreachable.
+
+   The table follows the dominator tree: what is
+   computed before an if is known in both of its
+   parts, and what is computed in one part is
+   forgotten when it ends; a variable assigned in
+   either part gets a new number after the if. A
+   repeat body runs at least once and its end leads
+   to its exit, so what is computed in the body is
+   known after the loop; a variable assigned in
+   the loop gets a new number as the loop starts.
+
+   The operations computed first that are used
+   again (defs) are kept, from where they are
+   computed to their last use, in registers 2 to
+   4, which cgen.c never uses, or in the CSESLOTS
+   temporaries at the top of data memory. A def
+   made before a loop and used in it is kept to
+   the end of the loop. The places to keep them
+   are handed out in program order; a def that
+   finds none is simply computed again. */
+
+#define CSEREGS 3 /* registers 2, 3 and 4 */
+#define FIRSTREG 2
+#define NHOLDERS (CSEREGS+CSESLOTS)
+#define NO_HOLDER (-1)
+
+/* the operator of the table entry of a constant */
+#define CONSTKEY (-1)
+
+#define HASHSIZE 4096
+
+/* an operation that is computed and used again */
+typedef struct
+   { int vn;
+     int uses;
+     int serial; /* where it is computed */
+     int lastUse; /* where it is last used */
+     int loop; /* a loop it must be kept through, or -1 */
+     int holder; /* where it is kept, or NO_HOLDER */
+   } ValueDef;
+
+/* an entry of the table: op applied to the values
+   numbered a and b has number vn, and is def */
+typedef struct
+   { int op, a, b;
+     int vn;
+     int def;
+     int next; /* next entry in the same bucket */
+   } Entry;
+
+/* the number a variable had before an assignment */
+typedef struct
+   { int loc;
+     int vn;
+   } VarSave;
+
+/* a repeat loop, from its first to its last serial */
+typedef struct
+   { int start;
+     int end;
+   } Loop;
+
+struct CseRec
+   { int * note; /* per node: 0, def+1 or -(def+1) */
+     int nnotes;
+     ValueDef * defs;
+     int ndefs, maxdefs;
+     Entry * entries;
+     int nentries, maxentries;
+     int buckets[HASHSIZE];
+     int * varVN; /* per variable location, or -1 */
+     int nvars;
+     VarSave * saved;
+     int nsaved, maxsaved;
+     int * killed;
+     int nkilled, maxkilled;
+     Loop * loops;
+     int nloops, maxloops;
+     int * open; /* loops being walked, outermost first */
+     int nopen, maxopen;
+     int nextVN;
+     int serial; /* counts the defs and uses met */
+   };
+
+/* Function grow returns p with room for n elements
+ * of size bytes, *max being the room it has
+ */
+static void * grow( CompileCtx * ctx, void * p, int * max, int n, size_t size )
+{ if (n > *max)
+  { int m = (*max == 0) ? 64 : 2 * *max;
+    while (m < n) m *= 2;
+    p = realloc(p,m*size);
+    countAlloc(ctx,m*size);
+    *max = m;
+  }
+  return p;
+}
+
+static unsigned hash( int op, int a, int b )
+{ return ((unsigned) op*31u + (unsigned) a*1009u + (unsigned) b*9176u)
+         & (HASHSIZE-1);
+}
+
+/* Function lookup returns the entry of op applied
+ * to a and b, or -1 if there is none
+ */
+static int lookup( struct CseRec * r, int op, int a, int b )
+{ int e;
+  for (e = r->buckets[hash(op,a,b)]; e >= 0; e = r->entries[e].next)
+    if ((r->entries[e].op == op) && (r->entries[e].a == a)
+        && (r->entries[e].b == b))
+      return e;
+  return -1;
+}
+
+static void insert( CompileCtx * ctx, int op, int a, int b, int vn, int def )
+{ struct CseRec * r = ctx->cse;
+  unsigned h = hash(op,a,b);
+  Entry * e;
+  r->entries = grow(ctx,r->entries,&r->maxentries,r->nentries+1,sizeof(Entry));
+  e = &r->entries[r->nentries];
+  e->op = op; e->a = a; e->b = b;
+  e->vn = vn; e->def = def;
+  e->next = r->buckets[h];
+  r->buckets[h] = r->nentries++;
+}
+
+/* Procedure forget removes the entries made since
+ * there were mark of them
+ */
+static void forget( struct CseRec * r, int mark )
+{ while (r->nentries > mark)
+  { Entry * e = &r->entries[--r->nentries];
+    r->buckets[hash(e->op,e->a,e->b)] = e->next;
+  }
+}
+
+/* Function varVN returns the number of the value
+ * of variable sym
+ */
+static int varVN( CompileCtx * ctx, int sym )
+{ struct CseRec * r = ctx->cse;
+  int loc = st_lookup(ctx,sym);
+  if (r->varVN[loc] < 0) r->varVN[loc] = r->nextVN++;
+  return r->varVN[loc];
+}
+
+/* Procedure setVar gives variable sym the value
+ * numbered vn, saving the number it had
+ */
+static void setVar( CompileCtx * ctx, int sym, int vn )
+{ struct CseRec * r = ctx->cse;
+  int loc = st_lookup(ctx,sym);
+  r->saved = grow(ctx,r->saved,&r->maxsaved,r->nsaved+1,sizeof(VarSave));
+  r->saved[r->nsaved].loc = loc;
+  r->saved[r->nsaved].vn = r->varVN[loc];
+  r->nsaved++;
+  r->varVN[loc] = vn;
+}
+
+static int commutes( int op )
+{ return (op == PLUS) || (op == TIMES) || (op == EQ); }
+
+/* Function known returns the number of the value
+ * of expression n if every operation in it is in
+ * the table, or -1; it changes nothing
+ */
+static int known( CompileCtx * ctx, NodeId n )
+{ struct CseRec * r = ctx->cse;
+  TreeNode * t;
+  int a, b, e;
+  if (n == NIL_NODE) return -1;
+  t = NODE(ctx,n);
+  switch (t->kind.exp) {
+    case ConstK :
+      e = lookup(r,CONSTKEY,t->attr.val,0);
+      return (e < 0) ? -1 : r->entries[e].vn;
+    case IdK :
+      return r->varVN[st_lookup(ctx,t->attr.sym)];
+    case OpK :
+      a = known(ctx,t->child[0]);
+      if (a < 0) return -1;
+      b = known(ctx,t->child[1]);
+      if (b < 0) return -1;
+      if (commutes(t->attr.op) && (a > b))
+      { int c = a; a = b; b = c; }
+      e = lookup(r,t->attr.op,a,b);
+      return (e < 0) ? -1 : r->entries[e].vn;
+    default :
+      return -1;
+  }
+}
+
+/* Procedure useDef notes a use of def d */
+static void useDef( CompileCtx * ctx, int d )
+{ struct CseRec * r = ctx->cse;
+  ValueDef * v = &r->defs[d];
+  int i;
+  v->uses++;
+  v->lastUse = r->serial++;
+  /* the outermost loop entered since d was made */
+  for (i=0;i<r->nopen;i++)
+    if (r->loops[r->open[i]].start > v->serial)
+    { v->loop = r->open[i];
+      break;
+    }
+}
+
+/* Function numberExp numbers the values of
+ * expression n and returns its number
+ */
+static int numberExp( CompileCtx * ctx, NodeId n )
+{ struct CseRec * r = ctx->cse;
+  TreeNode * t;
+  ValueDef * v;
+  int a, b, e, vn;
+  if (n == NIL_NODE) return r->nextVN++;
+  t = NODE(ctx,n);
+  switch (t->kind.exp) {
+    case ConstK :
+      e = lookup(r,CONSTKEY,t->attr.val,0);
+      if (e >= 0) return r->entries[e].vn;
+      insert(ctx,CONSTKEY,t->attr.val,0,r->nextVN,-1);
+      return r->nextVN++;
+    case IdK :
+      return varVN(ctx,t->attr.sym);
+    case OpK :
+      /* an operation computed before is used as a
+         whole, without looking into its operands */
+      vn = known(ctx,n);
+      if (vn >= 0)
+      { a = known(ctx,t->child[0]);
+        b = known(ctx,t->child[1]);
+        if (commutes(t->attr.op) && (a > b))
+        { int c = a; a = b; b = c; }
+        e = lookup(r,t->attr.op,a,b);
+        useDef(ctx,r->entries[e].def);
+        r->note[n] = -(r->entries[e].def+1);
+        return vn;
+      }
+      a = numberExp(ctx,t->child[0]);
+      b = numberExp(ctx,t->child[1]);
+      if (commutes(t->attr.op) && (a > b))
+      { int c = a; a = b; b = c; }
+      r->defs = grow(ctx,r->defs,&r->maxdefs,r->ndefs+1,sizeof(ValueDef));
+      v = &r->defs[r->ndefs];
+      v->vn = r->nextVN++;
+      v->uses = 0;
+      v->serial = v->lastUse = r->serial++;
+      v->loop = -1;
+      v->holder = NO_HOLDER;
+      insert(ctx,t->attr.op,a,b,v->vn,r->ndefs);
+      r->note[n] = ++r->ndefs;
+      return v->vn;
+    default :
+      return r->nextVN++;
+  }
+}
+
+static void numberSeq( CompileCtx * ctx, NodeId n );
+
+/* Procedure numberPart numbers the values of one
+ * part of an if, then forgets what it computed and
+ * restores the variables it assigned, noting them
+ * in killed
+ */
+static void numberPart( CompileCtx * ctx, NodeId n )
+{ struct CseRec * r = ctx->cse;
+  int mark = r->nentries;
+  int saved = r->nsaved;
+  numberSeq(ctx,n);
+  forget(r,mark);
+  while (r->nsaved > saved)
+  { VarSave * s = &r->saved[--r->nsaved];
+    r->killed = grow(ctx,r->killed,&r->maxkilled,r->nkilled+1,sizeof(int));
+    r->killed[r->nkilled++] = s->loc;
+    r->varVN[s->loc] = s->vn;
+  }
+}
+
+/* Procedure killAssigned gives a new number to
+ * every variable assigned in statements n
+ */
+static void killAssigned( CompileCtx * ctx, NodeId n )
+{ while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    if (t->nodekind == StmtK)
+      switch (t->kind.stmt) {
+        case IfK :
+          killAssigned(ctx,t->child[1]);
+          killAssigned(ctx,t->child[2]);
+          break;
+        case RepeatK :
+          killAssigned(ctx,t->child[0]);
+          break;
+        case AssignK :
+        case ReadK :
+          setVar(ctx,t->attr.sym,ctx->cse->nextVN++);
+          break;
+        default :
+          break;
+      }
+    n = t->sibling;
+  }
+}
+
+/* Procedure numberSeq numbers the values of the
+ * statements n in program order
+ */
+static void numberSeq( CompileCtx * ctx, NodeId n )
+{ struct CseRec * r = ctx->cse;
+  while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    int mark, loop;
+    if (t->nodekind == StmtK)
+      switch (t->kind.stmt) {
+        case IfK :
+          numberExp(ctx,t->child[0]);
+          mark = r->nkilled;
+          numberPart(ctx,t->child[1]);
+          numberPart(ctx,t->child[2]);
+          while (r->nkilled > mark)
+          { int loc = r->killed[--r->nkilled];
+            r->saved = grow(ctx,r->saved,&r->maxsaved,r->nsaved+1,sizeof(VarSave));
+            r->saved[r->nsaved].loc = loc;
+            r->saved[r->nsaved].vn = r->varVN[loc];
+            r->nsaved++;
+            r->varVN[loc] = r->nextVN++;
+          }
+          break;
+        case RepeatK :
+          killAssigned(ctx,t->child[0]);
+          r->loops = grow(ctx,r->loops,&r->maxloops,r->nloops+1,sizeof(Loop));
+          r->open = grow(ctx,r->open,&r->maxopen,r->nopen+1,sizeof(int));
+          loop = r->nloops++;
+          r->loops[loop].start = r->serial;
+          r->open[r->nopen++] = loop;
+          numberSeq(ctx,t->child[0]);
+          numberExp(ctx,t->child[1]);
+          r->loops[loop].end = r->serial++;
+          r->nopen--;
+          break;
+        case AssignK :
+          setVar(ctx,t->attr.sym,numberExp(ctx,t->child[0]));
+          break;
+        case ReadK :
+          setVar(ctx,t->attr.sym,r->nextVN++);
+          break;
+        case WriteK :
+          numberExp(ctx,t->child[0]);
+          break;
+        default :
+          break;
+      }
+    n = t->sibling;
+  }
+}
+
+/* Procedure placeDefs chooses where each def that
+ * is used again is kept
+ */
+static void placeDefs( struct CseRec * r )
+{ int busy[NHOLDERS]; /* last use of what each holds */
+  int d, h;
+  for (h=0;h<NHOLDERS;h++) busy[h] = -1;
+  for (d=0;d<r->ndefs;d++)
+  { ValueDef * v = &r->defs[d];
+    if (v->uses == 0) continue;
+    if ((v->loop >= 0) && (r->loops[v->loop].end > v->lastUse))
+      v->lastUse = r->loops[v->loop].end;
+    for (h=0;h<NHOLDERS;h++)
+      if (busy[h] < v->serial)
+      { v->holder = h;
+        busy[h] = v->lastUse;
+        break;
+      }
+  }
+}
+
+/* Procedure cseAnalyze numbers the values of the
+ * statements in tree, finds the operations that
+ * repeat one computed before them, and chooses
+ * where each value that is used again is kept.
+ * It is called before code is made for tree
+ */
+void cseAnalyze( CompileCtx * ctx, NodeId tree )
+{ struct CseRec * r = ctx->cse;
+  int i;
+  if (r == NULL)
+  { r = ctx->cse = (struct CseRec *) calloc(1,sizeof(struct CseRec));
+    countAlloc(ctx,sizeof(struct CseRec));
+    if (r == NULL) return;
+  }
+  r->note = grow(ctx,r->note,&r->nnotes,ctx->nodeTop,sizeof(int));
+  memset(r->note,0,ctx->nodeTop*sizeof(int));
+  r->varVN = grow(ctx,r->varVN,&r->nvars,ctx->location+1,sizeof(int));
+  for (i=0;i<r->nvars;i++) r->varVN[i] = -1;
+  for (i=0;i<HASHSIZE;i++) r->buckets[i] = -1;
+  r->ndefs = r->nentries = r->nsaved = r->nkilled = 0;
+  r->nloops = r->nopen = 0;
+  r->nextVN = r->serial = 0;
+  numberSeq(ctx,tree);
+  placeDefs(r);
+}
+
+/* Function holderOf returns the def noted for
+ * node n if it is a use (use is TRUE) or the
+ * def itself, and is kept somewhere; else NULL
+ */
+static ValueDef * holderOf( CompileCtx * ctx, NodeId n, int use )
+{ struct CseRec * r = ctx->cse;
+  int note;
+  if ((r == NULL) || (n >= (NodeId) r->nnotes)) return NULL;
+  note = r->note[n];
+  if (use ? (note >= 0) : (note <= 0)) return NULL;
+  note = use ? -note-1 : note-1;
+  if (r->defs[note].holder == NO_HOLDER) return NULL;
+  return &r->defs[note];
+}
+
+/* Function cseLoad emits the load of the value of
+ * operation n into ac and returns TRUE if it was
+ * computed before; FALSE if n must be computed
+ */
+int cseLoad( CompileCtx * ctx, NodeId n )
+{ ValueDef * v = holderOf(ctx,n,TRUE);
+  if (v == NULL) return FALSE;
+  if (v->holder < CSEREGS)
+    emitRM(ctx,"LDA",ac,0,FIRSTREG+v->holder,"cse: reuse value");
+  else
+    emitRM(ctx,"LD",ac,-(v->holder-CSEREGS),mp,"cse: reuse value");
+  return TRUE;
+}
+
+/* Procedure cseSave emits the copy of ac, which
+ * holds the value of operation n, to where it is
+ * kept, if it is used again
+ */
+void cseSave( CompileCtx * ctx, NodeId n )
+{ ValueDef * v = holderOf(ctx,n,FALSE);
+  if (v == NULL) return;
+  if (v->holder < CSEREGS)
+    emitRM(ctx,"LDA",FIRSTREG+v->holder,0,ac,"cse: keep value");
+  else
+    emitRM(ctx,"ST",ac,-(v->holder-CSEREGS),mp,"cse: keep value");
+}
+
+/* Procedure cseFree releases the state of the
+ * value numbering
+ */
+void cseFree( CompileCtx * ctx )
+{ struct CseRec * r = ctx->cse;
+  if (r == NULL) return;
+  free(r->note);
+  free(r->defs);
+  free(r->entries);
+  free(r->varVN);
+  free(r->saved);
+  free(r->killed);
+  free(r->loops);
+  free(r->open);
+  free(r);
+  ctx->cse = NULL;
+}
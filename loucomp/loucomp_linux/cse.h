@@ -0,0 +1,44 @@
+/****************************************************/
+/* File: cse.h                                      */
+/* Value numbering for the TINY code generator      */
+/* With -O, an operation whose value was already    */
+/* computed, and is still valid, is taken from the  */
+/* register or temporary that holds it instead of   */
+/* being computed again                             */
+/****************************************************/
+
+#ifndef _CSE_H_
+#define _CSE_H_
+
+/* CSESLOTS is the number of temporaries, at the
+ * top of data memory, that may hold values; the
+ * temporaries of cgen.c start below them
+ */
+#define CSESLOTS 16
+
+/* Procedure cseAnalyze numbers the values of the
+ * statements in tree, finds the operations that
+ * repeat one computed before them, and chooses
+ * where each value that is used again is kept.
+ * It is called before code is made for tree
+ */
+void cseAnalyze( CompileCtx * ctx, NodeId tree );
+
+/* Function cseLoad emits the load of the value of
+ * operation n into ac and returns TRUE if it was
+ * computed before; FALSE if n must be computed
+ */
+int cseLoad( CompileCtx * ctx, NodeId n );
+
+/* Procedure cseSave emits the copy of ac, which
+ * holds the value of operation n, to where it is
+ * kept, if it is used again
+ */
+void cseSave( CompileCtx * ctx, NodeId n );
+
+/* Procedure cseFree releases the state of the
+ * value numbering
+ */
+void cseFree( CompileCtx * ctx );
+
+#endif
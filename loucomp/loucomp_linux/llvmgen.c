@@ -0,0 +1,276 @@
+/****************************************************/
+/* File: llvmgen.c                                  */
+/* The LLVM IR code generator implementation        */
+/* for the TINY compiler                            */
+/* (generates textual LLVM IR)                      */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "llvmgen.h"
+#include "arena.h"
+#include "stats.h"
+#include <stdarg.h>
+
+/* The program becomes the function main. Each
+   variable is an internal global, @tiny.<name>,
+   that starts out as 0; they are defined at the
+   end, when all of them are known, and opt turns
+   them into registers. Values are i32, and
+   arithmetic wraps as on the TM (no nsw flags);
+   a < b is the sign of a - b, as in the code of
+   cgen.c. Each value gets a new temporary %t<n>
+   and each label a new block %L<n> */
+
+/* Procedure emit prints one instruction */
+static void emit( CompileCtx * ctx, const char * fmt, ... )
+{ va_list args;
+  va_start(args,fmt);
+  fputs("  ",ctx->code);
+  vfprintf(ctx->code,fmt,args);
+  putc('\n',ctx->code);
+  va_end(args);
+  ctx->ninstructions++;
+}
+
+/* Procedure emitBlock starts block n */
+static void emitBlock( CompileCtx * ctx, int n )
+{ fprintf(ctx->code,"L%d:\n",n); }
+
+/* Procedure llComment prints a comment line */
+static void llComment( CompileCtx * ctx, char * c )
+{ if (TraceCode) fprintf(ctx->code,"  ; %s\n",c); }
+
+/* Function newTemp prints a new temporary into
+ * buf and returns buf
+ */
+static char * newTemp( CompileCtx * ctx, char * buf )
+{ sprintf(buf,"%%t%d",ctx->ntemps++);
+  return buf;
+}
+
+/* Function global prints the global of variable
+ * sym into buf and returns buf, noting that it
+ * must be defined
+ */
+static char * global( CompileCtx * ctx, int sym, char * buf )
+{ int loc = st_lookup(ctx,sym);
+  if (loc >= ctx->nglobals)
+  { int n = (ctx->nglobals == 0) ? 64 : 2*ctx->nglobals;
+    int i;
+    while (n <= loc) n *= 2;
+    ctx->globalSym = (int *) realloc(ctx->globalSym,n*sizeof(int));
+    countAlloc(ctx,n*sizeof(int));
+    for (i=ctx->nglobals;i<n;i++) ctx->globalSym[i] = -1;
+    ctx->nglobals = n;
+  }
+  ctx->globalSym[loc] = sym;
+  sprintf(buf,"@tiny.%s",st_name(ctx,sym));
+  return buf;
+}
+
+static void genExp( CompileCtx * ctx, NodeId n, char * val );
+
+/* Procedure genCompare generates the comparison
+ * t (LT or EQ), leaving its i1 result in val
+ */
+static void genCompare( CompileCtx * ctx, TreeNode * t, char * val )
+{ char left[32], right[32], diff[32];
+  genExp(ctx,t->child[0],left);
+  genExp(ctx,t->child[1],right);
+  if (t->attr.op == LT)
+  { /* the sign of a - b */
+    emit(ctx,"%s = sub i32 %s, %s",newTemp(ctx,diff),left,right);
+    emit(ctx,"%s = icmp slt i32 %s, 0",newTemp(ctx,val),diff);
+  }
+  else emit(ctx,"%s = icmp eq i32 %s, %s",newTemp(ctx,val),left,right);
+}
+
+/* Procedure genExp generates code for expression
+ * n, leaving in val its i32 value: a temporary,
+ * or the number itself for a constant
+ */
+static void genExp( CompileCtx * ctx, NodeId n, char * val )
+{ TreeNode * t = NODE(ctx,n);
+  char left[32], right[32], var[MAXTOKENLEN+8];
+  int ok;
+  switch (t->kind.exp) {
+    case ConstK :
+      sprintf(val,"%d",t->attr.val);
+      break;
+    case IdK :
+      emit(ctx,"%s = load i32, i32* %s",newTemp(ctx,val),
+           global(ctx,t->attr.sym,var));
+      break;
+    case OpK :
+      if (TraceCode) llComment(ctx,"-> Op");
+      if ((t->attr.op == LT) || (t->attr.op == EQ))
+      { genCompare(ctx,t,left);
+        emit(ctx,"%s = zext i1 %s to i32",newTemp(ctx,val),left);
+        if (TraceCode) llComment(ctx,"<- Op");
+        break;
+      }
+      genExp(ctx,t->child[0],left);
+      genExp(ctx,t->child[1],right);
+      switch (t->attr.op) {
+        case PLUS :
+          emit(ctx,"%s = add i32 %s, %s",newTemp(ctx,val),left,right);
+          break;
+        case MINUS :
+          emit(ctx,"%s = sub i32 %s, %s",newTemp(ctx,val),left,right);
+          break;
+        case TIMES :
+          emit(ctx,"%s = mul i32 %s, %s",newTemp(ctx,val),left,right);
+          break;
+        case OVER :
+          /* division by 0 stops the program */
+          ok = ctx->nblocks++;
+          emit(ctx,"%s = icmp eq i32 %s, 0",newTemp(ctx,val),right);
+          emit(ctx,"br i1 %s, label %%divzero, label %%L%d",val,ok);
+          emitBlock(ctx,ok);
+          emit(ctx,"%s = sdiv i32 %s, %s",newTemp(ctx,val),left,right);
+          break;
+        default:
+          llComment(ctx,"BUG: Unknown operator");
+          strcpy(val,"0");
+          break;
+      }
+      if (TraceCode) llComment(ctx,"<- Op");
+      break;
+    default:
+      strcpy(val,"0");
+      break;
+  }
+}
+
+/* Procedure genTest generates code for test
+ * expression n, leaving its i1 truth in val
+ */
+static void genTest( CompileCtx * ctx, NodeId n, char * val )
+{ TreeNode * t = NODE(ctx,n);
+  char v[32];
+  if ((t->kind.exp == OpK) && ((t->attr.op == LT) || (t->attr.op == EQ)))
+    genCompare(ctx,t,val);
+  else
+  { genExp(ctx,n,v);
+    emit(ctx,"%s = icmp ne i32 %s, 0",newTemp(ctx,val),v);
+  }
+}
+
+static void llGen( CompileCtx * ctx, NodeId n );
+
+/* Procedure genStmt generates code at a statement node */
+static void genStmt( CompileCtx * ctx, TreeNode * t )
+{ char val[32], var[MAXTOKENLEN+8];
+  int b1, b2, b3;
+  switch (t->kind.stmt) {
+    case IfK :
+      if (TraceCode) llComment(ctx,"-> if");
+      b1 = ctx->nblocks++;
+      b2 = ctx->nblocks++;
+      b3 = (t->child[2] != NIL_NODE) ? ctx->nblocks++ : b2;
+      genTest(ctx,t->child[0],val);
+      emit(ctx,"br i1 %s, label %%L%d, label %%L%d",val,b1,b2);
+      emitBlock(ctx,b1);
+      llGen(ctx,t->child[1]);
+      emit(ctx,"br label %%L%d",b3);
+      if (t->child[2] != NIL_NODE)
+      { emitBlock(ctx,b2);
+        llGen(ctx,t->child[2]);
+        emit(ctx,"br label %%L%d",b3);
+      }
+      emitBlock(ctx,b3);
+      if (TraceCode) llComment(ctx,"<- if");
+      break;
+    case RepeatK :
+      if (TraceCode) llComment(ctx,"-> repeat");
+      b1 = ctx->nblocks++;
+      b2 = ctx->nblocks++;
+      emit(ctx,"br label %%L%d",b1);
+      emitBlock(ctx,b1);
+      llGen(ctx,t->child[0]);
+      genTest(ctx,t->child[1],val);
+      emit(ctx,"br i1 %s, label %%L%d, label %%L%d",val,b2,b1);
+      emitBlock(ctx,b2);
+      if (TraceCode) llComment(ctx,"<- repeat");
+      break;
+    case AssignK :
+      if (TraceCode) llComment(ctx,"-> assign");
+      genExp(ctx,t->child[0],val);
+      emit(ctx,"store i32 %s, i32* %s",val,global(ctx,t->attr.sym,var));
+      if (TraceCode) llComment(ctx,"<- assign");
+      break;
+    case ReadK :
+      emit(ctx,"%s = call i32 @tinyRead()",newTemp(ctx,val));
+      emit(ctx,"store i32 %s, i32* %s",val,global(ctx,t->attr.sym,var));
+      break;
+    case WriteK :
+      genExp(ctx,t->child[0],val);
+      emit(ctx,"call void @tinyWrite(i32 %s)",val);
+      break;
+    default:
+      break;
+  }
+}
+
+/* Procedure llGen generates code for a sequence
+ * of statements
+ */
+static void llGen( CompileCtx * ctx, NodeId n )
+{ while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    if (t->nodekind == StmtK) genStmt(ctx,t);
+    n = t->sibling;
+  }
+}
+
+/**********************************************/
+/* the primary function of the code generator */
+/**********************************************/
+/* Procedure llvmGen generates LLVM IR to the code
+ * file by traversal of the syntax tree. The
+ * second parameter (codefile) is the file name
+ * of the code file, and is used to print the
+ * file name as a comment in the code file
+ */
+void llvmGen(CompileCtx * ctx, NodeId syntaxTree, char * codefile)
+{  llvmGenBegin(ctx,codefile);
+   llGen(ctx,syntaxTree);
+   llvmGenEnd(ctx);
+}
+
+/* Procedure llvmGenBegin emits the heading and
+ * the entry block of main to the code file
+ */
+void llvmGenBegin(CompileCtx * ctx, char * codefile)
+{  fprintf(ctx->code,"; TINY Compilation to LLVM IR\n");
+   fprintf(ctx->code,"; File: %s\n",codefile);
+   fprintf(ctx->code,"define i32 @main() {\n");
+   fprintf(ctx->code,"entry:\n");
+}
+
+/* Procedure llvmGenStmt emits the code of one
+ * top-level statement
+ */
+void llvmGenStmt(CompileCtx * ctx, NodeId stmt)
+{  llGen(ctx,stmt); }
+
+/* Procedure llvmGenEnd emits the end of main,
+ * the variables and the runtime declarations
+ */
+void llvmGenEnd(CompileCtx * ctx)
+{  int i;
+   llComment(ctx,"End of execution.");
+   emit(ctx,"ret i32 0");
+   fprintf(ctx->code,"divzero:\n");
+   emit(ctx,"call void @tinyDivZero()");
+   emit(ctx,"unreachable");
+   fprintf(ctx->code,"}\n\n");
+   for (i=0;i<ctx->nglobals;i++)
+     if (ctx->globalSym[i] >= 0)
+       fprintf(ctx->code,"@tiny.%s = internal global i32 0\n",
+               st_name(ctx,ctx->globalSym[i]));
+   fprintf(ctx->code,"\ndeclare i32 @tinyRead()\n");
+   fprintf(ctx->code,"declare void @tinyWrite(i32)\n");
+   fprintf(ctx->code,"declare void @tinyDivZero() noreturn\n");
+}
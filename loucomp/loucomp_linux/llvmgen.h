@@ -0,0 +1,46 @@
+/****************************************************/
+/* File: llvmgen.h                                  */
+/* The LLVM IR code generator interface to the      */
+/* TINY compiler                                    */
+/* The code is textual LLVM IR; read and write call */
+/* the runtime in tinyrt.c. It is optimized with    */
+/* opt, and then JIT-run with lli or made into an   */
+/* object file with llc:                            */
+/*    opt -O2 prog.ll -o prog.bc                    */
+/*    lli --extra-object=tinyrt.o prog.bc           */
+/*    llc -filetype=obj prog.bc -o prog.o           */
+/*    cc -o prog prog.o tinyrt.o                    */
+/****************************************************/
+
+#ifndef _LLVMGEN_H_
+#define _LLVMGEN_H_
+
+/* Procedure llvmGen generates LLVM IR to the code
+ * file by traversal of the syntax tree. The
+ * second parameter (codefile) is the file name
+ * of the code file, and is used to print the
+ * file name as a comment in the code file
+ */
+void llvmGen(CompileCtx * ctx, NodeId syntaxTree, char * codefile);
+
+/* llvmGen is llvmGenBegin, then llvmGenStmt for
+ * each top-level statement, then llvmGenEnd; the
+ * streaming mode calls these as it goes
+ */
+
+/* Procedure llvmGenBegin emits the heading and
+ * the entry block of main to the code file
+ */
+void llvmGenBegin(CompileCtx * ctx, char * codefile);
+
+/* Procedure llvmGenStmt emits the code of one
+ * top-level statement
+ */
+void llvmGenStmt(CompileCtx * ctx, NodeId stmt);
+
+/* Procedure llvmGenEnd emits the end of main,
+ * the variables and the runtime declarations
+ */
+void llvmGenEnd(CompileCtx * ctx);
+
+#endif
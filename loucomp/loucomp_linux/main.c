@@ -6,6 +6,10 @@
 /****************************************************/
 
 #include "globals.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
 
 /* set NO_PARSE to TRUE to get a scanner-only compiler */
 #define NO_PARSE FALSE
@@ -18,6 +22,11 @@
 #define NO_CODE FALSE
 
 #include "util.h"
+#include "arena.h"
+#include "cache.h"
+#include "stats.h"
+#include "unroll.h"
+#include "server.h"
 #if NO_PARSE
 #include "scan.h"
 #else
@@ -26,16 +35,17 @@
 #include "analyze.h"
 #if !NO_CODE
 #include "cgen.h"
+#include "sccp.h"
+#include "x86gen.h"
+#include "llvmgen.h"
+#include "tmeng.h"
+#include "tmlanes.h"
+#include "tmjit.h"
+#include "tmsched.h"
 #endif
 #endif
 #endif
 
-/* allocate global variables */
-int lineno = 0;
-FILE * source;
-FILE * listing;
-FILE * code;
-
 /* allocate and set tracing flags */
 int EchoSource = FALSE;
 int TraceScan = FALSE;
@@ -43,60 +53,967 @@ int TraceParse = FALSE;
 int TraceAnalyze = FALSE;
 int TraceCode = FALSE;
 
-int Error = FALSE;
+/* a program named on the command line (its
+ * text, if it was given on standard input), the
+ * listing it is compiled to, and the result and
+ * statistics of its compilation
+ */
+typedef struct
+   { char * name;
+     char * text; /* for name "-", else NULL */
+     long textLen;
+     FILE * listing;
+     int status;
+     int cached; /* TRUE if taken from the cache */
+     PhaseStats stats[NPHASES];
+   } Job;
 
-main( int argc, char * argv[] )
-{ TreeNode * syntaxTree;
-  char pgm[120]; /* source code file name */
-  if (argc != 2)
-    { fprintf(stderr,"usage: %s <filename>\n",argv[0]);
-      exit(1);
+/* what tiny writes to stdout and stderr goes to
+ * out and err, which tiny -serve sends back to
+ * the client instead
+ */
+static FILE * out;
+static FILE * err;
+
+/* with -serve, the contexts of finished
+ * compilations are reset and kept in pool, up to
+ * POOLMAX of them, for the next ones to reuse
+ */
+#define POOLMAX 64
+static int serving = FALSE;
+static CompileCtx * pool[POOLMAX];
+static int npool = 0;
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* the cache directory given with -cache, or NULL */
+static char * cacheDir = NULL;
+
+/* options describes every setting that changes the
+ * listing or the code of a program; it is part of
+ * each cache key
+ */
+static char options[80];
+
+/* -stats asks for a statistics report, as text
+ * (STATS_TEXT) or as JSON (STATS_JSON), on stderr
+ */
+#define STATS_NONE 0
+#define STATS_TEXT 1
+#define STATS_JSON 2
+static int statsMode = STATS_NONE;
+
+/* -stream compiles one top-level statement at a
+ * time (see compileStream)
+ */
+static int streaming = FALSE;
+
+/* -pipe scans each program in a thread of its
+ * own, ahead of the parser (see pipe.c), so that
+ * a large program uses two cores for the front
+ * end; the listing and the code are the same
+ */
+static int pipelined = FALSE;
+
+/* -run runs each program on the TM engine as soon
+ * as it is compiled, instead of writing its code
+ * file; the listing then goes to stderr, leaving
+ * stdout to the OUT instructions of the program
+ */
+static int runMode = FALSE;
+
+/* -O propagates constants and removes the code
+ * that never runs (see sccp.c), and makes the TM
+ * code reuse values computed before instead of
+ * computing them again (see cse.c)
+ */
+static int optimize = FALSE;
+
+/* with -O, a counted repeat runs unrollFactor
+ * copies of its body for each test (see
+ * unroll.c); -unroll n sets it, 1 turning the
+ * unrolling off
+ */
+static int unrollFactor = 4;
+
+/* -prof-gen, with -run, writes the TM execution
+ * profile of each program to its ".prof" file;
+ * -prof-use reads it back, and lays out the TM
+ * code so that the arm of each if that ran most
+ * follows the test (see cgen.c). The profile is
+ * that of code made with the same -O setting,
+ * and without -prof-use
+ */
+static int profGen = FALSE;
+static int profUse = FALSE;
+
+/* -lines, with -run, reports on stderr how many
+ * TM instructions ran for each source line
+ */
+static int lineReport = FALSE;
+
+/* -jit, with -run, compiles the hot loops of the
+ * program to native code as it runs (see tmjit.h)
+ */
+static int jitMode = FALSE;
+
+/* -batch, with -run, runs each program once for
+ * each line of stdin, with the numbers on the
+ * line as its input, LANES runs at a time on the
+ * multi-lane engine (see tmlanes.h); the OUT
+ * values of each run are written on a line of
+ * their own. The lines are read once, into
+ * batchLine, for all the programs
+ */
+static int batchMode = FALSE;
+static char * batchText = NULL;
+static char ** batchLine = NULL;
+static int nbatch = 0;
+
+/* -slice n, with -run, runs the programs together
+ * on one thread instead of one after the other:
+ * each is a session that runs n instructions at a
+ * time (see tmsched.h). Session k is the k-th
+ * program; a line "k v ..." of stdin gives it
+ * the values v as input, and is read only when
+ * every session that has not stopped is waiting
+ * for input. Each OUT is written as "k: value".
+ * With -prio an earlier session runs whenever it
+ * can, instead of all in turn
+ */
+static int sessionMode = FALSE;
+static long sliceSize = 0;
+static int prioMode = FALSE;
+static TMSCHED * sched = NULL;
+
+/* the code made: TM code in a ".tm" file, or with
+ * -x86 x86-64 assembly in a ".s" file (see
+ * x86gen.c), or with -llvm LLVM IR in a ".ll"
+ * file (see llvmgen.c)
+ */
+#define TARGET_TM 0
+#define TARGET_X86 1
+#define TARGET_LLVM 2
+static int target = TARGET_TM;
+static char * codeExt[] = { ".tm", ".s", ".ll" };
+
+/* Function compileWhole compiles the program of
+ * ctx as a whole: it is parsed into one syntax
+ * tree, which is then analyzed and turned into
+ * code in codefile; *written is set to codefile
+ * once it has been written. Returns 0, or 1 if
+ * a file could not be opened
+ */
+static int compileWhole( CompileCtx * ctx, char * codefile, char ** written )
+{ NodeId syntaxTree;
+  int status = 0;
+  beginPhase(ctx);
+#if NO_PARSE
+  while (getToken(ctx)!=ENDFILE);
+  endPhase(ctx,PH_PARSE);
+#else
+  syntaxTree = parse(ctx);
+  endPhase(ctx,PH_PARSE);
+  if (TraceParse) {
+    fprintf(ctx->listing,"\nSyntax tree:\n");
+    printTree(ctx,syntaxTree);
+  }
+#if !NO_ANALYZE
+  if (! ctx->Error)
+  { beginPhase(ctx);
+    analyze(ctx,syntaxTree);
+    endPhase(ctx,PH_ANALYZE);
+  }
+#if !NO_CODE
+  if (! ctx->Error)
+  { ctx->code = runMode ? NULL : fopen(codefile,"w");
+    if (!runMode && (ctx->code == NULL))
+    { fprintf(ctx->listing,"Unable to open %s\n",codefile);
+      status = 1;
+    }
+    else
+    { beginPhase(ctx);
+      if (optimize)
+      { syntaxTree = propagate(ctx,syntaxTree);
+        unrollLoops(ctx,syntaxTree);
+      }
+      if (target == TARGET_X86) x86Gen(ctx,syntaxTree,codefile);
+      else if (target == TARGET_LLVM) llvmGen(ctx,syntaxTree,codefile);
+      else codeGen(ctx,syntaxTree,codefile);
+      endPhase(ctx,PH_CODEGEN);
+      if (ctx->code != NULL)
+      { fclose(ctx->code);
+        *written = codefile;
+      }
+    }
+  }
+#endif
+#endif
+#endif
+  return status;
+}
+
+#if !NO_PARSE && !NO_ANALYZE && !NO_CODE
+/* Function compileStream compiles the program of
+ * ctx one top-level statement at a time: each is
+ * parsed, analyzed and turned into code, and its
+ * nodes are then given back, so memory use does
+ * not grow with the length of the program. The
+ * code goes to a ".part" file that replaces
+ * codefile only if there were no errors, in which
+ * case *written is set to codefile. The listing is
+ * that of compile, except that the syntax tree is
+ * printed as the statements are parsed. Returns 0,
+ * or 1 if a file could not be opened
+ */
+static int compileStream( CompileCtx * ctx, char * codefile, char ** written )
+{ char * partfile = (char *) malloc(strlen(codefile)+6);
+  NodeId stmt;
+  int status = 0;
+  /* with -run, ctx->keepImage is set and code is
+     made in memory only */
+  int coding = TRUE;
+  sprintf(partfile,"%s.part",codefile);
+  ctx->code = runMode ? NULL : fopen(partfile,"w");
+  if (!runMode && (ctx->code == NULL))
+  { fprintf(ctx->listing,"Unable to open %s\n",partfile);
+    status = 1;
+    coding = FALSE;
+  }
+  else if (target == TARGET_X86) x86GenBegin(ctx,codefile);
+  else if (target == TARGET_LLVM) llvmGenBegin(ctx,codefile);
+  else codeGenBegin(ctx,codefile);
+  if (TraceParse) fprintf(ctx->listing,"\nSyntax tree:\n");
+  for (;;)
+  { beginPhase(ctx);
+    stmt = parseNext(ctx);
+    endPhase(ctx,PH_PARSE);
+    if (stmt == NIL_NODE) break;
+    if (TraceParse) printTree(ctx,stmt);
+    /* after a syntax error nothing more is analyzed,
+       and after a type error no more code is made */
+    if (! ctx->Error)
+    { beginPhase(ctx);
+      analyzeStmt(ctx,stmt);
+      endPhase(ctx,PH_ANALYZE);
+      if (coding && !analyzeFailed(ctx))
+      { beginPhase(ctx);
+        if (optimize)
+        { stmt = propagateStmt(ctx,stmt);
+          unrollLoops(ctx,stmt);
+        }
+        if (target == TARGET_X86) x86GenStmt(ctx,stmt);
+        else if (target == TARGET_LLVM) llvmGenStmt(ctx,stmt);
+        else codeGenStmt(ctx,stmt);
+        endPhase(ctx,PH_CODEGEN);
+      }
+    }
+    resetNodes(ctx);
+  }
+  if (! ctx->Error)
+  { beginPhase(ctx);
+    analyzeEnd(ctx);
+    endPhase(ctx,PH_ANALYZE);
+  }
+  if (coding && ! ctx->Error)
+  { if (target == TARGET_X86) x86GenEnd(ctx);
+    else if (target == TARGET_LLVM) llvmGenEnd(ctx);
+    else codeGenEnd(ctx);
+  }
+  if (ctx->code != NULL)
+  { fclose(ctx->code);
+    if (! ctx->Error && (rename(partfile,codefile) == 0))
+      *written = codefile;
+    else remove(partfile);
+  }
+  free(partfile);
+  return status;
+}
+
+/* Function runImage runs the code that was kept
+ * in ctx->image on a new TM: IN reads stdin and
+ * OUT writes stdout. A run that does not end in
+ * HALT is reported on stderr. Returns 0, or 1 if
+ * the machine faulted. With -prof-gen, the profile
+ * of the run is written to file profname; with
+ * -lines, the instructions run for each source
+ * line are reported; with -jit, the hot loops run
+ * as native code
+ */
+static int runImage( CompileCtx * ctx, char * pgm, char * profname )
+{ TM * tm;
+  FILE * prof;
+  STEPRESULT result;
+  int isize = (ctx->highEmitLoc > IADDR_SIZE) ? ctx->highEmitLoc : IADDR_SIZE;
+  tm = tmNew(isize);
+  if (tm == NULL)
+  { fprintf(stderr,"Out of memory running %s\n",pgm);
+    return 1;
+  }
+  if (ctx->image != NULL)
+    memcpy(tm->iMem,ctx->image,ctx->highEmitLoc*sizeof(INSTRUCTION));
+  if ((profGen || lineReport) && !tmProfile(tm))
+    fprintf(stderr,"Out of memory profiling %s\n",pgm);
+  if (lineReport)
+  { int loc;
+    for (loc = 0; loc < ctx->highEmitLoc; loc++)
+      tmSetLine(tm,loc,ctx->srcLines[loc]);
+  }
+  result = jitMode ? tmJitRun(tm,NULL) : tmRun(tm,NULL);
+  fflush(stdout);
+  if (result != srHALT)
+    fprintf(stderr,"%s: %s at location %d\n",
+            pgm,stepResultTab[result],tm->reg[PC_REG]-1);
+  if (lineReport && (tm->profile != NULL))
+  { fprintf(stderr,"\n%s: ",pgm);
+    tmLineReport(tm,stderr);
+  }
+  if (profGen && (tm->profile != NULL))
+  { prof = fopen(profname,"w");
+    if (prof == NULL)
+      fprintf(stderr,"Unable to open %s\n",profname);
+    else
+    { tmWriteProfile(tm->profile,prof);
+      fclose(prof);
     }
-  strcpy(pgm,argv[1]) ;
+  }
+  tmFree(tm);
+  return result != srHALT;
+}
+
+/* a run of -batch: the rest of its line of input,
+ * and the OUT values it wrote
+ */
+typedef struct
+   { char * in;
+     FILE * out;
+     char * outText;
+     size_t outLen;
+   } BatchRun;
+
+/* batchInput reads the next number of the line of
+   the run in lane l */
+static int batchInput( TMLANES * tm, int l, int * value )
+{ BatchRun * run = (BatchRun *) tm->user + l;
+  char * end;
+  long v = strtol(run->in,&end,10);
+  if (end == run->in) return FALSE;
+  run->in = end;
+  *value = (int) v;
+  return TRUE;
+}
+
+/* batchOutput notes value as written by the run
+   in lane l */
+static void batchOutput( TMLANES * tm, int l, int value )
+{ BatchRun * run = (BatchRun *) tm->user + l;
+  fprintf(run->out,(ftell(run->out) > 0) ? " %d" : "%d",value);
+}
+
+/* Function runBatch runs the code kept in
+ * ctx->image once for each line of batchLine,
+ * LANES runs at a time, writing the OUT values of
+ * each run as a line of stdout. A run that does
+ * not end in HALT is reported on stderr. Returns
+ * 0, or 1 if a run faulted
+ */
+static int runBatch( CompileCtx * ctx, char * pgm )
+{ BatchRun run[LANES];
+  TMLANES * tm;
+  INSTRUCTION * code;
+  int isize = (ctx->highEmitLoc > IADDR_SIZE) ? ctx->highEmitLoc : IADDR_SIZE;
+  int status = 0, first, n, l;
+  /* as on a TM, all that was not loaded holds
+     HALT 0,0,0 */
+  code = (INSTRUCTION *) calloc(isize,sizeof(INSTRUCTION));
+  tm = (code != NULL) ? tmLanesNew(code,isize) : NULL;
+  if (tm == NULL)
+  { fprintf(stderr,"Out of memory running %s\n",pgm);
+    free(code);
+    return 1;
+  }
+  if (ctx->image != NULL)
+    memcpy(code,ctx->image,ctx->highEmitLoc*sizeof(INSTRUCTION));
+  tm->input = batchInput;
+  tm->output = batchOutput;
+  tm->user = run;
+  for (first = 0; first < nbatch; first += LANES)
+  { n = (nbatch-first < LANES) ? nbatch-first : LANES;
+    for (l = 0; l < n; l++)
+    { run[l].in = batchLine[first+l];
+      run[l].out = open_memstream(&run[l].outText,&run[l].outLen);
+      if (run[l].out == NULL)
+      { fprintf(stderr,"Out of memory running %s\n",pgm);
+        exit(1);
+      }
+    }
+    tmLanesReset(tm,n);
+    tmLanesRun(tm);
+    for (l = 0; l < n; l++)
+    { fclose(run[l].out);
+      printf("%s\n",run[l].outText);
+      free(run[l].outText);
+    }
+    fflush(stdout);
+    for (l = 0; l < n; l++)
+      if (tm->result[l] != srHALT)
+      { fprintf(stderr,"%s: run %d: %s at location %d\n",pgm,first+l+1,
+                stepResultTab[tm->result[l]],tm->stopLoc[l]);
+        status = 1;
+      }
+  }
+  tmLanesFree(tm);
+  free(code);
+  return status;
+}
+
+/* Function addSession adds the code kept in
+ * ctx->image to sched, as a session on a TM of
+ * its own; returns 0, or 1 if out of memory
+ */
+static int addSession( CompileCtx * ctx, char * pgm )
+{ int isize = (ctx->highEmitLoc > IADDR_SIZE) ? ctx->highEmitLoc : IADDR_SIZE;
+  TM * tm = tmNew(isize);
+  if (tm != NULL)
+  { if (ctx->image != NULL)
+      memcpy(tm->iMem,ctx->image,ctx->highEmitLoc*sizeof(INSTRUCTION));
+    /* the earlier programs come first with -prio */
+    if (tmSchedAdd(sched,tm,-sched->ntasks) != NULL) return 0;
+    tmFree(tm);
+  }
+  fprintf(stderr,"Out of memory running %s\n",pgm);
+  return 1;
+}
+
+/* Function readBatch reads the lines of stdin into
+ * batchLine; FALSE if it could not be read
+ */
+static int readBatch( void )
+{ long len, i;
+  int n = 0;
+  batchText = readAll(0,&len);
+  if (batchText == NULL) return FALSE;
+  for (i = 0; i < len; i++)
+    if (batchText[i] == '\n') n++;
+  batchLine = (char **) malloc((n+1)*sizeof(char *));
+  if (batchLine == NULL)
+  { free(batchText);
+    batchText = NULL;
+    return FALSE;
+  }
+  nbatch = 0;
+  for (i = 0; i < len; i = (batchText[i] == '\0') ? i+1 : i)
+  { batchLine[nbatch++] = batchText+i;
+    while ((i < len) && (batchText[i] != '\n')) i++;
+    if (i < len) batchText[i] = '\0';
+  }
+  return TRUE;
+}
+#endif
+
+/* Function takeContext returns a context for a
+ * compilation: one from the pool if there is
+ * one, else a new one; NULL if out of memory
+ */
+static CompileCtx * takeContext( void )
+{ CompileCtx * ctx = NULL;
+  pthread_mutex_lock(&poolLock);
+  if (npool > 0) ctx = pool[--npool];
+  pthread_mutex_unlock(&poolLock);
+  return (ctx != NULL) ? ctx : newContext();
+}
+
+/* Procedure giveContext is done with ctx: with
+ * -serve it goes back to the pool, else (or if
+ * the pool is full) it is released
+ */
+static void giveContext( CompileCtx * ctx )
+{ if (serving)
+  { resetContext(ctx);
+    pthread_mutex_lock(&poolLock);
+    if (npool < POOLMAX)
+    { pool[npool++] = ctx;
+      ctx = NULL;
+    }
+    pthread_mutex_unlock(&poolLock);
+  }
+  if (ctx != NULL) freeContext(ctx);
+}
+
+/* Function compile compiles the TINY program in
+ * file job->name (".tny" is added if there is no
+ * extension; "-" is the program on standard
+ * input, compiled as "stdin.tny"), writing the
+ * listing to job->listing, the code to the
+ * matching ".tm" file (".s" with -x86, ".ll"
+ * with -llvm) and the figures of each phase to
+ * job->stats. All state
+ * lives in a context of its own, so several calls
+ * may run at once. With a cache directory, a
+ * program compiled before (same source, compiler
+ * and options) is not compiled again: its listing
+ * and code are taken from the cache. With -run,
+ * no code file is written and the program is run
+ * instead. The ".prof" file of -prof-gen and
+ * -prof-use has the name of the code file.
+ * Returns 0, or 1 if a file could not be opened
+ * or the run failed
+ */
+static int compile( Job * job )
+{ char * name = job->name;
+  FILE * listing = job->listing;
+  CompileCtx * ctx;
+  char pgm[120]; /* source code file name */
+  char * codefile; /* code file name */
+  char * profname; /* profile file name */
+  FILE * prof;
+  char * written = NULL; /* codefile, once written */
+  char key[CACHEKEYLEN+1];
+  int caching = FALSE;
+  int status = 0;
+  int fnlen, c;
+  strcpy(pgm,(job->text != NULL) ? "stdin" : name) ;
   if (strchr (pgm, '.') == NULL)
      strcat(pgm,".tny");
-  source = fopen(pgm,"r");
-  if (source==NULL)
-  { fprintf(stderr,"File %s not found\n",pgm);
-    exit(1);
+  ctx = takeContext();
+  if (ctx == NULL)
+  { fprintf(err,"Out of memory compiling %s\n",pgm);
+    return 1;
   }
-  listing = stdout; /* send listing to screen */
+  if (job->text != NULL)
+    ctx->source = fmemopen(job->text,job->textLen,"r");
+  else ctx->source = fopen(pgm,"r");
+  if (ctx->source==NULL)
+  { fprintf(err,"File %s not found\n",pgm);
+    giveContext(ctx);
+    return 1;
+  }
+  fnlen = strcspn(pgm,".");
+  codefile = (char *) calloc(fnlen+4, sizeof(char));
+  strncpy(codefile,pgm,fnlen);
+  strcat(codefile,codeExt[target]);
+  profname = (char *) calloc(fnlen+6, sizeof(char));
+  strncpy(profname,pgm,fnlen);
+  strcat(profname,".prof");
   fprintf(listing,"\nTINY COMPILATION: %s\n",pgm);
-#if NO_PARSE
-  while (getToken()!=ENDFILE);
-#else
-  syntaxTree = parse();
-  if (TraceParse) {
-    fprintf(listing,"\nSyntax tree:\n");
-    printTree(syntaxTree);
+  ctx->listing = listing;
+  /* the code names its file, so the key covers
+     the code file name as well as the options */
+  if ((cacheDir != NULL) && !runMode && !profUse
+      && (strlen(options)+strlen(codefile) < 512))
+  { char keyopts[576];
+    sprintf(keyopts,"%s %s",options,codefile);
+    if (cacheKey(key,ctx->source,keyopts))
+    { if (cacheFetch(cacheDir,key,listing,NO_CODE ? NULL : codefile))
+      { job->cached = TRUE;
+        free(codefile);
+        free(profname);
+        fclose(ctx->source);
+        giveContext(ctx);
+        return 0;
+      }
+      ctx->listing = tmpfile();
+      caching = (ctx->listing != NULL);
+      if (!caching) ctx->listing = listing;
+    }
   }
-#if !NO_ANALYZE
-  if (! Error)
-  { if (TraceAnalyze) fprintf(listing,"\nBuilding Symbol Table...\n");
-    buildSymtab(syntaxTree);
-    if (TraceAnalyze) fprintf(listing,"\nChecking Types...\n");
-    typeCheck(syntaxTree);
-    if (TraceAnalyze) fprintf(listing,"\nType Checking Finished\n");
+  ctx->pipelined = pipelined;
+  ctx->keepImage = runMode;
+  ctx->optimize = optimize;
+  ctx->unroll = unrollFactor;
+#if !NO_CODE
+  if (profUse)
+  { prof = fopen(profname,"r");
+    if (prof != NULL)
+    { ctx->profile = tmReadProfile(prof);
+      fclose(prof);
+    }
+    if (ctx->profile == NULL)
+      fprintf(err,"%s: no profile in %s, code laid out plainly\n",pgm,profname);
   }
+#endif
+#if !NO_PARSE && !NO_ANALYZE && !NO_CODE
+  if (streaming)
+    status = compileStream(ctx,codefile,&written);
+  else
+#endif
+  status = compileWhole(ctx,codefile,&written);
+#if !NO_PARSE && !NO_ANALYZE && !NO_CODE
+  if (runMode && sessionMode && (status == 0) && ! ctx->Error)
+    status = addSession(ctx,pgm);
+  else if (runMode && batchMode && (status == 0) && ! ctx->Error)
+    status = runBatch(ctx,pgm);
+  else if (runMode && (status == 0) && ! ctx->Error)
+    status = runImage(ctx,pgm,profname);
+#endif
+  if (caching)
+  { /* a failed run is not entered into the cache */
+    if (status == 0)
+      cacheStore(cacheDir,key,ctx->listing,written);
+    rewind(ctx->listing);
+    while ((c = getc(ctx->listing)) != EOF)
+      putc(c,listing);
+    fclose(ctx->listing);
+  }
+  memcpy(job->stats,ctx->stats,sizeof(job->stats));
 #if !NO_CODE
-  if (! Error)
-  { char * codefile;
-    int fnlen = strcspn(pgm,".");
-    codefile = (char *) calloc(fnlen+4, sizeof(char));
-    strncpy(codefile,pgm,fnlen);
-    strcat(codefile,".tm");
-    code = fopen(codefile,"w");
-    if (code == NULL)
-    { printf("Unable to open %s\n",codefile);
-      exit(1);
-    }
-    codeGen(syntaxTree,codefile);
-    fclose(code);
+  if (ctx->profile != NULL) tmFreeProfile(ctx->profile);
+#endif
+  free(codefile);
+  free(profname);
+  fclose(ctx->source);
+  giveContext(ctx);
+  return status;
+}
+
+static Job * jobs;
+static int njobs;
+
+#if !NO_PARSE && !NO_ANALYZE && !NO_CODE
+/* Function runSessions runs the sessions of sched
+ * until all have stopped, giving them the input
+ * on stdin. A session that does not end in HALT
+ * is reported on stderr. Returns 0, or 1 if a
+ * session faulted
+ */
+static int runSessions( void )
+{ char * line = NULL;
+  size_t size = 0;
+  int status = 0, i;
+  while (tmSchedRun(sched) > 0)
+  { char * p, * end;
+    long k;
+    fflush(stdout);
+    if (getline(&line,&size,stdin) < 0)
+    { /* the sessions waiting for input fail */
+      for (i = 0; i < sched->ntasks; i++) tmSchedClose(sched->task[i]);
+      continue;
+    }
+    k = strtol(line,&end,10);
+    if ((end == line) || (k < 1) || (k > sched->ntasks))
+    { fprintf(stderr,"No session for input line: %s",line);
+      continue;
+    }
+    for (p = end; ; p = end)
+    { long v = strtol(p,&end,10);
+      if (end == p) break;
+      if (! tmSchedFeed(sched->task[k-1],(int) v))
+      { fprintf(stderr,"Out of memory reading input\n");
+        exit(1);
+      }
+    }
+  }
+  fflush(stdout);
+  for (i = 0; i < sched->ntasks; i++)
+  { TMTASK * t = sched->task[i];
+    if (t->result != srHALT)
+    { fprintf(stderr,"%s: session %d: %s at location %d\n",jobs[i].name,
+              t->id,stepResultTab[t->result],t->tm->reg[PC_REG]-1);
+      status = 1;
+    }
   }
+  free(line);
+  return status;
+}
 #endif
+
+/* index of the next job to hand out */
+static int nextJob = 0;
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* worker is run by each thread of the pool: it
+ * takes jobs in order until none are left
+ */
+static void * worker( void * arg )
+{ for (;;)
+  { int i;
+    pthread_mutex_lock(&jobLock);
+    i = nextJob++;
+    pthread_mutex_unlock(&jobLock);
+    if (i >= njobs) break;
+    jobs[i].status = compile(&jobs[i]);
+  }
+  return arg;
+}
+
+/* Procedure compileAll compiles every job on a
+ * pool of nthreads threads. Each listing goes to
+ * a temporary file, and the listings are copied
+ * to stdout in command-line order once all jobs
+ * are done, so the output is the same as that of
+ * compiling the files one after another
+ */
+static void compileAll( int nthreads )
+{ pthread_t * threads;
+  int i, c;
+  if (nthreads > njobs) nthreads = njobs;
+  if (nthreads <= 1)
+  { for (i=0;i<njobs;i++)
+    { jobs[i].listing = runMode ? err : out;
+      jobs[i].status = compile(&jobs[i]);
+    }
+    return;
+  }
+  for (i=0;i<njobs;i++)
+  { jobs[i].listing = tmpfile();
+    if (jobs[i].listing == NULL) jobs[i].listing = out;
+  }
+  threads = (pthread_t *) malloc(nthreads*sizeof(pthread_t));
+  for (i=0;i<nthreads;i++)
+    if (pthread_create(&threads[i],NULL,worker,NULL) != 0)
+      break;
+  nthreads = i;
+  if (nthreads == 0) worker(NULL);
+  for (i=0;i<nthreads;i++)
+    pthread_join(threads[i],NULL);
+  free(threads);
+  for (i=0;i<njobs;i++)
+    if (jobs[i].listing != out)
+    { rewind(jobs[i].listing);
+      while ((c = getc(jobs[i].listing)) != EOF)
+        putc(c,out);
+      fclose(jobs[i].listing);
+    }
+}
+
+
+/* Function tinyMain does what the command
+ * "tiny argv[1] ... argv[argc-1]" does, and
+ * returns its exit status. text (textLen bytes)
+ * is the program of a "-" argument; if it is
+ * NULL, that program is read from stdin
+ */
+static int tinyMain( int argc, char * argv[], char * text, long textLen )
+{ int nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  int status = 0;
+  int fromStdin = 0;
+  int i;
+  /* a server runs many commands, so every
+     option starts from its default */
+  cacheDir = NULL;
+  statsMode = STATS_NONE;
+  streaming = pipelined = runMode = optimize = FALSE;
+  unrollFactor = 4;
+  profGen = profUse = lineReport = batchMode = jitMode = FALSE;
+  sessionMode = prioMode = FALSE;
+  sliceSize = 0;
+  target = TARGET_TM;
+  nextJob = 0;
+  jobs = (Job *) malloc(argc*sizeof(Job));
+  njobs = 0;
+  for (i=1;i<argc;i++)
+  { if ((strcmp(argv[i],"-j") == 0) && (i+1 < argc))
+      nthreads = atoi(argv[++i]);
+    else if ((strcmp(argv[i],"-cache") == 0) && (i+1 < argc))
+      cacheDir = argv[++i];
+    else if (strcmp(argv[i],"-stream") == 0)
+      streaming = TRUE;
+    else if (strcmp(argv[i],"-pipe") == 0)
+      pipelined = TRUE;
+    else if (strcmp(argv[i],"-run") == 0)
+      runMode = TRUE;
+    else if (strcmp(argv[i],"-O") == 0)
+      optimize = TRUE;
+    else if ((strcmp(argv[i],"-unroll") == 0) && (i+1 < argc))
+      unrollFactor = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-prof-gen") == 0)
+      profGen = TRUE;
+    else if (strcmp(argv[i],"-prof-use") == 0)
+      profUse = TRUE;
+    else if (strcmp(argv[i],"-lines") == 0)
+      lineReport = TRUE;
+    else if (strcmp(argv[i],"-batch") == 0)
+      batchMode = TRUE;
+    else if (strcmp(argv[i],"-jit") == 0)
+      jitMode = TRUE;
+    else if ((strcmp(argv[i],"-slice") == 0) && (i+1 < argc))
+    { sessionMode = TRUE;
+      sliceSize = atol(argv[++i]);
+    }
+    else if (strcmp(argv[i],"-prio") == 0)
+      prioMode = TRUE;
+    else if (strcmp(argv[i],"-x86") == 0)
+      target = TARGET_X86;
+    else if (strcmp(argv[i],"-llvm") == 0)
+      target = TARGET_LLVM;
+    else if (strcmp(argv[i],"-stats") == 0)
+      statsMode = STATS_TEXT;
+    else if (strcmp(argv[i],"-stats=json") == 0)
+      statsMode = STATS_JSON;
+    else
+    { memset(&jobs[njobs],0,sizeof(Job));
+      jobs[njobs].name = argv[i];
+      jobs[njobs].status = 0;
+      if (strcmp(argv[i],"-") == 0) fromStdin++;
+      njobs++;
+    }
+  }
+  if ((njobs == 0) || (runMode && (target != TARGET_TM))
+      || (unrollFactor < 1) || (unrollFactor > UNROLLMAX)
+      || ((profGen || lineReport || batchMode || jitMode) && !runMode)
+      || (profGen && profUse)
+      || ((batchMode || jitMode || sessionMode) && (profGen || lineReport))
+      || (batchMode + jitMode + sessionMode > 1)
+      || (sessionMode && (!runMode || (sliceSize < 1)))
+      || (prioMode && !sessionMode)
+      || (profUse && (streaming || (target != TARGET_TM)))
+      || (pipelined && streaming)
+      /* stdin holds one program, or the input of -run */
+      || (fromStdin > 1) || (fromStdin && runMode))
+    { fprintf(err,"usage: %s [-j threads] [-cache dir] [-stats[=json]] [-stream | -pipe] [-O] [-unroll n] [-prof-gen | -prof-use] [-run [-lines | -batch | -jit | -slice n [-prio]] | -x86 | -llvm] <filename> ...\n"
+                  "       %s -serve socket\n",argv[0],argv[0]);
+      free(jobs);
+      return 1;
+    }
+  if (serving && runMode)
+  { fprintf(err,"%s: -run needs a terminal, not a compile server\n",argv[0]);
+    free(jobs);
+    return 1;
+  }
+  if (fromStdin && (text == NULL))
+  { text = readAll(0,&textLen);
+    if (text == NULL)
+    { fprintf(err,"Unable to read stdin\n");
+      free(jobs);
+      return 1;
+    }
+  }
+#if !NO_PARSE && !NO_ANALYZE && !NO_CODE
+  if (batchMode && !readBatch())
+  { fprintf(err,"Unable to read stdin\n");
+    free(jobs);
+    return 1;
+  }
 #endif
+  for (i=0;i<njobs;i++)
+    if (strcmp(jobs[i].name,"-") == 0)
+    { jobs[i].text = text;
+      jobs[i].textLen = textLen;
+    }
+  sprintf(options,"trace=%d%d%d%d%d phases=%d%d%d stream=%d target=%d O=%d unroll=%d",
+          EchoSource,TraceScan,TraceParse,TraceAnalyze,TraceCode,
+          NO_PARSE,NO_ANALYZE,NO_CODE,streaming,target,optimize,
+          optimize ? unrollFactor : 1);
+  /* programs are run one at a time, in order */
+  if (runMode) nthreads = 1;
+#if !NO_PARSE && !NO_ANALYZE && !NO_CODE
+  if (sessionMode)
+  { sched = tmSchedNew(prioMode ? SCHED_PRIORITY : SCHED_ROUND,sliceSize);
+    if (sched == NULL)
+    { fprintf(err,"Out of memory\n");
+      free(jobs);
+      return 1;
+    }
+  }
 #endif
-  fclose(source);
-  return 0;
+  compileAll(nthreads);
+  for (i=0;i<njobs;i++)
+    if (jobs[i].status != 0) status = 1;
+#if !NO_PARSE && !NO_ANALYZE && !NO_CODE
+  /* the sessions are numbered as the programs, so
+     they run only if all of them compiled */
+  if (sessionMode)
+  { if (status == 0) status = runSessions();
+    tmSchedFree(sched);
+    sched = NULL;
+  }
+#endif
+  if (statsMode == STATS_JSON) fprintf(err,"[");
+  for (i=0;i<njobs;i++)
+    if (statsMode != STATS_NONE)
+    { if ((statsMode == STATS_JSON) && (i > 0)) fprintf(err,",\n");
+      printStats(err,jobs[i].name,jobs[i].stats,jobs[i].cached,
+                 statsMode == STATS_JSON);
+    }
+  if (statsMode == STATS_JSON) fprintf(err,"]\n");
+  free(batchText);
+  free(batchLine);
+  batchText = NULL;
+  batchLine = NULL;
+  nbatch = 0;
+  free(jobs);
+  return status;
+}
+
+/* Procedure serveRequest reads a request from
+ * connection fd (see server.h), carries it out
+ * in the directory of the client and sends the
+ * reply back
+ */
+static void serveRequest( int fd )
+{ char * cwd = getBytes(fd,NULL);
+  char * count = getBytes(fd,NULL);
+  char ** argv = NULL;
+  char * text = NULL;
+  long textLen = 0;
+  char status[24];
+  int argc = 0, i, ok;
+  ok = (cwd != NULL) && (count != NULL);
+  if (ok)
+  { argc = atoi(count);
+    ok = (argc >= 1) && (argc < 65536);
+  }
+  if (ok)
+  { argv = (char **) calloc(argc+1,sizeof(char *));
+    ok = (argv != NULL);
+  }
+  for (i=0;ok && (i<argc);i++)
+  { argv[i] = getBytes(fd,NULL);
+    ok = (argv[i] != NULL);
+    if (ok && (i > 0) && (strcmp(argv[i],"-") == 0) && (text == NULL))
+      ok = ((text = getBytes(fd,&textLen)) != NULL);
+  }
+  out = ok ? tmpfile() : NULL;
+  err = ok ? tmpfile() : NULL;
+  if ((out != NULL) && (err != NULL))
+  { if (chdir(cwd) != 0)
+    { fprintf(err,"Unable to change to %s\n",cwd);
+      sprintf(status,"1");
+    }
+    else sprintf(status,"%d",tinyMain(argc,argv,text,textLen));
+    if (putString(fd,status) && putFile(fd,out)) putFile(fd,err);
+  }
+  if (out != NULL) fclose(out);
+  if (err != NULL) fclose(err);
+  out = stdout;
+  err = stderr;
+  if (argv != NULL)
+    for (i=0;i<argc;i++) free(argv[i]);
+  free(argv);
+  free(text);
+  free(count);
+  free(cwd);
+}
+
+/* Function serve makes tiny a compile server:
+ * it listens on the Unix domain socket path and
+ * carries out the requests of tinyc one after
+ * another, with the contexts of earlier
+ * compilations reused. It returns only if the
+ * socket could not be made
+ */
+static int serve( char * path )
+{ int sock = serverListen(path);
+  if (sock < 0)
+  { fprintf(stderr,"Unable to listen on %s\n",path);
+    return 1;
+  }
+  /* a client that goes away must not end the server */
+  signal(SIGPIPE,SIG_IGN);
+  serving = TRUE;
+  for (;;)
+  { int fd = accept(sock,NULL,NULL);
+    if (fd < 0) continue;
+    /* a request reads and writes files as the
+       server's user, so no one else may send one */
+    if (serverPeerOk(fd)) serveRequest(fd);
+    close(fd);
+  }
 }
 
+main( int argc, char * argv[] )
+{ out = stdout;
+  err = stderr;
+  if ((argc == 3) && (strcmp(argv[1],"-serve") == 0))
+    return serve(argv[2]);
+  return tinyMain(argc,argv,NULL,0);
+}
@@ -9,49 +9,61 @@
 #include "util.h"
 #include "scan.h"
 #include "parse.h"
-
-static TokenType token; /* holds current token */
+#include "arena.h"
+#include "pipe.h"
 
 /* function prototypes for recursive calls */
-static TreeNode * stmt_sequence(void);
-static TreeNode * statement(void);
-static TreeNode * if_stmt(void);
-static TreeNode * repeat_stmt(void);
-static TreeNode * assign_stmt(void);
-static TreeNode * read_stmt(void);
-static TreeNode * write_stmt(void);
-static TreeNode * exp(void);
-static TreeNode * simple_exp(void);
-static TreeNode * term(void);
-static TreeNode * factor(void);
-
-static void syntaxError(char * message)
-{ fprintf(listing,"\n>>> ");
-  fprintf(listing,"Syntax error at line %d: %s",lineno,message);
-  Error = TRUE;
+static NodeId stmt_sequence(CompileCtx * ctx);
+static NodeId statement(CompileCtx * ctx);
+static NodeId if_stmt(CompileCtx * ctx);
+static NodeId repeat_stmt(CompileCtx * ctx);
+static NodeId assign_stmt(CompileCtx * ctx);
+static NodeId read_stmt(CompileCtx * ctx);
+static NodeId write_stmt(CompileCtx * ctx);
+static NodeId exp(CompileCtx * ctx);
+static NodeId simple_exp(CompileCtx * ctx);
+static NodeId term(CompileCtx * ctx);
+static NodeId factor(CompileCtx * ctx);
+
+/* Nodes are referred to by NodeId rather than by
+ * pointer because creating a node may move the
+ * node arena: a subtree is always built into a
+ * local first, and only then linked in with NODE()
+ */
+
+/* nextToken returns the next token, from the
+ * scanner thread if there is one (see pipe.h)
+ */
+static TokenType nextToken(CompileCtx * ctx)
+{ return (ctx->pipe != NULL) ? pipeToken(ctx) : getToken(ctx); }
+
+static void syntaxError(CompileCtx * ctx, char * message)
+{ fprintf(ctx->listing,"\n>>> ");
+  fprintf(ctx->listing,"Syntax error at line %d: %s",ctx->lineno,message);
+  ctx->Error = TRUE;
 }
 
-static void match(TokenType expected)
-{ if (token == expected) token = getToken();
+static void match(CompileCtx * ctx, TokenType expected)
+{ if (ctx->token == expected) ctx->token = nextToken(ctx);
   else {
-    syntaxError("unexpected token -> ");
-    printToken(token,tokenString);
-    fprintf(listing,"      ");
+    syntaxError(ctx,"unexpected token -> ");
+    printToken(ctx,ctx->token,ctx->tokenString);
+    fprintf(ctx->listing,"      ");
   }
 }
 
-TreeNode * stmt_sequence(void)
-{ TreeNode * t = statement();
-  TreeNode * p = t;
-  while ((token!=ENDFILE) && (token!=END) &&
-         (token!=ELSE) && (token!=UNTIL))
-  { TreeNode * q;
-    match(SEMI);
-    q = statement();
-    if (q!=NULL) {
-      if (t==NULL) t = p = q;
-      else /* now p cannot be NULL either */
-      { p->sibling = q;
+NodeId stmt_sequence(CompileCtx * ctx)
+{ NodeId t = statement(ctx);
+  NodeId p = t;
+  while ((ctx->token!=ENDFILE) && (ctx->token!=END) &&
+         (ctx->token!=ELSE) && (ctx->token!=UNTIL))
+  { NodeId q;
+    match(ctx,SEMI);
+    q = statement(ctx);
+    if (q!=NIL_NODE) {
+      if (t==NIL_NODE) t = p = q;
+      else /* now p cannot be NIL_NODE either */
+      { NODE(ctx,p)->sibling = q;
         p = q;
       }
     }
@@ -59,157 +71,204 @@ TreeNode * stmt_sequence(void)
   return t;
 }
 
-TreeNode * statement(void)
-{ TreeNode * t = NULL;
-  switch (token) {
-    case IF : t = if_stmt(); break;
-    case REPEAT : t = repeat_stmt(); break;
-    case ID : t = assign_stmt(); break;
-    case READ : t = read_stmt(); break;
-    case WRITE : t = write_stmt(); break;
-    default : syntaxError("unexpected token -> ");
-              printToken(token,tokenString);
-              token = getToken();
+NodeId statement(CompileCtx * ctx)
+{ NodeId t = NIL_NODE;
+  switch (ctx->token) {
+    case IF : t = if_stmt(ctx); break;
+    case REPEAT : t = repeat_stmt(ctx); break;
+    case ID : t = assign_stmt(ctx); break;
+    case READ : t = read_stmt(ctx); break;
+    case WRITE : t = write_stmt(ctx); break;
+    default : syntaxError(ctx,"unexpected token -> ");
+              printToken(ctx,ctx->token,ctx->tokenString);
+              ctx->token = nextToken(ctx);
               break;
   } /* end case */
   return t;
 }
 
-TreeNode * if_stmt(void)
-{ TreeNode * t = newStmtNode(IfK);
-  match(IF);
-  if (t!=NULL) t->child[0] = exp();
-  match(THEN);
-  if (t!=NULL) t->child[1] = stmt_sequence();
-  if (token==ELSE) {
-    match(ELSE);
-    if (t!=NULL) t->child[2] = stmt_sequence();
+NodeId if_stmt(CompileCtx * ctx)
+{ NodeId t = newStmtNode(ctx,IfK);
+  NodeId c;
+  match(ctx,IF);
+  c = exp(ctx);
+  if (t!=NIL_NODE) NODE(ctx,t)->child[0] = c;
+  match(ctx,THEN);
+  c = stmt_sequence(ctx);
+  if (t!=NIL_NODE) NODE(ctx,t)->child[1] = c;
+  if (ctx->token==ELSE) {
+    match(ctx,ELSE);
+    c = stmt_sequence(ctx);
+    if (t!=NIL_NODE) NODE(ctx,t)->child[2] = c;
   }
-  match(END);
+  match(ctx,END);
   return t;
 }
 
-TreeNode * repeat_stmt(void)
-{ TreeNode * t = newStmtNode(RepeatK);
-  match(REPEAT);
-  if (t!=NULL) t->child[0] = stmt_sequence();
-  match(UNTIL);
-  if (t!=NULL) t->child[1] = exp();
+NodeId repeat_stmt(CompileCtx * ctx)
+{ NodeId t = newStmtNode(ctx,RepeatK);
+  NodeId c;
+  match(ctx,REPEAT);
+  c = stmt_sequence(ctx);
+  if (t!=NIL_NODE) NODE(ctx,t)->child[0] = c;
+  match(ctx,UNTIL);
+  c = exp(ctx);
+  if (t!=NIL_NODE) NODE(ctx,t)->child[1] = c;
   return t;
 }
 
-TreeNode * assign_stmt(void)
-{ TreeNode * t = newStmtNode(AssignK);
-  if ((t!=NULL) && (token==ID))
-    t->attr.name = copyString(tokenString);
-  match(ID);
-  match(ASSIGN);
-  if (t!=NULL) t->child[0] = exp();
+NodeId assign_stmt(CompileCtx * ctx)
+{ NodeId t = newStmtNode(ctx,AssignK);
+  NodeId c;
+  if ((t!=NIL_NODE) && (ctx->token==ID))
+    NODE(ctx,t)->attr.sym = ctx->tokenSym;
+  match(ctx,ID);
+  match(ctx,ASSIGN);
+  c = exp(ctx);
+  if (t!=NIL_NODE) NODE(ctx,t)->child[0] = c;
   return t;
 }
 
-TreeNode * read_stmt(void)
-{ TreeNode * t = newStmtNode(ReadK);
-  match(READ);
-  if ((t!=NULL) && (token==ID))
-    t->attr.name = copyString(tokenString);
-  match(ID);
+NodeId read_stmt(CompileCtx * ctx)
+{ NodeId t = newStmtNode(ctx,ReadK);
+  match(ctx,READ);
+  if ((t!=NIL_NODE) && (ctx->token==ID))
+    NODE(ctx,t)->attr.sym = ctx->tokenSym;
+  match(ctx,ID);
   return t;
 }
 
-TreeNode * write_stmt(void)
-{ TreeNode * t = newStmtNode(WriteK);
-  match(WRITE);
-  if (t!=NULL) t->child[0] = exp();
+NodeId write_stmt(CompileCtx * ctx)
+{ NodeId t = newStmtNode(ctx,WriteK);
+  NodeId c;
+  match(ctx,WRITE);
+  c = exp(ctx);
+  if (t!=NIL_NODE) NODE(ctx,t)->child[0] = c;
   return t;
 }
 
-TreeNode * exp(void)
-{ TreeNode * t = simple_exp();
-  if ((token==LT)||(token==EQ)) {
-    TreeNode * p = newExpNode(OpK);
-    if (p!=NULL) {
-      p->child[0] = t;
-      p->attr.op = token;
+NodeId exp(CompileCtx * ctx)
+{ NodeId t = simple_exp(ctx);
+  if ((ctx->token==LT)||(ctx->token==EQ)) {
+    NodeId p = newExpNode(ctx,OpK);
+    NodeId c;
+    if (p!=NIL_NODE) {
+      NODE(ctx,p)->child[0] = t;
+      NODE(ctx,p)->attr.op = ctx->token;
       t = p;
     }
-    match(token);
-    if (t!=NULL)
-      t->child[1] = simple_exp();
+    match(ctx,ctx->token);
+    c = simple_exp(ctx);
+    if (t!=NIL_NODE)
+      NODE(ctx,t)->child[1] = c;
   }
   return t;
 }
 
-TreeNode * simple_exp(void)
-{ TreeNode * t = term();
-  while ((token==PLUS)||(token==MINUS))
-  { TreeNode * p = newExpNode(OpK);
-    if (p!=NULL) {
-      p->child[0] = t;
-      p->attr.op = token;
+NodeId simple_exp(CompileCtx * ctx)
+{ NodeId t = term(ctx);
+  while ((ctx->token==PLUS)||(ctx->token==MINUS))
+  { NodeId p = newExpNode(ctx,OpK);
+    if (p!=NIL_NODE) {
+      NodeId c;
+      NODE(ctx,p)->child[0] = t;
+      NODE(ctx,p)->attr.op = ctx->token;
       t = p;
-      match(token);
-      t->child[1] = term();
+      match(ctx,ctx->token);
+      c = term(ctx);
+      NODE(ctx,t)->child[1] = c;
     }
   }
   return t;
 }
 
-TreeNode * term(void)
-{ TreeNode * t = factor();
-  while ((token==TIMES)||(token==OVER))
-  { TreeNode * p = newExpNode(OpK);
-    if (p!=NULL) {
-      p->child[0] = t;
-      p->attr.op = token;
+NodeId term(CompileCtx * ctx)
+{ NodeId t = factor(ctx);
+  while ((ctx->token==TIMES)||(ctx->token==OVER))
+  { NodeId p = newExpNode(ctx,OpK);
+    if (p!=NIL_NODE) {
+      NodeId c;
+      NODE(ctx,p)->child[0] = t;
+      NODE(ctx,p)->attr.op = ctx->token;
       t = p;
-      match(token);
-      p->child[1] = factor();
+      match(ctx,ctx->token);
+      c = factor(ctx);
+      NODE(ctx,p)->child[1] = c;
     }
   }
   return t;
 }
 
-TreeNode * factor(void)
-{ TreeNode * t = NULL;
-  switch (token) {
+NodeId factor(CompileCtx * ctx)
+{ NodeId t = NIL_NODE;
+  switch (ctx->token) {
     case NUM :
-      t = newExpNode(ConstK);
-      if ((t!=NULL) && (token==NUM))
-        t->attr.val = atoi(tokenString);
-      match(NUM);
+      t = newExpNode(ctx,ConstK);
+      if ((t!=NIL_NODE) && (ctx->token==NUM))
+        NODE(ctx,t)->attr.val = atoi(ctx->tokenString);
+      match(ctx,NUM);
       break;
     case ID :
-      t = newExpNode(IdK);
-      if ((t!=NULL) && (token==ID))
-        t->attr.name = copyString(tokenString);
-      match(ID);
+      t = newExpNode(ctx,IdK);
+      if ((t!=NIL_NODE) && (ctx->token==ID))
+        NODE(ctx,t)->attr.sym = ctx->tokenSym;
+      match(ctx,ID);
       break;
     case LPAREN :
-      match(LPAREN);
-      t = exp();
-      match(RPAREN);
+      match(ctx,LPAREN);
+      t = exp(ctx);
+      match(ctx,RPAREN);
       break;
     default:
-      syntaxError("unexpected token -> ");
-      printToken(token,tokenString);
-      token = getToken();
+      syntaxError(ctx,"unexpected token -> ");
+      printToken(ctx,ctx->token,ctx->tokenString);
+      ctx->token = nextToken(ctx);
       break;
     }
   return t;
 }
 
+/* Function parseNext returns the next top-level
+ * statement of the program, or NIL_NODE at the
+ * end; it accepts the same language and reports
+ * the same errors as parse
+ */
+NodeId parseNext(CompileCtx * ctx)
+{ NodeId t = NIL_NODE;
+  while ((t == NIL_NODE) && !ctx->parseDone)
+  { if (ctx->topStmts == 0)
+      ctx->token = nextToken(ctx);
+    else if ((ctx->token!=ENDFILE) && (ctx->token!=END) &&
+             (ctx->token!=ELSE) && (ctx->token!=UNTIL))
+      match(ctx,SEMI);
+    else
+    { if (ctx->token!=ENDFILE)
+        syntaxError(ctx,"Code ends before file\n");
+      ctx->parseDone = TRUE;
+      break;
+    }
+    ctx->topStmts++;
+    t = statement(ctx);
+  }
+  return t;
+}
+
 /****************************************/
 /* the primary function of the parser   */
 /****************************************/
 /* Function parse returns the newly 
  * constructed syntax tree
  */
-TreeNode * parse(void)
-{ TreeNode * t;
-  token = getToken();
-  t = stmt_sequence();
-  if (token!=ENDFILE)
-    syntaxError("Code ends before file\n");
+NodeId parse(CompileCtx * ctx)
+{ NodeId t;
+  /* what the scanner traces must stay in step
+     with what the parser lists */
+  if (ctx->pipelined && !EchoSource && !TraceScan)
+    pipeStart(ctx);
+  ctx->token = nextToken(ctx);
+  t = stmt_sequence(ctx);
+  if (ctx->token!=ENDFILE)
+    syntaxError(ctx,"Code ends before file\n");
+  pipeFinish(ctx);
   return t;
 }
@@ -11,6 +11,13 @@
 /* Function parse returns the newly 
  * constructed syntax tree
  */
-TreeNode * parse(void);
+NodeId parse(CompileCtx * ctx);
+
+/* Function parseNext returns the next top-level
+ * statement of the program, or NIL_NODE at the
+ * end; it accepts the same language and reports
+ * the same errors as parse
+ */
+NodeId parseNext(CompileCtx * ctx);
 
 #endif
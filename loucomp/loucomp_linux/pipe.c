@@ -0,0 +1,191 @@
+/****************************************************/
+/* File: pipe.c                                     */
+/* Pipelined scanning implementation                */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "globals.h"
+#include "scan.h"
+#include "pipe.h"
+#include "stats.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+/* RINGSIZE is the number of tokens the scanner
+ * may run ahead of the parser; a power of two
+ */
+#define RINGSIZE 4096
+
+/* SPINS is how many times a thread that has to
+ * wait for the other looks again before it
+ * gives up its core for a while
+ */
+#define SPINS 256
+
+/* a token as the parser needs it: its kind and
+ * line, the symbol id of an identifier, and its
+ * lexeme (see tokenLexeme)
+ */
+typedef struct
+   { int kind; /* TokenType */
+     int line;
+     int sym;
+     char * text;
+   } Token;
+
+/* The ring has one writer, the scanner thread,
+ * and one reader, the parser: head counts the
+ * tokens put in and is written by the scanner
+ * only, tail counts those taken out and is
+ * written by the parser only, so no lock is
+ * needed. Each side keeps a copy of the other's
+ * counter and reads it again only when the ring
+ * looks full (room) or empty (seen). The
+ * scanner works on a context of its own, scan,
+ * which shares the source and the symbol table
+ * of the compilation but is not touched by the
+ * parser until the scanner thread has ended
+ */
+typedef struct PipeRec
+   { Token ring[RINGSIZE];
+     /* written by the scanner */
+     unsigned long head;
+     unsigned long room;
+     char pad1[64];
+     /* written by the parser */
+     unsigned long tail;
+     unsigned long seen;
+     int stop; /* TRUE once the parser wants no more */
+     int ended; /* TRUE once ENDFILE has been taken */
+     char pad2[64];
+     pthread_t thread;
+     CompileCtx scan;
+   } PipeRec;
+
+/* backOff is called each time a thread finds it
+   has to wait for the other */
+static void backOff( int * spins )
+{ if (++*spins >= SPINS)
+  { *spins = 0;
+    sched_yield();
+  }
+}
+
+/* put passes token t to the parser, waiting for
+   room in the ring; FALSE if the parser stopped */
+static int put( PipeRec * p, Token * t )
+{ unsigned long head = p->head;
+  int spins = 0;
+  while (head - p->room == RINGSIZE)
+  { p->room = __atomic_load_n(&p->tail,__ATOMIC_ACQUIRE);
+    if (head - p->room < RINGSIZE) break;
+    if (__atomic_load_n(&p->stop,__ATOMIC_ACQUIRE)) return FALSE;
+    backOff(&spins);
+  }
+  p->ring[head & (RINGSIZE-1)] = *t;
+  __atomic_store_n(&p->head,head+1,__ATOMIC_RELEASE);
+  return TRUE;
+}
+
+/* scanner is run by the scanner thread: it scans
+   the whole source into the ring */
+static void * scanner( void * arg )
+{ PipeRec * p = (PipeRec *) arg;
+  CompileCtx * sc = &p->scan;
+  Token t;
+  do
+  { t.kind = getToken(sc);
+    t.line = sc->lineno;
+    t.sym = sc->tokenSym;
+    t.text = tokenLexeme(sc,t.kind);
+  } while (put(p,&t) && (t.kind != ENDFILE));
+  return arg;
+}
+
+/* Function pipeStart starts the thread that scans
+ * the source of ctx; from then on the parser takes
+ * its tokens from pipeToken instead of getToken.
+ * FALSE if no thread was started: there is only
+ * one processor, or no thread could be made
+ */
+int pipeStart( CompileCtx * ctx )
+{ PipeRec * p;
+  /* on a single processor the two threads would
+     only take turns */
+  if (sysconf(_SC_NPROCESSORS_ONLN) < 2) return FALSE;
+  p = (PipeRec *) malloc(sizeof(PipeRec));
+  if (p == NULL) return FALSE;
+  countAlloc(ctx,sizeof(PipeRec));
+  p->head = p->room = 0;
+  p->tail = p->seen = 0;
+  p->stop = p->ended = FALSE;
+  /* the scanner's allocations are added in
+     by pipeFinish */
+  p->scan = *ctx;
+  p->scan.nallocs = 0;
+  p->scan.allocBytes = 0;
+  if (pthread_create(&p->thread,NULL,scanner,p) != 0)
+  { free(p);
+    return FALSE;
+  }
+  ctx->pipe = p;
+  return TRUE;
+}
+
+/* Function pipeToken returns the next token from
+ * the scanner thread, setting ctx->tokenString,
+ * ctx->tokenSym and ctx->lineno as getToken does
+ */
+TokenType pipeToken( CompileCtx * ctx )
+{ PipeRec * p = ctx->pipe;
+  Token * t;
+  TokenType kind;
+  int spins = 0;
+  ctx->ntokens++;
+  if (p->ended)
+  { /* getToken keeps returning ENDFILE, each
+       time a line further on */
+    ctx->lineno++;
+    ctx->tokenString[0] = '\0';
+    return ENDFILE;
+  }
+  while (p->tail == p->seen)
+  { p->seen = __atomic_load_n(&p->head,__ATOMIC_ACQUIRE);
+    if (p->tail == p->seen) backOff(&spins);
+  }
+  /* everything is taken out of the slot before
+     it is handed back to the scanner */
+  t = &p->ring[p->tail & (RINGSIZE-1)];
+  kind = (TokenType) t->kind;
+  ctx->lineno = t->line;
+  if (t->text == NULL) ctx->tokenString[0] = '\0';
+  else strcpy(ctx->tokenString,t->text);
+  ctx->tokenSym = t->sym;
+  if (kind == ENDFILE) p->ended = TRUE;
+  __atomic_store_n(&p->tail,p->tail+1,__ATOMIC_RELEASE);
+  return kind;
+}
+
+/* Procedure pipeFinish stops the scanner thread
+ * of ctx, if there is one, and takes back the
+ * symbols and strings it made
+ */
+void pipeFinish( CompileCtx * ctx )
+{ PipeRec * p = ctx->pipe;
+  CompileCtx * sc;
+  if (p == NULL) return;
+  __atomic_store_n(&p->stop,TRUE,__ATOMIC_RELEASE);
+  pthread_join(p->thread,NULL);
+  sc = &p->scan;
+  ctx->symbols = sc->symbols;
+  ctx->nsymbols = sc->nsymbols;
+  ctx->maxsymbols = sc->maxsymbols;
+  ctx->hashTable = sc->hashTable;
+  ctx->tableSize = sc->tableSize;
+  ctx->strBlocks = sc->strBlocks;
+  ctx->nallocs += sc->nallocs;
+  ctx->allocBytes += sc->allocBytes;
+  free(p);
+  ctx->pipe = NULL;
+}
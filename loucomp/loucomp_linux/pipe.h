@@ -0,0 +1,33 @@
+/****************************************************/
+/* File: pipe.h                                     */
+/* Pipelined scanning for the TINY compiler         */
+/* With -pipe, a thread of its own scans the source */
+/* ahead of the parser and passes the tokens to it  */
+/* through a lock-free ring, so that the scanner    */
+/* and the parser of a large program run at once    */
+/****************************************************/
+
+#ifndef _PIPE_H_
+#define _PIPE_H_
+
+/* Function pipeStart starts the thread that scans
+ * the source of ctx; from then on the parser takes
+ * its tokens from pipeToken instead of getToken.
+ * FALSE if no thread was started: there is only
+ * one processor, or no thread could be made
+ */
+int pipeStart( CompileCtx * ctx );
+
+/* Function pipeToken returns the next token from
+ * the scanner thread, setting ctx->tokenString,
+ * ctx->tokenSym and ctx->lineno as getToken does
+ */
+TokenType pipeToken( CompileCtx * ctx );
+
+/* Procedure pipeFinish stops the scanner thread
+ * of ctx, if there is one, and takes back the
+ * symbols and strings it made
+ */
+void pipeFinish( CompileCtx * ctx );
+
+#endif
@@ -0,0 +1,237 @@
+/****************************************************/
+/* File: rewrite.c                                  */
+/* Rewrite rules for TM instruction sequences       */
+/* (see rewrite.h)                                  */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "tmeng.h"
+#include "rewrite.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* the registers of the TINY code */
+#define AC  0
+#define AC1 1
+
+/* field returns operand k of instruction i */
+static int * field( INSTRUCTION * i, int k )
+{ switch (k)
+  { case 0: return &i->iarg1;
+    case 1: return &i->iarg2;
+    default: return &i->iarg3;
+  }
+}
+
+/* Function ruleMatch matches the left side of
+ * rule r with the r->nlhs instructions at code,
+ * setting the parameters that it binds in param;
+ * FALSE if they do not match
+ */
+int ruleMatch( TMRULE * r, INSTRUCTION * code, int param[] )
+{ int bound[NPARAMS];
+  int i, k, v;
+  for (k = 0; k < NPARAMS; k++) bound[k] = FALSE;
+  for (i = 0; i < r->nlhs; i++)
+  { RULEINSTR * ri = &r->lhs[i];
+    if (code[i].iop != ri->op) return FALSE;
+    for (k = 0; k < 3; k++)
+    { RULEARG * a = &ri->arg[k];
+      v = *field(&code[i],k);
+      if (a->kind == 'c')
+      { if (v != a->val) return FALSE;
+        continue;
+      }
+      if (a->kind == 'n')
+      { if (v == INT_MIN) return FALSE;
+        v = -v;
+      }
+      if (bound[a->val])
+      { if (param[a->val] != v) return FALSE;
+      }
+      else
+      { /* the rules were found for R one of the
+           registers that only tiny -O uses */
+        if ((a->val == P_R) && ((v < 2) || (v > 4))) return FALSE;
+        param[a->val] = v;
+        bound[a->val] = TRUE;
+      }
+    }
+  }
+  return TRUE;
+} /* ruleMatch */
+
+/* Function ruleApply writes the right side of
+ * rule r, with the parameters in param, to the
+ * r->nrhs instructions at code; FALSE if an
+ * operand cannot be negated
+ */
+int ruleApply( TMRULE * r, int param[], INSTRUCTION * code )
+{ int i, k, v;
+  for (i = 0; i < r->nrhs; i++)
+  { RULEINSTR * ri = &r->rhs[i];
+    code[i].iop = ri->op;
+    for (k = 0; k < 3; k++)
+    { RULEARG * a = &ri->arg[k];
+      if (a->kind == 'c') v = a->val;
+      else
+      { v = param[a->val];
+        if (a->kind == 'n')
+        { if (v == INT_MIN) return FALSE;
+          v = -v;
+        }
+      }
+      *field(&code[i],k) = v;
+    }
+  }
+  return TRUE;
+} /* ruleApply */
+
+/* regBit is the bit of register r in a set of
+   registers; the pc is never in one */
+#define regBit(r) (((r) == PC_REG) ? 0 : (1 << (r)))
+
+/* uses and defs set *use to the registers that
+   instruction i reads and *def to those it
+   writes, other than the pc */
+static void usesDefs( INSTRUCTION * i, int * use, int * def )
+{ int r = i->iarg1, s = i->iarg2, t = i->iarg3;
+  *use = *def = 0;
+  switch (i->iop)
+  { case opHALT: break;
+    case opIN: *def = regBit(r); break;
+    case opOUT: *use = regBit(r); break;
+    case opADD: case opSUB: case opMUL: case opDIV:
+      *use = regBit(s) | regBit(t);
+      *def = regBit(r);
+      break;
+    case opLD:
+      *use = regBit(t);
+      *def = regBit(r);
+      break;
+    case opST: *use = regBit(r) | regBit(t); break;
+    case opLDA:
+      *use = regBit(t);
+      *def = regBit(r);
+      break;
+    case opLDC: *def = regBit(r); break;
+    default: /* the conditional jumps */
+      *use = regBit(r) | regBit(t);
+      break;
+  }
+}
+
+/* Function jumpTarget returns the location that
+ * the instruction at loc may jump to: -1 if it
+ * does not jump, -2 if the location is computed
+ */
+static int jumpTarget( INSTRUCTION * i, int loc )
+{ int op = i->iop;
+  if ((op >= opJLT) && (op <= opJNE))
+    return (i->iarg3 == PC_REG) ? loc+1+i->iarg2 : -2;
+  if (i->iarg1 != PC_REG) return -1;
+  switch (op)
+  { case opHALT: case opOUT: case opST: return -1;
+    case opLDA:
+      return (i->iarg3 == PC_REG) ? loc+1+i->iarg2 : -2;
+    case opLDC: return i->iarg2;
+    default: return -2;
+  }
+}
+
+/* Function fallsThrough is FALSE if the next
+ * location never runs after the instruction at
+ * loc
+ */
+static int fallsThrough( INSTRUCTION * i )
+{ if (i->iop == opHALT) return FALSE;
+  /* LDA pc,d(pc) and LDC pc,d always jump */
+  return !(((i->iop == opLDA) || (i->iop == opLDC))
+           && (i->iarg1 == PC_REG));
+}
+
+/* Function tmRewrite applies the rules to the
+ * program loaded into tm where the program's
+ * jumps and the liveness of its registers allow,
+ * and returns how many sequences it rewrote. The
+ * addresses of the code do not change: the right
+ * side is followed by a jump over what remains of
+ * the left side, so a sequence is rewritten only
+ * if that takes fewer steps. No rule that needs a
+ * temporary to be dead is used, and nothing is
+ * rewritten in a program that computes a jump
+ */
+int tmRewrite( TM * tm )
+{ INSTRUCTION * code = tm->iMem;
+  int size = tm->isize;
+  int * liveOut = (int *) calloc(size,sizeof(int));
+  char * target = (char *) calloc(size,1);
+  int param[NPARAMS];
+  int loc, to, i, n = 0, changed;
+  if ((liveOut == NULL) || (target == NULL))
+  { free(liveOut);
+    free(target);
+    return 0;
+  }
+  for (loc = 0; loc < size; loc++)
+  { to = jumpTarget(&code[loc],loc);
+    if (to == -2) goto done;
+    if ((to >= 0) && (to < size)) target[to] = TRUE;
+  }
+  /* the registers live after each location, by
+     going backward over the code until nothing
+     changes */
+  do
+  { changed = FALSE;
+    for (loc = size-1; loc >= 0; loc--)
+    { int out = 0, use, def;
+      if (fallsThrough(&code[loc]) && (loc+1 < size))
+      { usesDefs(&code[loc+1],&use,&def);
+        out |= use | (liveOut[loc+1] & ~def);
+      }
+      to = jumpTarget(&code[loc],loc);
+      if ((to >= 0) && (to < size))
+      { usesDefs(&code[to],&use,&def);
+        out |= use | (liveOut[to] & ~def);
+      }
+      if (out != liveOut[loc])
+      { liveOut[loc] = out;
+        changed = TRUE;
+      }
+    }
+  } while (changed);
+  for (loc = 0; loc < size; loc++)
+    for (i = 0; i < tmNRules; i++)
+    { TMRULE * r = &tmRules[i];
+      INSTRUCTION rhs[RULEMAX];
+      int last = loc+r->nlhs-1, k, inside = FALSE;
+      /* the jump over the rest must save a step */
+      if ((r->nlhs-r->nrhs < 2) || (r->dead & DEAD_TMP)) continue;
+      if (last >= size) continue;
+      if ((r->dead & DEAD_AC1) && (liveOut[last] & regBit(AC1))) continue;
+      for (k = loc+1; k <= last; k++)
+        if (target[k]) inside = TRUE;
+      if (inside || !ruleMatch(r,&code[loc],param)) continue;
+      if (!ruleApply(r,param,rhs)) continue;
+      for (k = 0; k < r->nrhs; k++) code[loc+k] = rhs[k];
+      code[loc+k].iop = opLDA;
+      code[loc+k].iarg1 = PC_REG;
+      code[loc+k].iarg2 = last-(loc+k);
+      code[loc+k].iarg3 = PC_REG;
+      n++;
+      loc = last;
+      break;
+    }
+done:
+  free(liveOut);
+  free(target);
+  return n;
+} /* tmRewrite */
@@ -0,0 +1,100 @@
+/****************************************************/
+/* File: rewrite.h                                  */
+/* Rewrite rules for TM instruction sequences       */
+/* Each rule replaces a short straight-line TM      */
+/* sequence by a shorter one that leaves the same   */
+/* machine state. The rules in use are in tmrules.c,*/
+/* made by the superoptimizer superopt.c; tiny -O   */
+/* applies them as it emits code, and tm -O as it   */
+/* loads a program                                  */
+/****************************************************/
+
+#ifndef _REWRITE_H_
+#define _REWRITE_H_
+
+/* RULEMAX is the most instructions on either side
+ * of a rule
+ */
+#define RULEMAX 4
+
+/* the parameters of a rule: the numbers an
+ * instance of its left side is matched with
+ */
+#define P_K 0 /* a constant */
+#define P_T 1 /* the offset of a temporary from mp */
+#define P_X 2 /* the offset of a variable from gp */
+#define P_R 3 /* a register other than ac and ac1 */
+#define NPARAMS 4
+
+/* what a rule needs to be dead after the left side:
+ * its result is not the same there
+ */
+#define DEAD_AC1 1 /* register ac1 */
+#define DEAD_TMP 2 /* the temporary at P_T(mp) */
+
+/* an operand of an instruction of a rule: the
+ * number val itself (kind 'c'), the value of
+ * parameter val (kind 'p'), or its negation
+ * (kind 'n')
+ */
+typedef struct
+   { char kind;
+     int val;
+   } RULEARG;
+
+/* an instruction of a rule; the operands are in
+ * the order of INSTRUCTION: r,s,t or r,d,s
+ */
+typedef struct
+   { int op;
+     RULEARG arg[3];
+   } RULEINSTR;
+
+/* a rule: lhs may be replaced by rhs wherever
+ * what dead names is dead after it. A rule
+ * assumes, as the code of tiny does, that the
+ * variables at gp and the temporaries at mp do
+ * not overlap
+ */
+typedef struct
+   { int nlhs;
+     RULEINSTR lhs[RULEMAX];
+     int nrhs;
+     RULEINSTR rhs[RULEMAX];
+     int dead;
+   } TMRULE;
+
+/* the rules, shortest right side first for each
+ * left side (see tmrules.c)
+ */
+extern TMRULE tmRules[];
+extern int tmNRules;
+
+/* Function ruleMatch matches the left side of
+ * rule r with the r->nlhs instructions at code,
+ * setting the parameters that it binds in param;
+ * FALSE if they do not match
+ */
+int ruleMatch( TMRULE * r, INSTRUCTION * code, int param[] );
+
+/* Function ruleApply writes the right side of
+ * rule r, with the parameters in param, to the
+ * r->nrhs instructions at code; FALSE if an
+ * operand cannot be negated
+ */
+int ruleApply( TMRULE * r, int param[], INSTRUCTION * code );
+
+/* Function tmRewrite applies the rules to the
+ * program loaded into tm where the program's
+ * jumps and the liveness of its registers allow,
+ * and returns how many sequences it rewrote. The
+ * addresses of the code do not change: the right
+ * side is followed by a jump over what remains of
+ * the left side, so a sequence is rewritten only
+ * if that takes fewer steps. No rule that needs a
+ * temporary to be dead is used, and nothing is
+ * rewritten in a program that computes a jump
+ */
+int tmRewrite( TM * tm );
+
+#endif
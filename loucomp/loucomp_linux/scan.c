@@ -8,48 +8,40 @@
 #include "globals.h"
 #include "util.h"
 #include "scan.h"
+#include "symtab.h"
 
 /* states in scanner DFA */
 typedef enum
    { START,INASSIGN,INCOMMENT,INNUM,INID,DONE }
    StateType;
 
-/* lexeme of identifier or reserved word */
-char tokenString[MAXTOKENLEN+1];
-
-/* BUFLEN = length of the input buffer for
-   source code lines */
-#define BUFLEN 256
-
-static char lineBuf[BUFLEN]; /* holds the current line */
-static int linepos = 0; /* current position in LineBuf */
-static int bufsize = 0; /* current size of buffer string */
-static int EOF_flag = FALSE; /* corrects ungetNextChar behavior on EOF */
+/* the lexeme, the line buffer and the position
+   in it are kept in the context (see globals.h) */
 
 /* getNextChar fetches the next non-blank character
    from lineBuf, reading in a new line if lineBuf is
    exhausted */
-static int getNextChar(void)
-{ if (!(linepos < bufsize))
-  { lineno++;
-    if (fgets(lineBuf,BUFLEN-1,source))
-    { if (EchoSource) fprintf(listing,"%4d: %s",lineno,lineBuf);
-      bufsize = strlen(lineBuf);
-      linepos = 0;
-      return lineBuf[linepos++];
+static int getNextChar(CompileCtx * ctx)
+{ if (!(ctx->linepos < ctx->bufsize))
+  { ctx->lineno++;
+    if (fgets(ctx->lineBuf,BUFLEN-1,ctx->source))
+    { if (EchoSource) fprintf(ctx->listing,"%4d: %s",ctx->lineno,ctx->lineBuf);
+      ctx->bufsize = strlen(ctx->lineBuf);
+      ctx->linepos = 0;
+      return ctx->lineBuf[ctx->linepos++];
     }
     else
-    { EOF_flag = TRUE;
+    { ctx->EOF_flag = TRUE;
       return EOF;
     }
   }
-  else return lineBuf[linepos++];
+  else return ctx->lineBuf[ctx->linepos++];
 }
 
 /* ungetNextChar backtracks one character
    in lineBuf */
-static void ungetNextChar(void)
-{ if (!EOF_flag) linepos-- ;}
+static void ungetNextChar(CompileCtx * ctx)
+{ if (!ctx->EOF_flag) ctx->linepos-- ;}
 
 /* lookup table of reserved words */
 static struct
@@ -76,7 +68,7 @@ static TokenType reservedLookup (char * s)
 /* function getToken returns the 
  * next token in source file
  */
-TokenType getToken(void)
+TokenType getToken(CompileCtx * ctx)
 {  /* index for storing into tokenString */
    int tokenStringIndex = 0;
    /* holds current token to be returned */
@@ -86,7 +78,7 @@ TokenType getToken(void)
    /* flag to indicate save to tokenString */
    int save;
    while (state != DONE)
-   { int c = getNextChar();
+   { int c = getNextChar(ctx);
      save = TRUE;
      switch (state)
      { case START:
@@ -156,7 +148,7 @@ TokenType getToken(void)
            currentToken = ASSIGN;
          else
          { /* backup in the input */
-           ungetNextChar();
+           ungetNextChar(ctx);
            save = FALSE;
            currentToken = ERROR;
          }
@@ -164,7 +156,7 @@ TokenType getToken(void)
        case INNUM:
          if (!isdigit(c))
          { /* backup in the input */
-           ungetNextChar();
+           ungetNextChar(ctx);
            save = FALSE;
            state = DONE;
            currentToken = NUM;
@@ -173,7 +165,7 @@ TokenType getToken(void)
        case INID:
          if (!isalpha(c))
          { /* backup in the input */
-           ungetNextChar();
+           ungetNextChar(ctx);
            save = FALSE;
            state = DONE;
            currentToken = ID;
@@ -181,23 +173,49 @@ TokenType getToken(void)
          break;
        case DONE:
        default: /* should never happen */
-         fprintf(listing,"Scanner Bug: state= %d\n",state);
+         fprintf(ctx->listing,"Scanner Bug: state= %d\n",state);
          state = DONE;
          currentToken = ERROR;
          break;
      }
      if ((save) && (tokenStringIndex <= MAXTOKENLEN))
-       tokenString[tokenStringIndex++] = (char) c;
+       ctx->tokenString[tokenStringIndex++] = (char) c;
      if (state == DONE)
-     { tokenString[tokenStringIndex] = '\0';
+     { ctx->tokenString[tokenStringIndex] = '\0';
        if (currentToken == ID)
-         currentToken = reservedLookup(tokenString);
+       { currentToken = reservedLookup(ctx->tokenString);
+         if (currentToken == ID)
+           ctx->tokenSym = st_intern(ctx,ctx->tokenString);
+       }
      }
    }
    if (TraceScan) {
-     fprintf(listing,"\t%d: ",lineno);
-     printToken(currentToken,tokenString);
+     fprintf(ctx->listing,"\t%d: ",ctx->lineno);
+     printToken(ctx,currentToken,ctx->tokenString);
    }
+   ctx->ntokens++;
    return currentToken;
 } /* end getToken */
 
+/* Function tokenLexeme returns the lexeme of the
+ * token getToken just returned, in storage that
+ * does not change as more tokens are scanned: the
+ * name of an identifier, the reserved word, or a
+ * copy in the string arena for a number or an
+ * error; NULL if the token implies its lexeme
+ */
+char * tokenLexeme(CompileCtx * ctx, TokenType token)
+{ int i;
+  switch (token)
+  { case ID:
+      return st_name(ctx,ctx->tokenSym);
+    case NUM:
+    case ERROR:
+      return copyString(ctx,ctx->tokenString);
+    default:
+      for (i=0;i<MAXRESERVED;i++)
+        if (reservedWords[i].tok == token)
+          return reservedWords[i].str;
+      return NULL;
+  }
+}
@@ -8,15 +8,23 @@
 #ifndef _SCAN_H_
 #define _SCAN_H_
 
-/* MAXTOKENLEN is the maximum size of a token */
-#define MAXTOKENLEN 40
-
-/* tokenString array stores the lexeme of each token */
-extern char tokenString[MAXTOKENLEN+1];
+/* ctx->tokenString stores the lexeme of each token,
+ * and ctx->tokenSym the interned symbol id of the
+ * last ID token (MAXTOKENLEN is in globals.h)
+ */
 
 /* function getToken returns the 
  * next token in source file
  */
-TokenType getToken(void);
+TokenType getToken(CompileCtx * ctx);
+
+/* Function tokenLexeme returns the lexeme of the
+ * token getToken just returned, in storage that
+ * does not change as more tokens are scanned: the
+ * name of an identifier, the reserved word, or a
+ * copy in the string arena for a number or an
+ * error; NULL if the token implies its lexeme
+ */
+char * tokenLexeme(CompileCtx * ctx, TokenType token);
 
 #endif
@@ -0,0 +1,503 @@
+/****************************************************/
+/* File: sccp.c                                     */
+/* Conditional constant propagation implementation  */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "sccp.h"
+#include "arena.h"
+#include "stats.h"
+#include <limits.h>
+
+/* The program is run on abstract values: a
+   variable or an expression is either one known
+   constant or unknown (BOTTOM). Every variable
+   starts out as the constant 0, as in TM memory.
+   Only the parts that can run are run: an if
+   whose test is a constant runs one part only,
+   and the states at the end of its parts are
+   merged; a repeat is run until the state at its
+   top no longer changes, that state being the
+   merge of the state before the loop with the
+   states its test sends back. Since a variable
+   can only go from a constant to BOTTOM, this
+   stops after a few rounds.
+
+   Each expression node keeps the merge of the
+   values it had each time it ran, and each
+   statement whether it ran, which parts of an if
+   ran and whether a repeat went round more than
+   once. Afterwards the expressions that were the
+   same constant every time become that constant,
+   parts that never ran are removed, and a repeat
+   that never went round is replaced by its body.
+
+   The arithmetic is that of the TM: it wraps, and
+   a < b is the sign of a - b. A division by 0 (or
+   the overflowing INT_MIN / -1) is never folded,
+   so that it still faults when it runs; since an
+   operation is only folded when both operands
+   are constants, a constant never hides one. */
+
+/* the abstract values */
+#define LAT_TOP 0 /* not run yet */
+#define LAT_CONST 1
+#define LAT_BOTTOM 2
+
+typedef struct
+   { int kind;
+     int val;
+   } Lat;
+
+/* what is noted of a statement */
+#define RAN 1
+#define THEN_RAN 2
+#define ELSE_RAN 4
+#define LOOPED 8
+
+struct PropRec
+   { Lat * fact; /* per expression node */
+     char * flags; /* per statement node */
+     int nfacts; /* number of entries in fact and flags */
+     Lat * vars; /* the state between statements (-stream) */
+     int nvars; /* number of entries in vars */
+     int dead; /* TRUE once no statement can run any more */
+   };
+
+static Lat meet( Lat a, Lat b )
+{ Lat bottom;
+  if (a.kind == LAT_TOP) return b;
+  if (b.kind == LAT_TOP) return a;
+  if ((a.kind == LAT_CONST) && (b.kind == LAT_CONST) && (a.val == b.val))
+    return a;
+  bottom.kind = LAT_BOTTOM;
+  bottom.val = 0;
+  return bottom;
+}
+
+/* Function meetInto merges state e into state into,
+ * returning TRUE if into changed
+ */
+static int meetInto( CompileCtx * ctx, Lat * into, Lat * e )
+{ int i, changed = FALSE;
+  for (i=0;i<ctx->location;i++)
+  { Lat m = meet(into[i],e[i]);
+    if ((m.kind != into[i].kind) || (m.val != into[i].val))
+    { into[i] = m;
+      changed = TRUE;
+    }
+  }
+  return changed;
+}
+
+static Lat * copyState( CompileCtx * ctx, Lat * e )
+{ int n = (ctx->location > 0) ? ctx->location : 1;
+  Lat * c = (Lat *) malloc(n*sizeof(Lat));
+  countAlloc(ctx,n*sizeof(Lat));
+  memcpy(c,e,ctx->location*sizeof(Lat));
+  return c;
+}
+
+/* Function fold applies operator op to the
+ * constants a and b; FALSE if it must not be
+ * folded
+ */
+static int fold( TokenType op, int a, int b, int * val )
+{ switch (op) {
+    case PLUS :  *val = (int) ((unsigned) a + (unsigned) b); break;
+    case MINUS : *val = (int) ((unsigned) a - (unsigned) b); break;
+    case TIMES : *val = (int) ((unsigned) a * (unsigned) b); break;
+    case OVER :
+      if ((b == 0) || ((a == INT_MIN) && (b == -1))) return FALSE;
+      *val = a / b;
+      break;
+    case LT :    *val = ((int) ((unsigned) a - (unsigned) b) < 0); break;
+    case EQ :    *val = (a == b); break;
+    default :    return FALSE;
+  }
+  return TRUE;
+}
+
+/* Function eval returns the value of expression n
+ * in state env, noting it for n
+ */
+static Lat eval( CompileCtx * ctx, NodeId n, Lat * env )
+{ struct PropRec * r = ctx->prop;
+  TreeNode * t;
+  Lat v, a, b;
+  v.kind = LAT_BOTTOM;
+  v.val = 0;
+  if (n == NIL_NODE) return v;
+  t = NODE(ctx,n);
+  switch (t->kind.exp) {
+    case ConstK :
+      v.kind = LAT_CONST;
+      v.val = t->attr.val;
+      break;
+    case IdK :
+      v = env[st_lookup(ctx,t->attr.sym)];
+      break;
+    case OpK :
+      a = eval(ctx,t->child[0],env);
+      b = eval(ctx,t->child[1],env);
+      if ((a.kind == LAT_CONST) && (b.kind == LAT_CONST)
+          && fold(t->attr.op,a.val,b.val,&v.val))
+        v.kind = LAT_CONST;
+      break;
+    default :
+      break;
+  }
+  r->fact[n] = meet(r->fact[n],v);
+  return v;
+}
+
+static int runSeq( CompileCtx * ctx, NodeId n, Lat * env );
+
+/* Function runStmt runs statement n on state env,
+ * returning FALSE if its end cannot be reached
+ */
+static int runStmt( CompileCtx * ctx, NodeId n, Lat * env )
+{ struct PropRec * r = ctx->prop;
+  TreeNode * t = NODE(ctx,n);
+  Lat c;
+  r->flags[n] |= RAN;
+  switch (t->kind.stmt) {
+    case IfK :
+    { Lat * e1 = NULL, * e2 = NULL;
+      int live1 = FALSE, live2 = FALSE;
+      c = eval(ctx,t->child[0],env);
+      if ((c.kind != LAT_CONST) || (c.val != 0))
+      { r->flags[n] |= THEN_RAN;
+        e1 = copyState(ctx,env);
+        live1 = runSeq(ctx,NODE(ctx,n)->child[1],e1);
+      }
+      if ((c.kind != LAT_CONST) || (c.val == 0))
+      { r->flags[n] |= ELSE_RAN;
+        e2 = copyState(ctx,env);
+        live2 = runSeq(ctx,NODE(ctx,n)->child[2],e2);
+      }
+      if (live1) memcpy(env,e1,ctx->location*sizeof(Lat));
+      if (live2)
+      { if (live1) meetInto(ctx,env,e2);
+        else memcpy(env,e2,ctx->location*sizeof(Lat));
+      }
+      free(e1);
+      free(e2);
+      return live1 || live2;
+    }
+    case RepeatK :
+    { Lat * head = copyState(ctx,env);
+      Lat * out = copyState(ctx,env);
+      int exits = FALSE;
+      for (;;)
+      { memcpy(out,head,ctx->location*sizeof(Lat));
+        if (! runSeq(ctx,NODE(ctx,n)->child[0],out)) break;
+        c = eval(ctx,NODE(ctx,n)->child[1],out);
+        if ((c.kind != LAT_CONST) || (c.val != 0))
+        { if (exits) meetInto(ctx,env,out);
+          else memcpy(env,out,ctx->location*sizeof(Lat));
+          exits = TRUE;
+        }
+        if ((c.kind == LAT_CONST) && (c.val != 0)) break;
+        r->flags[n] |= LOOPED;
+        if (! meetInto(ctx,head,out)) break;
+      }
+      free(head);
+      free(out);
+      return exits;
+    }
+    case AssignK :
+      c = eval(ctx,t->child[0],env);
+      env[st_lookup(ctx,NODE(ctx,n)->attr.sym)] = c;
+      return TRUE;
+    case ReadK :
+      c.kind = LAT_BOTTOM;
+      c.val = 0;
+      env[st_lookup(ctx,t->attr.sym)] = c;
+      return TRUE;
+    case WriteK :
+      eval(ctx,t->child[0],env);
+      return TRUE;
+    default :
+      return TRUE;
+  }
+}
+
+/* Function runSeq runs statements n on state env,
+ * returning FALSE if their end cannot be reached
+ */
+static int runSeq( CompileCtx * ctx, NodeId n, Lat * env )
+{ while (n != NIL_NODE)
+  { if (! runStmt(ctx,n,env)) return FALSE;
+    n = NODE(ctx,n)->sibling;
+  }
+  return TRUE;
+}
+
+/* Procedure rewriteExp makes each part of
+ * expression n that was always the same constant
+ * into that constant
+ */
+static void rewriteExp( CompileCtx * ctx, NodeId n )
+{ TreeNode * t;
+  Lat v;
+  int i;
+  if (n == NIL_NODE) return;
+  t = NODE(ctx,n);
+  v = ctx->prop->fact[n];
+  if ((v.kind == LAT_CONST) && (t->kind.exp != ConstK))
+  { t->kind.exp = ConstK;
+    t->attr.val = v.val;
+    for (i=0;i<MAXCHILDREN;i++) t->child[i] = NIL_NODE;
+  }
+  else if (t->kind.exp == OpK)
+  { rewriteExp(ctx,t->child[0]);
+    rewriteExp(ctx,t->child[1]);
+  }
+}
+
+static NodeId rewriteSeq( CompileCtx * ctx, NodeId n );
+
+/* Function rewriteStmt returns what is left of
+ * statement n: nothing, n itself, or the
+ * statements of the one part of it that ran
+ */
+static NodeId rewriteStmt( CompileCtx * ctx, NodeId n )
+{ TreeNode * t = NODE(ctx,n);
+  int flags = ctx->prop->flags[n];
+  NodeId s;
+  if (! (flags & RAN)) return NIL_NODE;
+  switch (t->kind.stmt) {
+    case IfK :
+      if (! (flags & ELSE_RAN)) return rewriteSeq(ctx,t->child[1]);
+      if (! (flags & THEN_RAN)) return rewriteSeq(ctx,t->child[2]);
+      rewriteExp(ctx,t->child[0]);
+      s = rewriteSeq(ctx,t->child[1]);
+      NODE(ctx,n)->child[1] = s;
+      s = rewriteSeq(ctx,NODE(ctx,n)->child[2]);
+      NODE(ctx,n)->child[2] = s;
+      return n;
+    case RepeatK :
+      if (! (flags & LOOPED)) return rewriteSeq(ctx,t->child[0]);
+      s = rewriteSeq(ctx,t->child[0]);
+      NODE(ctx,n)->child[0] = s;
+      rewriteExp(ctx,NODE(ctx,n)->child[1]);
+      return n;
+    case AssignK :
+    case WriteK :
+      rewriteExp(ctx,t->child[0]);
+      return n;
+    default :
+      return n;
+  }
+}
+
+/* Function append links statements s after tail
+ * (the last of a sequence starting at *head) and
+ * returns the new last statement
+ */
+static NodeId append( CompileCtx * ctx, NodeId * head, NodeId tail, NodeId s )
+{ if (s == NIL_NODE) return tail;
+  if (tail == NIL_NODE) *head = s;
+  else NODE(ctx,tail)->sibling = s;
+  while (NODE(ctx,s)->sibling != NIL_NODE) s = NODE(ctx,s)->sibling;
+  return s;
+}
+
+/* Function rewriteSeq returns what is left of the
+ * statements n
+ */
+static NodeId rewriteSeq( CompileCtx * ctx, NodeId n )
+{ NodeId head = NIL_NODE, tail = NIL_NODE;
+  while (n != NIL_NODE)
+  { NodeId next = NODE(ctx,n)->sibling;
+    NODE(ctx,n)->sibling = NIL_NODE;
+    tail = append(ctx,&head,tail,rewriteStmt(ctx,n));
+    n = next;
+  }
+  return head;
+}
+
+/* Procedure countUses adds delta to uses[loc] for
+ * each use of a variable in expression n
+ */
+static void countUses( CompileCtx * ctx, NodeId n, int * uses, int delta )
+{ TreeNode * t;
+  if (n == NIL_NODE) return;
+  t = NODE(ctx,n);
+  if (t->kind.exp == IdK) uses[st_lookup(ctx,t->attr.sym)] += delta;
+  else if (t->kind.exp == OpK)
+  { countUses(ctx,t->child[0],uses,delta);
+    countUses(ctx,t->child[1],uses,delta);
+  }
+}
+
+/* Procedure countSeq counts the uses of variables
+ * in statements n
+ */
+static void countSeq( CompileCtx * ctx, NodeId n, int * uses )
+{ while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    int i;
+    for (i=0;i<MAXCHILDREN;i++)
+      if (t->child[i] != NIL_NODE)
+      { if (NODE(ctx,t->child[i])->nodekind == StmtK)
+          countSeq(ctx,t->child[i],uses);
+        else countUses(ctx,t->child[i],uses,1);
+      }
+    n = NODE(ctx,n)->sibling;
+  }
+}
+
+/* Function safe returns TRUE if expression n can
+ * not fault: each division in it is by a constant
+ * other than 0 and -1
+ */
+static int safe( CompileCtx * ctx, NodeId n )
+{ TreeNode * t;
+  if (n == NIL_NODE) return TRUE;
+  t = NODE(ctx,n);
+  if (t->kind.exp != OpK) return TRUE;
+  if (t->attr.op == OVER)
+  { TreeNode * d = NODE(ctx,t->child[1]);
+    if ((d->kind.exp != ConstK) || (d->attr.val == 0) || (d->attr.val == -1))
+      return FALSE;
+  }
+  return safe(ctx,t->child[0]) && safe(ctx,t->child[1]);
+}
+
+/* Function dropDead returns statements n without
+ * the assignments to variables that are never
+ * read, and the ifs left empty, as long as their
+ * expressions cannot fault; *changed is set if
+ * anything was dropped
+ */
+static NodeId dropDead( CompileCtx * ctx, NodeId n, int * uses, int * changed )
+{ NodeId head = NIL_NODE, tail = NIL_NODE;
+  while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    NodeId next = t->sibling;
+    NodeId s;
+    int drop = FALSE;
+    switch (t->kind.stmt) {
+      case IfK :
+        s = dropDead(ctx,t->child[1],uses,changed);
+        NODE(ctx,n)->child[1] = s;
+        s = dropDead(ctx,NODE(ctx,n)->child[2],uses,changed);
+        NODE(ctx,n)->child[2] = s;
+        t = NODE(ctx,n);
+        drop = (t->child[1] == NIL_NODE) && (t->child[2] == NIL_NODE)
+            && safe(ctx,t->child[0]);
+        break;
+      case RepeatK :
+        s = dropDead(ctx,t->child[0],uses,changed);
+        NODE(ctx,n)->child[0] = s;
+        break;
+      case AssignK :
+        drop = (uses[st_lookup(ctx,t->attr.sym)] == 0) && safe(ctx,t->child[0]);
+        break;
+      default :
+        break;
+    }
+    NODE(ctx,n)->sibling = NIL_NODE;
+    if (drop)
+    { countUses(ctx,NODE(ctx,n)->child[0],uses,-1);
+      *changed = TRUE;
+    }
+    else tail = append(ctx,&head,tail,n);
+    n = next;
+  }
+  return head;
+}
+
+/* Procedure begin makes room for the facts of
+ * every node and clears them
+ */
+static void begin( CompileCtx * ctx )
+{ struct PropRec * r = ctx->prop;
+  if (r == NULL)
+  { r = ctx->prop = (struct PropRec *) calloc(1,sizeof(struct PropRec));
+    countAlloc(ctx,sizeof(struct PropRec));
+  }
+  if (r->nfacts < (int) ctx->nodeTop)
+  { free(r->fact);
+    free(r->flags);
+    r->nfacts = ctx->nodeTop;
+    r->fact = (Lat *) malloc(r->nfacts*sizeof(Lat));
+    r->flags = (char *) malloc(r->nfacts);
+    countAlloc(ctx,r->nfacts*(sizeof(Lat)+1));
+  }
+  memset(r->fact,0,ctx->nodeTop*sizeof(Lat));
+  memset(r->flags,0,ctx->nodeTop);
+}
+
+/* Procedure growVars makes room in the state
+ * between statements for every variable, the new
+ * ones holding 0
+ */
+static void growVars( CompileCtx * ctx )
+{ struct PropRec * r = ctx->prop;
+  if (r->nvars < ctx->location)
+  { int i;
+    r->vars = (Lat *) realloc(r->vars,ctx->location*sizeof(Lat));
+    countAlloc(ctx,ctx->location*sizeof(Lat));
+    for (i=r->nvars;i<ctx->location;i++)
+    { r->vars[i].kind = LAT_CONST;
+      r->vars[i].val = 0;
+    }
+    r->nvars = ctx->location;
+  }
+}
+
+/* Function propagate propagates constants through
+ * the program tree, removes the code that never
+ * runs and the assignments to variables that are
+ * never read, and returns the new first statement
+ * of the program (NIL_NODE if nothing is left)
+ */
+NodeId propagate( CompileCtx * ctx, NodeId tree )
+{ int * uses;
+  int changed;
+  begin(ctx);
+  growVars(ctx);
+  runSeq(ctx,tree,ctx->prop->vars);
+  tree = rewriteSeq(ctx,tree);
+  uses = (int *) calloc(ctx->location+1,sizeof(int));
+  countAlloc(ctx,(ctx->location+1)*sizeof(int));
+  countSeq(ctx,tree,uses);
+  do
+  { changed = FALSE;
+    tree = dropDead(ctx,tree,uses,&changed);
+  } while (changed);
+  free(uses);
+  return tree;
+}
+
+/* Function propagateStmt does the same for one
+ * top-level statement, knowing what the ones
+ * before it left in the variables; assignments
+ * are kept, since later statements are not yet
+ * known. Returns what is left of the statement
+ */
+NodeId propagateStmt( CompileCtx * ctx, NodeId stmt )
+{ begin(ctx);
+  if (ctx->prop->dead) return NIL_NODE;
+  growVars(ctx);
+  if (! runStmt(ctx,stmt,ctx->prop->vars)) ctx->prop->dead = TRUE;
+  return rewriteSeq(ctx,stmt);
+}
+
+/* Procedure propagateFree releases the state of
+ * the propagation
+ */
+void propagateFree( CompileCtx * ctx )
+{ struct PropRec * r = ctx->prop;
+  if (r == NULL) return;
+  free(r->fact);
+  free(r->flags);
+  free(r->vars);
+  free(r);
+  ctx->prop = NULL;
+}
@@ -0,0 +1,35 @@
+/****************************************************/
+/* File: sccp.h                                     */
+/* Conditional constant propagation for the TINY    */
+/* compiler                                         */
+/* With -O, expressions whose value is the same     */
+/* every time they run become constants, and the    */
+/* parts of ifs and repeats that can never run are  */
+/* removed from the syntax tree                     */
+/****************************************************/
+
+#ifndef _SCCP_H_
+#define _SCCP_H_
+
+/* Function propagate propagates constants through
+ * the program tree, removes the code that never
+ * runs and the assignments to variables that are
+ * never read, and returns the new first statement
+ * of the program (NIL_NODE if nothing is left)
+ */
+NodeId propagate( CompileCtx * ctx, NodeId tree );
+
+/* Function propagateStmt does the same for one
+ * top-level statement, knowing what the ones
+ * before it left in the variables; assignments
+ * are kept, since later statements are not yet
+ * known. Returns what is left of the statement
+ */
+NodeId propagateStmt( CompileCtx * ctx, NodeId stmt );
+
+/* Procedure propagateFree releases the state of
+ * the propagation
+ */
+void propagateFree( CompileCtx * ctx );
+
+#endif
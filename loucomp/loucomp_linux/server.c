@@ -0,0 +1,191 @@
+/****************************************************/
+/* File: server.c                                   */
+/* The wire protocol of the TINY compile server     */
+/* (see server.h)                                   */
+/****************************************************/
+
+/* for struct ucred */
+#define _GNU_SOURCE
+#include "globals.h"
+#include "server.h"
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/* MAXITEM bounds the length of an item, so that a
+ * stray connection cannot make the other side
+ * allocate without limit
+ */
+#define MAXITEM (1L << 30)
+
+/* Function socketAddr fills in the address of the
+ * socket at path; FALSE if path is too long
+ */
+static int socketAddr( struct sockaddr_un * addr, const char * path )
+{ memset(addr,0,sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr->sun_path)) return FALSE;
+  strcpy(addr->sun_path,path);
+  return TRUE;
+}
+
+/* Function serverListen makes a socket at path,
+ * replacing any left there, that only its owner
+ * may connect to, and returns it ready to accept
+ * connections; -1 on failure
+ */
+int serverListen( const char * path )
+{ struct sockaddr_un addr;
+  int fd;
+  if (!socketAddr(&addr,path)) return -1;
+  fd = socket(AF_UNIX,SOCK_STREAM,0);
+  if (fd < 0) return -1;
+  unlink(path);
+  /* the mode is set before listen, so that no
+     one else can connect in between */
+  if ((bind(fd,(struct sockaddr *) &addr,sizeof(addr)) != 0)
+      || (chmod(path,S_IRUSR|S_IWUSR) != 0)
+      || (listen(fd,64) != 0))
+  { close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/* Function serverPeerOk is TRUE if the client
+ * connected on fd runs as the same user as the
+ * server; a request does what that user may do
+ */
+int serverPeerOk( int fd )
+{ struct ucred cred;
+  socklen_t len = sizeof(cred);
+  if (getsockopt(fd,SOL_SOCKET,SO_PEERCRED,&cred,&len) != 0)
+    return FALSE;
+  return cred.uid == geteuid();
+}
+
+/* Function serverConnect returns a connection
+ * to the server at path; -1 if there is none
+ */
+int serverConnect( const char * path )
+{ struct sockaddr_un addr;
+  int fd;
+  if (!socketAddr(&addr,path)) return -1;
+  fd = socket(AF_UNIX,SOCK_STREAM,0);
+  if (fd < 0) return -1;
+  if (connect(fd,(struct sockaddr *) &addr,sizeof(addr)) != 0)
+  { close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/* writeAll writes the n bytes at p to fd,
+   retrying short writes */
+static int writeAll( int fd, const char * p, long n )
+{ while (n > 0)
+  { ssize_t w = write(fd,p,n);
+    if (w <= 0) return FALSE;
+    p += w;
+    n -= w;
+  }
+  return TRUE;
+}
+
+/* Function putBytes sends the n bytes at p as
+ * one item on fd; FALSE if they could not be sent
+ */
+int putBytes( int fd, const char * p, long n )
+{ char len[24];
+  sprintf(len,"%ld\n",n);
+  return writeAll(fd,len,strlen(len)) && writeAll(fd,p,n);
+}
+
+/* Function putString sends string s as one item */
+int putString( int fd, const char * s )
+{ return putBytes(fd,s,strlen(s)); }
+
+/* Function putFile sends as one item everything
+ * written so far to file f
+ */
+int putFile( int fd, FILE * f )
+{ char buf[4096];
+  char len[24];
+  long n;
+  size_t got;
+  fflush(f);
+  n = ftell(f);
+  if (n < 0) return FALSE;
+  sprintf(len,"%ld\n",n);
+  if (!writeAll(fd,len,strlen(len))) return FALSE;
+  rewind(f);
+  while ((n > 0) && ((got = fread(buf,1,sizeof(buf),f)) > 0))
+  { if ((long) got > n) got = n;
+    if (!writeAll(fd,buf,got)) return FALSE;
+    n -= got;
+  }
+  return n == 0;
+}
+
+/* Function getBytes receives an item from fd into
+ * a new buffer, with a '\0' added, and sets *n to
+ * its length unless n is NULL; NULL if none came
+ */
+char * getBytes( int fd, long * n )
+{ long len = 0, got = 0;
+  char c;
+  char * p;
+  int digits = 0;
+  /* the length is read a byte at a time, so that
+     nothing of the item itself is taken */
+  for (;;)
+  { if (read(fd,&c,1) != 1) return NULL;
+    if (c == '\n') break;
+    if ((c < '0') || (c > '9') || (++digits > 10)) return NULL;
+    len = 10*len + (c - '0');
+  }
+  if ((digits == 0) || (len > MAXITEM)) return NULL;
+  p = (char *) malloc(len+1);
+  if (p == NULL) return NULL;
+  while (got < len)
+  { ssize_t r = read(fd,p+got,len-got);
+    if (r <= 0)
+    { free(p);
+      return NULL;
+    }
+    got += r;
+  }
+  p[len] = '\0';
+  if (n != NULL) *n = len;
+  return p;
+}
+
+/* Function readAll reads fd to its end into a new
+ * buffer, with a '\0' added, and sets *n to its
+ * length; NULL if fd could not be read
+ */
+char * readAll( int fd, long * n )
+{ long size = 4096, len = 0;
+  char * p = (char *) malloc(size);
+  ssize_t r;
+  if (p == NULL) return NULL;
+  for (;;)
+  { if (len+1 >= size)
+    { char * q = (char *) realloc(p,2*size);
+      if (q == NULL) break;
+      p = q;
+      size *= 2;
+    }
+    r = read(fd,p+len,size-len-1);
+    if (r == 0)
+    { p[len] = '\0';
+      *n = len;
+      return p;
+    }
+    if (r < 0) break;
+    len += r;
+  }
+  free(p);
+  return NULL;
+}
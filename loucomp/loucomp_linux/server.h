@@ -0,0 +1,69 @@
+/****************************************************/
+/* File: server.h                                   */
+/* The wire protocol of the TINY compile server     */
+/* tiny -serve listens on a Unix domain socket and  */
+/* compiles each request it gets there, so that a   */
+/* build pays for starting the compiler only once;  */
+/* tinyc is the client (see tinyc.c)                */
+/****************************************************/
+
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+/* A request is the working directory of the
+ * client, the number of its arguments and the
+ * arguments themselves, as given to tiny; an
+ * argument "-" (the program on standard input)
+ * is followed by the source text. The reply is
+ * the exit status, then what tiny wrote to
+ * stdout (the listings) and to stderr (the
+ * diagnostics and statistics). The code files
+ * are written where tiny would write them.
+ * Each item is sent as its length in decimal,
+ * a newline and then its bytes
+ */
+
+/* Function serverListen makes a socket at path,
+ * replacing any left there, that only its owner
+ * may connect to, and returns it ready to accept
+ * connections; -1 on failure
+ */
+int serverListen( const char * path );
+
+/* Function serverPeerOk is TRUE if the client
+ * connected on fd runs as the same user as the
+ * server; a request does what that user may do
+ */
+int serverPeerOk( int fd );
+
+/* Function serverConnect returns a connection
+ * to the server at path; -1 if there is none
+ */
+int serverConnect( const char * path );
+
+/* Function putBytes sends the n bytes at p as
+ * one item on fd; FALSE if they could not be sent
+ */
+int putBytes( int fd, const char * p, long n );
+
+/* Function putString sends string s as one item */
+int putString( int fd, const char * s );
+
+/* Function putFile sends as one item everything
+ * written so far to file f
+ */
+int putFile( int fd, FILE * f );
+
+/* Function getBytes receives an item from fd into
+ * a new buffer, with a '\0' added, and sets *n to
+ * its length unless n is NULL; NULL if none came
+ */
+char * getBytes( int fd, long * n );
+
+/* Function readAll reads fd to its end into a new
+ * buffer, with a '\0' added, and sets *n to its
+ * length; NULL if fd could not be read
+ */
+char * readAll( int fd, long * n );
+
+#endif
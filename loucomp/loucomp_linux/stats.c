@@ -0,0 +1,113 @@
+/****************************************************/
+/* File: stats.c                                    */
+/* Per-phase statistics implementation              */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "globals.h"
+#include "arena.h"
+#include "stats.h"
+#include <time.h>
+
+static const char * phaseName[NPHASES] =
+   { "parse", "analyze", "codegen" };
+
+/* the wall-clock time in seconds */
+static double now( void )
+{ struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC,&t);
+  return t.tv_sec + t.tv_nsec/1e9;
+}
+
+/* the running counters of ctx, as a PhaseStats */
+static PhaseStats counters( CompileCtx * ctx )
+{ PhaseStats s;
+  s.seconds = now();
+  s.tokens = ctx->ntokens;
+  s.nodes = nodeCount(ctx) + ctx->nodesReleased;
+  s.symbols = ctx->nsymbols;
+  s.allocs = ctx->nallocs;
+  s.allocBytes = ctx->allocBytes;
+  s.instructions = ctx->ninstructions;
+  return s;
+}
+
+/* Procedure beginPhase notes the time and the
+ * counters as a phase starts
+ */
+void beginPhase( CompileCtx * ctx )
+{ ctx->phaseStart = counters(ctx); }
+
+/* Procedure endPhase adds to ctx->stats[p] what
+ * happened since the matching beginPhase; a
+ * phase may run in several pieces
+ */
+void endPhase( CompileCtx * ctx, Phase p )
+{ PhaseStats e = counters(ctx);
+  PhaseStats * s = &ctx->stats[p];
+  s->seconds += e.seconds - ctx->phaseStart.seconds;
+  s->tokens += e.tokens - ctx->phaseStart.tokens;
+  s->nodes += e.nodes - ctx->phaseStart.nodes;
+  s->symbols += e.symbols - ctx->phaseStart.symbols;
+  s->allocs += e.allocs - ctx->phaseStart.allocs;
+  s->allocBytes += e.allocBytes - ctx->phaseStart.allocBytes;
+  s->instructions += e.instructions - ctx->phaseStart.instructions;
+}
+
+/* printJsonString prints s as a JSON string */
+static void printJsonString( FILE * out, const char * s )
+{ putc('"',out);
+  for (;*s != '\0';s++)
+    if ((*s == '"') || (*s == '\\')) fprintf(out,"\\%c",*s);
+    else if ((unsigned char) *s < ' ') fprintf(out,"\\u%04x",*s);
+    else putc(*s,out);
+  putc('"',out);
+}
+
+/* Procedure printStats prints the statistics
+ * of the compilation of file name to out, as
+ * text or, if json is TRUE, as a JSON object;
+ * cached is TRUE if no phase ran because the
+ * result came from the compilation cache
+ */
+void printStats( FILE * out, const char * name,
+                 PhaseStats stats[NPHASES], int cached, int json )
+{ PhaseStats total;
+  int i;
+  memset(&total,0,sizeof(total));
+  for (i=0;i<NPHASES;i++)
+  { total.seconds += stats[i].seconds;
+    total.tokens += stats[i].tokens;
+    total.nodes += stats[i].nodes;
+    total.symbols += stats[i].symbols;
+    total.allocs += stats[i].allocs;
+    total.allocBytes += stats[i].allocBytes;
+    total.instructions += stats[i].instructions;
+  }
+  if (json)
+  { fprintf(out,"{\"file\": ");
+    printJsonString(out,name);
+    fprintf(out,", \"cached\": %s, \"phases\": {",cached ? "true" : "false");
+    for (i=0;i<NPHASES;i++)
+      fprintf(out,"%s\n  \"%s\": {\"seconds\": %.6f, \"tokens\": %ld, "
+                  "\"nodes\": %ld, \"symbols\": %ld, \"allocs\": %ld, "
+                  "\"allocBytes\": %ld, \"instructions\": %ld}",
+              (i == 0) ? "" : ",",phaseName[i],stats[i].seconds,
+              stats[i].tokens,stats[i].nodes,stats[i].symbols,
+              stats[i].allocs,stats[i].allocBytes,stats[i].instructions);
+    fprintf(out,"},\n \"totalSeconds\": %.6f}",total.seconds);
+    return;
+  }
+  fprintf(out,"\nStatistics for %s%s:\n",name,cached ? " (cached)" : "");
+  fprintf(out,"Phase      Time (ms)    Tokens     Nodes   Symbols"
+              "    Allocs     Bytes  Instrs\n");
+  fprintf(out,"-----      ---------    ------     -----   -------"
+              "    ------     -----  ------\n");
+  for (i=0;i<=NPHASES;i++)
+  { PhaseStats * s = (i < NPHASES) ? &stats[i] : &total;
+    fprintf(out,"%-9s %10.3f %9ld %9ld %9ld %9ld %9ld %7ld\n",
+            (i < NPHASES) ? phaseName[i] : "total",s->seconds*1e3,
+            s->tokens,s->nodes,s->symbols,s->allocs,s->allocBytes,
+            s->instructions);
+  }
+}
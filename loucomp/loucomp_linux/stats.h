@@ -0,0 +1,38 @@
+/****************************************************/
+/* File: stats.h                                    */
+/* Per-phase statistics for the TINY compiler       */
+/* Every phase keeps running counters in its        */
+/* context; beginPhase and endPhase turn them into  */
+/* the figures of one phase for the -stats report   */
+/****************************************************/
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+/* countAlloc records an allocation of n bytes
+ * made on behalf of the compilation ctx
+ */
+#define countAlloc(ctx,n) \
+   ((ctx)->nallocs++, (ctx)->allocBytes += (long) (n))
+
+/* Procedure beginPhase notes the time and the
+ * counters as a phase starts
+ */
+void beginPhase( CompileCtx * ctx );
+
+/* Procedure endPhase adds to ctx->stats[p] what
+ * happened since the matching beginPhase; a
+ * phase may run in several pieces
+ */
+void endPhase( CompileCtx * ctx, Phase p );
+
+/* Procedure printStats prints the statistics
+ * of the compilation of file name to out, as
+ * text or, if json is TRUE, as a JSON object;
+ * cached is TRUE if no phase ran because the
+ * result came from the compilation cache
+ */
+void printStats( FILE * out, const char * name,
+                 PhaseStats stats[NPHASES], int cached, int json );
+
+#endif
@@ -0,0 +1,456 @@
+/****************************************************/
+/* File: superopt.c                                 */
+/* The superoptimizer that makes the TM rewrite     */
+/* rules of tmrules.c (see rewrite.h). For each of  */
+/* the sequences tiny emits for an operation, it    */
+/* tries every shorter sequence over ac, ac1 and    */
+/* the register or memory the sequence uses, and    */
+/* keeps the first, of the fewest instructions,     */
+/* that leaves the same state as the sequence on    */
+/* every one of its tests: all values of the        */
+/* registers, memory and constant from -2 to 2, and */
+/* many random ones. It writes the rules as C:      */
+/*    superopt > tmrules.c                          */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "tmeng.h"
+#include "rewrite.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* the registers of the TINY code (see code.h) */
+#define AC  0
+#define AC1 1
+#define GP  5
+#define MP  6
+
+/* MP is DADDR_SIZE-1 in the TM, as tiny's prelude
+   loads it from location 0 */
+#define MPVAL (DADDR_SIZE-1)
+
+/* the temporaries of tiny -O are at -16(mp) and
+   below (see cse.h) */
+#define TMPTOP (-16)
+
+/* a step that would trap on the host: INT_MIN/-1 */
+#define OVERFLOW (-1)
+
+/* NRANDOM is the number of random tests, after
+   those of the small values */
+#define NRANDOM 5000
+
+/* NQUICK is the number of tests a candidate is
+   tried on before all of them */
+#define NQUICK 16
+
+/* MAXALPHA bounds the instructions tried */
+#define MAXALPHA 256
+
+/* a test: the registers other than gp, mp and
+   the pc, the temporary, the variable, and the
+   parameters */
+typedef struct
+   { int reg[5];
+     int tmp;
+     int var;
+     int param[NPARAMS];
+   } TEST;
+
+/* what a sequence left on a test */
+typedef struct
+   { int result;
+     int reg[MP+1];
+     int tmp;
+     int var;
+   } OUTCOME;
+
+static TM * tm;
+
+static TEST * tests;
+static int ntests;
+
+static RULEINSTR alpha[MAXALPHA];
+static int nalpha;
+
+/* rnd returns the next pseudo-random number, the
+   same ones on every run */
+static unsigned long seed = 12345;
+static int rnd( void )
+{ seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+  return (int) (seed >> 32);
+}
+
+/* value returns a random value for a test, often
+   a small one or one at the ends of the range */
+static int value( void )
+{ static int edge[] = { 0, 1, -1, 2, -2, INT_MAX, INT_MIN+1, INT_MIN };
+  int r = rnd() & 3;
+  if (r == 0) return edge[(unsigned) rnd() % 8];
+  if (r == 1) return rnd() % 100;
+  return rnd();
+}
+
+/* addTest adds a test of regs, temporary and
+   variable values v; the parameters are from k
+   (the constant) and the random numbers */
+static void addTest( int * v, int k )
+{ TEST * t = &tests[ntests++];
+  int i;
+  for (i = 0; i < 5; i++) t->reg[i] = v[i];
+  t->tmp = v[5];
+  t->var = v[6];
+  t->param[P_K] = k;
+  t->param[P_T] = TMPTOP - (int) ((unsigned) rnd() % 9);
+  t->param[P_X] = (unsigned) rnd() % 21;
+  t->param[P_R] = 2 + (unsigned) rnd() % 3;
+}
+
+/* makeTests makes the tests: first NQUICK random
+   ones, then every small value of ac, ac1, the
+   temporary, the variable, register 2 and the
+   constant, then the rest of the random ones */
+static void makeTests( void )
+{ int v[7], i, k, n;
+  tests = (TEST *) malloc((NRANDOM + 15625 + 1) * sizeof(TEST));
+  if (tests == NULL)
+  { fprintf(stderr,"out of memory\n");
+    exit(1);
+  }
+  for (n = 0; n < NRANDOM; n++)
+  { if (n == NQUICK)
+      for (i = 0; i < 5*5*5*5*5*5; i++)
+      { int j = i;
+        v[0] = j%5-2; j /= 5;
+        v[1] = j%5-2; j /= 5;
+        v[5] = j%5-2; j /= 5;
+        v[6] = j%5-2; j /= 5;
+        v[2] = v[3] = v[4] = j%5-2; j /= 5;
+        addTest(v,j%5-2);
+      }
+    for (i = 0; i < 7; i++) v[i] = value();
+    /* a constant of tiny is never negated to
+       overflow (see ruleApply) */
+    do k = value(); while (k == INT_MIN);
+    addTest(v,k);
+  }
+}
+
+/* instance writes instruction ri with the
+   parameters of test t to i */
+static void instance( RULEINSTR * ri, TEST * t, INSTRUCTION * i )
+{ int a[3], k;
+  for (k = 0; k < 3; k++)
+  { RULEARG * g = &ri->arg[k];
+    if (g->kind == 'c') a[k] = g->val;
+    else if (g->kind == 'p') a[k] = t->param[g->val];
+    else a[k] = -t->param[g->val];
+  }
+  i->iop = ri->op;
+  i->iarg1 = a[0];
+  i->iarg2 = a[1];
+  i->iarg3 = a[2];
+}
+
+/* run runs the n instructions of seq on test t,
+   leaving what they did in o */
+static void run( RULEINSTR * seq, int n, TEST * t, OUTCOME * o )
+{ int i, tmpAddr = MPVAL + t->param[P_T];
+  for (i = 0; i < n; i++) instance(&seq[i],t,&tm->iMem[i]);
+  tm->iMem[n].iop = opHALT;
+  for (i = 0; i < 5; i++) tm->reg[i] = t->reg[i];
+  tm->reg[GP] = 0;
+  tm->reg[MP] = MPVAL;
+  tm->reg[PC_REG] = 0;
+  tm->dMem[tmpAddr] = t->tmp;
+  tm->dMem[t->param[P_X]] = t->var;
+  for (;;)
+  { INSTRUCTION * in = &tm->iMem[tm->reg[PC_REG]];
+    if ((in->iop == opDIV) && (tm->reg[in->iarg2] == INT_MIN)
+        && (tm->reg[in->iarg3] == -1))
+    { o->result = OVERFLOW;
+      break;
+    }
+    o->result = tmStep(tm);
+    if (o->result != srOKAY) break;
+  }
+  for (i = 0; i <= MP; i++) o->reg[i] = tm->reg[i];
+  o->tmp = tm->dMem[tmpAddr];
+  o->var = tm->dMem[t->param[P_X]];
+}
+
+/* same is TRUE if outcomes a and b are the same
+   where it matters: all of the state if they
+   halted, except what dead names */
+static int same( OUTCOME * a, OUTCOME * b, int dead )
+{ int i;
+  if (a->result != b->result) return FALSE;
+  if (a->result != srHALT) return TRUE;
+  for (i = 0; i <= MP; i++)
+    if ((a->reg[i] != b->reg[i]) && !((i == AC1) && (dead & DEAD_AC1)))
+      return FALSE;
+  if ((a->tmp != b->tmp) && !(dead & DEAD_TMP)) return FALSE;
+  return a->var == b->var;
+}
+
+/* the outcomes of the left side on the tests */
+static OUTCOME * want;
+
+/* equivalent is TRUE if the n instructions of seq
+   do what the left side did on tests from..to-1 */
+static int equivalent( RULEINSTR * seq, int n, int dead, int from, int to )
+{ OUTCOME o;
+  int i;
+  for (i = from; i < to; i++)
+  { run(seq,n,&tests[i],&o);
+    if (!same(&o,&want[i],dead)) return FALSE;
+  }
+  return TRUE;
+}
+
+/* ri returns an instruction of a rule */
+static RULEINSTR ri( int op, char k0, int v0, char k1, int v1, char k2, int v2 )
+{ RULEINSTR i;
+  i.op = op;
+  i.arg[0].kind = k0; i.arg[0].val = v0;
+  i.arg[1].kind = k1; i.arg[1].val = v1;
+  i.arg[2].kind = k2; i.arg[2].val = v2;
+  return i;
+}
+
+/* makeAlphabet fills alpha with the instructions
+   that may make up a right side, for a left side
+   that uses the parameters in uses */
+static void makeAlphabet( int uses )
+{ static int small[] = { 0, 1, -1, 2, -2 };
+  RULEARG imm[7];
+  int src[3], nsrc = 0, nimm = 0;
+  int i, r, s, t, op;
+  nalpha = 0;
+  for (i = 0; i < 5; i++)
+  { imm[nimm].kind = 'c';
+    imm[nimm++].val = small[i];
+  }
+  if (uses & (1 << P_K))
+  { imm[nimm].kind = 'p'; imm[nimm++].val = P_K;
+    imm[nimm].kind = 'n'; imm[nimm++].val = P_K;
+  }
+  src[nsrc++] = AC;
+  src[nsrc++] = AC1;
+  if (uses & (1 << P_R)) src[nsrc++] = P_R;
+  for (r = AC; r <= AC1; r++)
+  { if (uses & (1 << P_T))
+      alpha[nalpha++] = ri(opLD,'c',r,'p',P_T,'c',MP);
+    if (uses & (1 << P_X))
+      alpha[nalpha++] = ri(opLD,'c',r,'p',P_X,'c',GP);
+  }
+  for (s = 0; s < nsrc; s++)
+  { char k = (s == 2) ? 'p' : 'c';
+    if (uses & (1 << P_T))
+      alpha[nalpha++] = ri(opST,k,src[s],'p',P_T,'c',MP);
+    if (uses & (1 << P_X))
+      alpha[nalpha++] = ri(opST,k,src[s],'p',P_X,'c',GP);
+  }
+  for (r = AC; r <= AC1; r++)
+    for (i = 0; i < nimm; i++)
+    { alpha[nalpha++] = ri(opLDC,'c',r,imm[i].kind,imm[i].val,'c',AC);
+      for (s = 0; s < nsrc; s++)
+        alpha[nalpha++] = ri(opLDA,'c',r,imm[i].kind,imm[i].val,
+                             (s == 2) ? 'p' : 'c',src[s]);
+    }
+  for (op = opADD; op <= opDIV; op++)
+    for (r = AC; r <= AC1; r++)
+      for (s = 0; s < nsrc; s++)
+        for (t = 0; t < nsrc; t++)
+          alpha[nalpha++] = ri(op,'c',r,(s == 2) ? 'p' : 'c',src[s],
+                               (t == 2) ? 'p' : 'c',src[t]);
+}
+
+/* search finds in rhs the first sequence of the
+   fewest instructions, fewer than max, that does
+   what the left side does wherever dead is dead;
+   its length, or -1 if there is none */
+static int search( RULEINSTR * rhs, int max, int dead )
+{ int pick[RULEMAX];
+  int n, i;
+  for (n = 0; n < max; n++)
+  { for (i = 0; i < n; i++) pick[i] = 0;
+    for (;;)
+    { for (i = 0; i < n; i++) rhs[i] = alpha[pick[i]];
+      if (equivalent(rhs,n,dead,0,NQUICK)
+          && equivalent(rhs,n,dead,NQUICK,ntests))
+        return n;
+      /* the next sequence of n instructions */
+      for (i = n-1; i >= 0; i--)
+      { if (++pick[i] < nalpha) break;
+        pick[i] = 0;
+      }
+      if (i < 0) break;
+    }
+  }
+  return -1;
+}
+
+/* printInstr writes instruction i as it is
+   written in TM code, with the parameters by
+   name */
+static void printInstr( FILE * f, RULEINSTR * i )
+{ static char * pname[] = { "K", "T", "X", "R" };
+  int k;
+  fprintf(f,"%s ",opCodeTab[i->op]);
+  for (k = 0; k < 3; k++)
+  { RULEARG * a = &i->arg[k];
+    if (a->kind == 'c') fprintf(f,"%d",a->val);
+    else fprintf(f,"%s%s",(a->kind == 'n') ? "-" : "",pname[a->val]);
+    if (k == 0) fputc(',',f);
+    else if (k == 1) fputc((opClass(i->op) == opclRR) ? ',' : '(',f);
+    else if (opClass(i->op) != opclRR) fputc(')',f);
+  }
+}
+
+/* printSide writes the n instructions of a side
+   of a rule as C */
+static void printSide( FILE * f, RULEINSTR * side, int n )
+{ static char * pconst[] = { "P_K", "P_T", "P_X", "P_R" };
+  int i, k;
+  fprintf(f,"{");
+  for (i = 0; i < n; i++)
+  { fprintf(f,"%s{op%s,{",(i > 0) ? "," : "",opCodeTab[side[i].op]);
+    for (k = 0; k < 3; k++)
+    { RULEARG * a = &side[i].arg[k];
+      if (a->kind == 'c') fprintf(f,"%s{'c',%d}",k ? "," : "",a->val);
+      else fprintf(f,"%s{'%c',%s}",k ? "," : "",a->kind,pconst[a->val]);
+    }
+    fprintf(f,"}}");
+  }
+  if (n == 0) fprintf(f,"{0}");
+  fprintf(f,"}");
+}
+
+/* printRule writes rule r as C */
+static void printRule( FILE * f, TMRULE * r )
+{ int i;
+  fprintf(f,"  /* ");
+  for (i = 0; i < r->nlhs; i++)
+  { if (i > 0) fprintf(f,"; ");
+    printInstr(f,&r->lhs[i]);
+  }
+  fprintf(f,"\n     => ");
+  for (i = 0; i < r->nrhs; i++)
+  { if (i > 0) fprintf(f,"; ");
+    printInstr(f,&r->rhs[i]);
+  }
+  if (r->nrhs == 0) fprintf(f,"(nothing)");
+  if (r->dead == 0) fprintf(f," */\n");
+  else fprintf(f,"\n     if %s%s%s dead */\n",
+               (r->dead & DEAD_AC1) ? "ac1" : "",
+               (r->dead == (DEAD_AC1|DEAD_TMP)) ? " and " : "",
+               (r->dead & DEAD_TMP) ? "T(mp)" : "");
+  fprintf(f,"  { %d, ",r->nlhs);
+  printSide(f,r->lhs,r->nlhs);
+  fprintf(f,",\n    %d, ",r->nrhs);
+  printSide(f,r->rhs,r->nrhs);
+  fprintf(f,",\n    %s },\n",(r->dead == 0) ? "0" :
+          (r->dead == DEAD_AC1) ? "DEAD_AC1" :
+          (r->dead == DEAD_TMP) ? "DEAD_TMP" : "DEAD_AC1|DEAD_TMP");
+}
+
+/* the left sides: the sequences of cgen.c for an
+   operation whose right operand is a constant,
+   a variable or a value kept by cse.c in a
+   register, and the load of a variable just
+   stored */
+static TMRULE lhs[32];
+static int nlhs;
+
+static void makeLeftSides( void )
+{ static int ops[] = { opADD, opSUB, opMUL, opDIV };
+  static int konst[] = { 0, 1, 2, -1 }; /* -1: any */
+  int o, k;
+  for (o = 0; o < 4; o++)
+  { RULEINSTR push = ri(opST,'c',AC,'p',P_T,'c',MP);
+    RULEINSTR pop = ri(opLD,'c',AC1,'p',P_T,'c',MP);
+    RULEINSTR op = ri(ops[o],'c',AC,'c',AC1,'c',AC);
+    for (k = 0; k < 5; k++)
+    { TMRULE * r = &lhs[nlhs++];
+      r->nlhs = 4;
+      r->lhs[0] = push;
+      if (k < 4)
+        r->lhs[1] = (konst[k] < 0) ? ri(opLDC,'c',AC,'p',P_K,'c',AC)
+                                   : ri(opLDC,'c',AC,'c',konst[k],'c',AC);
+      else r->lhs[1] = ri(opLD,'c',AC,'p',P_X,'c',GP);
+      r->lhs[2] = pop;
+      r->lhs[3] = op;
+    }
+    lhs[nlhs] = lhs[nlhs-1];
+    lhs[nlhs++].lhs[1] = ri(opLDA,'c',AC,'c',0,'p',P_R);
+  }
+  lhs[nlhs].nlhs = 2;
+  lhs[nlhs].lhs[0] = ri(opST,'c',AC,'p',P_X,'c',GP);
+  lhs[nlhs++].lhs[1] = ri(opLD,'c',AC,'p',P_X,'c',GP);
+}
+
+/* uses returns the parameters that rule r uses,
+   as a set of bits */
+static int uses( TMRULE * r )
+{ int i, k, u = 0;
+  for (i = 0; i < r->nlhs; i++)
+    for (k = 0; k < 3; k++)
+      if (r->lhs[i].arg[k].kind != 'c') u |= 1 << r->lhs[i].arg[k].val;
+  return u;
+}
+
+int main( int argc, char * argv[] )
+{ static int levels[] = { 0, DEAD_AC1, DEAD_AC1|DEAD_TMP };
+  TMRULE found[3];
+  int l, i, j, n, best, nfound;
+  tm = tmNew(RULEMAX+1);
+  want = (OUTCOME *) malloc((NRANDOM + 15625 + 1) * sizeof(OUTCOME));
+  if ((tm == NULL) || (want == NULL))
+  { fprintf(stderr,"out of memory\n");
+    exit(1);
+  }
+  makeTests();
+  makeLeftSides();
+  printf("/****************************************************/\n");
+  printf("/* File: tmrules.c                                  */\n");
+  printf("/* The TM rewrite rules (see rewrite.h), made by    */\n");
+  printf("/* the superoptimizer superopt.c:                   */\n");
+  printf("/*    make rules                                    */\n");
+  printf("/* Do not edit                                      */\n");
+  printf("/****************************************************/\n\n");
+  printf("#include <stdio.h>\n#include \"tmeng.h\"\n#include \"rewrite.h\"\n\n");
+  printf("TMRULE tmRules[] = {\n");
+  for (i = 0; i < nlhs; i++)
+  { TMRULE * r = &lhs[i];
+    int u = uses(r);
+    for (j = 0; j < ntests; j++) run(r->lhs,r->nlhs,&tests[j],&want[j]);
+    makeAlphabet(u);
+    best = r->nlhs;
+    nfound = 0;
+    /* a rule that needs more to be dead is kept
+       only if it is shorter */
+    for (l = 0; l < 3; l++)
+    { if ((levels[l] & DEAD_TMP) && !(u & (1 << P_T))) continue;
+      n = search(found[nfound].rhs,best,levels[l]);
+      if (n < 0) continue;
+      found[nfound].nlhs = r->nlhs;
+      memcpy(found[nfound].lhs,r->lhs,sizeof(r->lhs));
+      found[nfound].nrhs = n;
+      found[nfound].dead = levels[l];
+      nfound++;
+      best = n;
+    }
+    while (nfound > 0) printRule(stdout,&found[--nfound]);
+  }
+  printf("};\n\nint tmNRules = sizeof(tmRules)/sizeof(tmRules[0]);\n");
+  return 0;
+}
@@ -1,27 +1,45 @@
 /****************************************************/
 /* File: symtab.c                                   */
 /* Symbol table implementation for the TINY compiler*/
-/* (allows only one symbol table)                   */
-/* Symbol table is implemented as a chained         */
-/* hash table                                       */
+/* (one symbol table per compilation context)       */
+/* Symbol table is implemented as a growable        */
+/* open-addressing hash table                       */
 /* Compiler Construction: Principles and Practice   */
 /* Kenneth C. Louden                                */
 /****************************************************/
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
+#include "globals.h"
+#include "util.h"
 #include "symtab.h"
+#include "stats.h"
 
-/* SIZE is the size of the hash table */
-#define SIZE 211
+/* INITSIZE is the initial number of slots in the
+   hash table; it must be a power of two */
+#define INITSIZE 256
+
+/* LINECHUNK is the number of line records
+   allocated at a time */
+#define LINECHUNK 1024
 
-/* SHIFT is the power of two used as multiplier
-   in hash function  */
+/* SIZE and SHIFT describe the chained hash table
+   of the original implementation; they are kept
+   only so that printSymTab lists the variables in
+   the same order as it always has */
+#define SIZE 211
 #define SHIFT 4
 
-/* the hash function */
-static int hash ( char * key )
+/* the hash function: no modulo per character,
+   the table size is a power of two */
+static unsigned hash ( char * key )
+{ unsigned temp = 2166136261u;
+  while (*key != '\0')
+    temp = (temp ^ (unsigned char) *key++) * 16777619u;
+  return temp;
+}
+
+/* the bucket the original hash function chose;
+   used by printSymTab only */
+static int printBucket ( char * key )
 { int temp = 0;
   int i = 0;
   while (key[i] != '\0')
@@ -31,7 +49,7 @@ static int hash ( char * key )
   return temp;
 }
 
-/* the list of line numbers of the source 
+/* the list of line numbers of the source
  * code in which a variable is referenced
  */
 typedef struct LineListRec
@@ -39,84 +57,225 @@ typedef struct LineListRec
      struct LineListRec * next;
    } * LineList;
 
-/* The record in the bucket lists for
- * each variable, including name, 
- * assigned memory location, and
- * the list of line numbers in which
- * it appears in the source code
+/* line records are handed out from chunks;
+   ctx->linesLeft counts the unused records in
+   the newest chunk, ctx->lineChunks */
+typedef struct LineChunkRec
+   { struct LineChunkRec * next;
+     struct LineListRec recs[LINECHUNK];
+   } * LineChunk;
+
+/* The record for each identifier, including name,
+ * assigned memory location, and the list of
+ * line numbers in which it appears in the source
+ * code; last points at the tail of that list so
+ * that a reference is recorded in constant time.
+ * A record is created when the scanner interns
+ * the name, and its index in ctx->symbols is the
+ * symbol id. ctx->hashTable maps names to records:
+ * each slot holds a symbol id plus one, or 0 if empty
  */
-typedef struct BucketListRec
+typedef struct SymbolRec
    { char * name;
+     unsigned hash;
      LineList lines;
+     LineList last;
      int memloc ; /* memory location for variable */
-     struct BucketListRec * next;
-   } * BucketList;
+     int order; /* position of first st_insert */
+   } * Symbol;
+
+static LineList newLine( CompileCtx * ctx, int lineno )
+{ LineList t;
+  if (ctx->linesLeft == 0)
+  { LineChunk c = (LineChunk) malloc(sizeof(struct LineChunkRec));
+    countAlloc(ctx,sizeof(struct LineChunkRec));
+    c->next = ctx->lineChunks;
+    ctx->lineChunks = c;
+    ctx->linesLeft = LINECHUNK;
+  }
+  t = &ctx->lineChunks->recs[LINECHUNK - ctx->linesLeft--];
+  t->lineno = lineno;
+  t->next = NULL;
+  return t;
+}
 
-/* the hash table */
-static BucketList hashTable[SIZE];
+/* Procedure grow doubles the hash table and
+ * reinserts every identifier
+ */
+static void grow( CompileCtx * ctx )
+{ unsigned size = (ctx->tableSize == 0) ? INITSIZE : 2*ctx->tableSize;
+  int i;
+  free(ctx->hashTable);
+  ctx->hashTable = (int *) calloc(size,sizeof(int));
+  countAlloc(ctx,size*sizeof(int));
+  ctx->tableSize = size;
+  for (i=0;i<ctx->nsymbols;++i)
+  { unsigned h = ctx->symbols[i].hash & (size-1);
+    while (ctx->hashTable[h] != 0) h = (h+1) & (size-1);
+    ctx->hashTable[h] = i+1;
+  }
+}
 
-/* Procedure st_insert inserts line numbers and
+/* Function find returns the slot that holds
+ * name, or the empty slot where it belongs;
+ * only st_intern looks names up this way
+ */
+static int * find( CompileCtx * ctx, char * name, unsigned h )
+{ unsigned mask = ctx->tableSize-1;
+  unsigned i = h & mask;
+  while (ctx->hashTable[i] != 0)
+  { Symbol l = &ctx->symbols[ctx->hashTable[i]-1];
+    if ((l->hash == h) && (strcmp(name,l->name) == 0))
+      break;
+    i = (i+1) & mask;
+  }
+  return &ctx->hashTable[i];
+}
+
+/* Function st_intern returns the symbol id of
+ * name, entering a copy of it into the table
+ * the first time it is seen
+ */
+int st_intern( CompileCtx * ctx, char * name )
+{ unsigned h = hash(name);
+  int * slot;
+  Symbol l;
+  /* keep the load factor at or below one half */
+  if (2*(ctx->nsymbols+1) > ctx->tableSize) grow(ctx);
+  slot = find(ctx,name,h);
+  if (*slot == 0) /* name not yet in table */
+  { if (ctx->nsymbols == ctx->maxsymbols)
+    { ctx->maxsymbols = (ctx->maxsymbols == 0) ? INITSIZE : 2*ctx->maxsymbols;
+      ctx->symbols = (Symbol) realloc(ctx->symbols,
+                   ctx->maxsymbols*sizeof(struct SymbolRec));
+      countAlloc(ctx,ctx->maxsymbols*sizeof(struct SymbolRec));
+    }
+    l = &ctx->symbols[ctx->nsymbols++];
+    l->name = copyString(ctx,name);
+    l->hash = h;
+    l->lines = l->last = NULL;
+    l->memloc = -1;
+    l->order = -1;
+    *slot = ctx->nsymbols;
+  }
+  return *slot-1;
+} /* st_intern */
+
+/* Function st_name returns the name of
+ * the identifier with symbol id sym, or
+ * NULL if sym is -1 (no identifier)
+ */
+char * st_name( CompileCtx * ctx, int sym )
+{ return (sym < 0) ? NULL : ctx->symbols[sym].name; }
+
+/* Function st_insert inserts line numbers and
  * memory locations into the symbol table
  * loc = memory location is inserted only the
  * first time, otherwise ignored
+ * Line numbers are only listed by printSymTab,
+ * so they are kept only if TraceAnalyze is set;
+ * otherwise the table does not grow with the
+ * length of the program
+ * Returns TRUE (1) if sym was not yet a variable
  */
-void st_insert( char * name, int lineno, int loc )
-{ int h = hash(name);
-  BucketList l =  hashTable[h];
-  while ((l != NULL) && (strcmp(name,l->name) != 0))
-    l = l->next;
-  if (l == NULL) /* variable not yet in table */
-  { l = (BucketList) malloc(sizeof(struct BucketListRec));
-    l->name = name;
-    l->lines = (LineList) malloc(sizeof(struct LineListRec));
-    l->lines->lineno = lineno;
-    l->memloc = loc;
-    l->lines->next = NULL;
-    l->next = hashTable[h];
-    hashTable[h] = l; }
-  else /* found in table, so just add line number */
-  { LineList t = l->lines;
-    while (t->next != NULL) t = t->next;
-    t->next = (LineList) malloc(sizeof(struct LineListRec));
-    t->next->lineno = lineno;
-    t->next->next = NULL;
+int st_insert( CompileCtx * ctx, int sym, int lineno, int loc )
+{ Symbol l = &ctx->symbols[sym];
+  int isNew = (l->order < 0);
+  if (isNew) /* variable not yet in table */
+  { l->memloc = loc;
+    l->order = ctx->nvariables++;
   }
+  if (TraceAnalyze)
+  { LineList t = newLine(ctx,lineno);
+    if (l->lines == NULL) l->lines = t;
+    else l->last->next = t;
+    l->last = t;
+  }
+  return isNew;
 } /* st_insert */
 
-/* Function st_lookup returns the memory 
+/* Function st_lookup returns the memory
  * location of a variable or -1 if not found
  */
-int st_lookup ( char * name )
-{ int h = hash(name);
-  BucketList l =  hashTable[h];
-  while ((l != NULL) && (strcmp(name,l->name) != 0))
-    l = l->next;
-  if (l == NULL) return -1;
-  else return l->memloc;
+int st_lookup ( CompileCtx * ctx, int sym )
+{ return ctx->symbols[sym].memloc; }
+
+/* Procedure st_free releases the symbol table */
+void st_free( CompileCtx * ctx )
+{ while (ctx->lineChunks != NULL)
+  { LineChunk c = ctx->lineChunks;
+    ctx->lineChunks = c->next;
+    free(c);
+  }
+  ctx->linesLeft = 0;
+  free(ctx->hashTable);
+  ctx->hashTable = NULL;
+  ctx->tableSize = 0;
+  free(ctx->symbols);
+  ctx->symbols = NULL;
+  ctx->nsymbols = ctx->maxsymbols = ctx->nvariables = 0;
 }
 
-/* Procedure printSymTab prints a formatted 
- * listing of the symbol table contents 
+/* Procedure st_reset empties the symbol table,
+ * keeping its hash table and records for the
+ * next compilation
+ */
+void st_reset( CompileCtx * ctx )
+{ while (ctx->lineChunks != NULL)
+  { LineChunk c = ctx->lineChunks;
+    ctx->lineChunks = c->next;
+    free(c);
+  }
+  ctx->linesLeft = 0;
+  if (ctx->hashTable != NULL)
+    memset(ctx->hashTable,0,ctx->tableSize*sizeof(int));
+  ctx->nsymbols = ctx->nvariables = 0;
+}
+
+/* the key printSymTab sorts variables by: the
+ * position they had in the original chained
+ * table, by bucket and newest first within one
+ */
+typedef struct
+   { int bucket;
+     int order;
+     int sym;
+   } PrintKey;
+
+static int printOrder( const void * a, const void * b )
+{ const PrintKey * l = (const PrintKey *) a;
+  const PrintKey * r = (const PrintKey *) b;
+  if (l->bucket != r->bucket) return l->bucket - r->bucket;
+  return r->order - l->order;
+}
+
+/* Procedure printSymTab prints a formatted
+ * listing of the symbol table contents
  * to the listing file
  */
-void printSymTab(FILE * listing)
-{ int i;
+void printSymTab(CompileCtx * ctx, FILE * listing)
+{ int i, n = 0;
+  PrintKey * keys = (PrintKey *) malloc((ctx->nsymbols+1)*sizeof(PrintKey));
+  for (i=0;i<ctx->nsymbols;++i)
+    if (ctx->symbols[i].order >= 0)
+    { keys[n].bucket = printBucket(ctx->symbols[i].name);
+      keys[n].order = ctx->symbols[i].order;
+      keys[n].sym = i;
+      n++;
+    }
+  qsort(keys,n,sizeof(PrintKey),printOrder);
   fprintf(listing,"Variable Name  Location   Line Numbers\n");
   fprintf(listing,"-------------  --------   ------------\n");
-  for (i=0;i<SIZE;++i)
-  { if (hashTable[i] != NULL)
-    { BucketList l = hashTable[i];
-      while (l != NULL)
-      { LineList t = l->lines;
-        fprintf(listing,"%-14s ",l->name);
-        fprintf(listing,"%-8d  ",l->memloc);
-        while (t != NULL)
-        { fprintf(listing,"%4d ",t->lineno);
-          t = t->next;
-        }
-        fprintf(listing,"\n");
-        l = l->next;
-      }
+  for (i=0;i<n;++i)
+  { Symbol l = &ctx->symbols[keys[i].sym];
+    LineList t = l->lines;
+    fprintf(listing,"%-14s ",l->name);
+    fprintf(listing,"%-8d  ",l->memloc);
+    while (t != NULL)
+    { fprintf(listing,"%4d ",t->lineno);
+      t = t->next;
     }
+    fprintf(listing,"\n");
   }
+  free(keys);
 } /* printSymTab */
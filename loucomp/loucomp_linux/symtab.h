@@ -1,7 +1,7 @@
 /****************************************************/
 /* File: symtab.h                                   */
 /* Symbol table interface for the TINY compiler     */
-/* (allows only one symbol table)                   */
+/* (one symbol table per compilation context)       */
 /* Compiler Construction: Principles and Practice   */
 /* Kenneth C. Louden                                */
 /****************************************************/
@@ -9,22 +9,46 @@
 #ifndef _SYMTAB_H_
 #define _SYMTAB_H_
 
-/* Procedure st_insert inserts line numbers and
+/* Function st_intern returns the symbol id of
+ * name, entering a copy of it into the table
+ * the first time it is seen. It is called once
+ * per identifier by the scanner; all later
+ * phases refer to the identifier by its id
+ */
+int st_intern( CompileCtx * ctx, char * name );
+
+/* Function st_name returns the name of
+ * the identifier with symbol id sym, or
+ * NULL if sym is -1 (no identifier)
+ */
+char * st_name( CompileCtx * ctx, int sym );
+
+/* Function st_insert inserts line numbers and
  * memory locations into the symbol table
  * loc = memory location is inserted only the
  * first time, otherwise ignored
+ * Returns TRUE (1) if sym was not yet a variable
  */
-void st_insert( char * name, int lineno, int loc );
+int st_insert( CompileCtx * ctx, int sym, int lineno, int loc );
 
 /* Function st_lookup returns the memory 
  * location of a variable or -1 if not found
  */
-int st_lookup ( char * name );
+int st_lookup ( CompileCtx * ctx, int sym );
+
+/* Procedure st_free releases the symbol table */
+void st_free( CompileCtx * ctx );
+
+/* Procedure st_reset empties the symbol table,
+ * keeping its hash table and records for the
+ * next compilation
+ */
+void st_reset( CompileCtx * ctx );
 
 /* Procedure printSymTab prints a formatted 
  * listing of the symbol table contents 
  * to the listing file
  */
-void printSymTab(FILE * listing);
+void printSymTab(CompileCtx * ctx, FILE * listing);
 
 #endif
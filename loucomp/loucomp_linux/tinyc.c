@@ -0,0 +1,102 @@
+/****************************************************/
+/* File: tinyc.c                                    */
+/* Client of the TINY compile server                */
+/* tinyc takes the same arguments as tiny and does  */
+/* the same, but has the compilation done by the    */
+/* tiny -serve listening on the socket named by the */
+/* environment variable TINYSERVER. Without one, or */
+/* with -run (which needs the terminal), it runs    */
+/* the tiny that lives next to it instead           */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#include "server.h"
+
+/* Procedure runTiny replaces tinyc by tiny with
+ * the same arguments: the tiny in the directory
+ * of tinyc if it was named with one, else the
+ * one found along PATH
+ */
+static void runTiny( char * argv[] )
+{ char * slash = strrchr(argv[0],'/');
+  char * tiny;
+  if (slash != NULL)
+  { int dirlen = slash - argv[0] + 1;
+    tiny = (char *) malloc(dirlen+5);
+    strncpy(tiny,argv[0],dirlen);
+    strcpy(tiny+dirlen,"tiny");
+  }
+  else tiny = "tiny";
+  argv[0] = tiny;
+  signal(SIGPIPE,SIG_DFL);
+  execvp(tiny,argv);
+  fprintf(stderr,"Unable to run %s\n",tiny);
+  exit(1);
+}
+
+/* Function writeOut writes the n bytes at p to
+ * file f; FALSE if they could not be written
+ */
+static int writeOut( FILE * f, const char * p, long n )
+{ return (fwrite(p,1,n,f) == (size_t) n) && (fflush(f) == 0); }
+
+int main( int argc, char * argv[] )
+{ char * path = getenv("TINYSERVER");
+  char cwd[4096];
+  char count[24];
+  char * text = NULL;
+  char * status;
+  char * outText;
+  char * errText;
+  long textLen, outLen, errLen;
+  int fd, i, sent;
+  if (path == NULL) runTiny(argv);
+  for (i=1;i<argc;i++)
+    if ((strcmp(argv[i],"-run") == 0) || (strcmp(argv[i],"-serve") == 0))
+      runTiny(argv);
+  if (getcwd(cwd,sizeof(cwd)) == NULL) runTiny(argv);
+  fd = serverConnect(path);
+  if (fd < 0) runTiny(argv);
+  /* a server that goes away is noticed in the reply */
+  signal(SIGPIPE,SIG_IGN);
+  sprintf(count,"%d",argc);
+  sent = putString(fd,cwd) && putString(fd,count);
+  for (i=0;sent && (i<argc);i++)
+  { sent = putString(fd,argv[i]);
+    /* the program on stdin goes with the first "-" */
+    if (sent && (i > 0) && (strcmp(argv[i],"-") == 0) && (text == NULL))
+    { text = readAll(0,&textLen);
+      if (text == NULL)
+      { fprintf(stderr,"Unable to read stdin\n");
+        exit(1);
+      }
+      sent = putBytes(fd,text,textLen);
+    }
+  }
+  status = sent ? getBytes(fd,NULL) : NULL;
+  outText = (status != NULL) ? getBytes(fd,&outLen) : NULL;
+  errText = (outText != NULL) ? getBytes(fd,&errLen) : NULL;
+  close(fd);
+  if (errText == NULL)
+  { /* the program on stdin cannot be read again */
+    if (text == NULL) runTiny(argv);
+    fprintf(stderr,"No reply from the server at %s\n",path);
+    exit(1);
+  }
+  if (!writeOut(stdout,outText,outLen) || !writeOut(stderr,errText,errLen))
+    exit(1);
+  return atoi(status);
+}
@@ -0,0 +1,36 @@
+/****************************************************/
+/* File: tinyrt.c                                   */
+/* Runtime for TINY programs compiled to x86-64     */
+/* or LLVM IR (see x86gen.c and llvmgen.c): the I/O */
+/* of read and write, which behaves like that of    */
+/* tiny -run                                        */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Function tinyRead reads an integer from stdin;
+ * a program that cannot read one stops
+ */
+int tinyRead(void)
+{ int value;
+  if (scanf("%d",&value) != 1)
+  { fflush(stdout);
+    fprintf(stderr,"Input Error\n");
+    exit(1);
+  }
+  return value;
+}
+
+/* Procedure tinyWrite writes an integer to stdout */
+void tinyWrite(int value)
+{ printf("%d\n",value); }
+
+/* Procedure tinyDivZero stops a program that
+ * divides by 0
+ */
+void tinyDivZero(void)
+{ fflush(stdout);
+  fprintf(stderr,"Division by 0\n");
+  exit(1);
+}
@@ -9,6 +9,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include "tmeng.h"
+#include "rewrite.h"
+#include "tmperf.h"
 
 #ifndef TRUE
 #define TRUE 1
@@ -18,87 +21,21 @@
 #endif
 
 /******* const *******/
-#define   IADDR_SIZE  1024 /* increase for large programs */
-#define   DADDR_SIZE  1024 /* increase for large programs */
-#define   NO_REGS 8
-#define   PC_REG  7
-
 #define   LINESIZE  121
 #define   WORDSIZE  20
 
-/******* type  *******/
-
-typedef enum {
-   opclRR,     /* reg operands r,s,t */
-   opclRM,     /* reg r, mem d+s */
-   opclRA      /* reg r, int d+s */
-   } OPCLASS;
-
-typedef enum {
-   /* RR instructions */
-   opHALT,    /* RR     halt, operands are ignored */
-   opIN,      /* RR     read into reg(r); s and t are ignored */
-   opOUT,     /* RR     write from reg(r), s and t are ignored */
-   opADD,    /* RR     reg(r) = reg(s)+reg(t) */
-   opSUB,    /* RR     reg(r) = reg(s)-reg(t) */
-   opMUL,    /* RR     reg(r) = reg(s)*reg(t) */
-   opDIV,    /* RR     reg(r) = reg(s)/reg(t) */
-   opRRLim,   /* limit of RR opcodes */
-
-   /* RM instructions */
-   opLD,      /* RM     reg(r) = mem(d+reg(s)) */
-   opST,      /* RM     mem(d+reg(s)) = reg(r) */
-   opRMLim,   /* Limit of RM opcodes */
-
-   /* RA instructions */
-   opLDA,     /* RA     reg(r) = d+reg(s) */
-   opLDC,     /* RA     reg(r) = d ; reg(s) is ignored */
-   opJLT,     /* RA     if reg(r)<0 then reg(7) = d+reg(s) */
-   opJLE,     /* RA     if reg(r)<=0 then reg(7) = d+reg(s) */
-   opJGT,     /* RA     if reg(r)>0 then reg(7) = d+reg(s) */
-   opJGE,     /* RA     if reg(r)>=0 then reg(7) = d+reg(s) */
-   opJEQ,     /* RA     if reg(r)==0 then reg(7) = d+reg(s) */
-   opJNE,     /* RA     if reg(r)!=0 then reg(7) = d+reg(s) */
-   opRALim    /* Limit of RA opcodes */
-   } OPCODE;
-
-typedef enum {
-   srOKAY,
-   srHALT,
-   srIMEM_ERR,
-   srDMEM_ERR,
-   srZERODIVIDE
-   } STEPRESULT;
-
-typedef struct {
-      int iop  ;
-      int iarg1  ;
-      int iarg2  ;
-      int iarg3  ;
-   } INSTRUCTION;
-
 /******** vars ********/
 int iloc = 0 ;
 int dloc = 0 ;
 int traceflag = FALSE;
 int icountflag = FALSE;
+int rewriteflag = FALSE; /* -O: apply the rewrite rules */
+int runflag = FALSE; /* -run: run to the end, without commands */
+int perfflag = FALSE; /* -perf: report the host's counters */
+int linesflag = FALSE; /* -lines: count the instructions by line */
 
-INSTRUCTION iMem [IADDR_SIZE];
-int dMem [DADDR_SIZE];
-int reg [NO_REGS];
-
-char * opCodeTab[]
-        = {"HALT","IN","OUT","ADD","SUB","MUL","DIV","????",
-            /* RR opcodes */
-           "LD","ST","????", /* RM opcodes */
-           "LDA","LDC","JLT","JLE","JGT","JGE","JEQ","JNE","????"
-           /* RA opcodes */
-          };
-
-char * stepResultTab[]
-        = {"OK","Halted","Instruction Memory Fault",
-           "Data Memory Fault","Division by 0"
-          };
+/* the machine being simulated (see tmeng.h) */
+TM * tm;
 
 char pgmName[20];
 FILE *pgm  ;
@@ -111,23 +48,16 @@ char word[WORDSIZE] ;
 char ch  ;
 int done  ;
 
-/********************************************/
-int opClass( int c )
-{ if      ( c <= opRRLim) return ( opclRR );
-  else if ( c <= opRMLim) return ( opclRM );
-  else                    return ( opclRA );
-} /* opClass */
-
 /********************************************/
 void writeInstruction ( int loc )
 { printf( "%5d: ", loc) ;
   if ( (loc >= 0) && (loc < IADDR_SIZE) )
-  { printf("%6s%3d,", opCodeTab[iMem[loc].iop], iMem[loc].iarg1);
-    switch ( opClass(iMem[loc].iop) )
-    { case opclRR: printf("%1d,%1d", iMem[loc].iarg2, iMem[loc].iarg3);
+  { printf("%6s%3d,", opCodeTab[tm->iMem[loc].iop], tm->iMem[loc].iarg1);
+    switch ( opClass(tm->iMem[loc].iop) )
+    { case opclRR: printf("%1d,%1d", tm->iMem[loc].iarg2, tm->iMem[loc].iarg3);
                    break;
       case opclRM:
-      case opclRA: printf("%3d(%1d)", iMem[loc].iarg2, iMem[loc].iarg3);
+      case opclRA: printf("%3d(%1d)", tm->iMem[loc].iarg2, tm->iMem[loc].iarg3);
                    break;
     }
     printf ("\n") ;
@@ -221,17 +151,14 @@ int error( char * msg, int lineNo, int instNo)
 int readInstructions (void)
 { OPCODE op;
   int arg1, arg2, arg3;
-  int loc, regNo, lineNo;
-  for (regNo = 0 ; regNo < NO_REGS ; regNo++)
-      reg[regNo] = 0 ;
-  dMem[0] = DADDR_SIZE - 1 ;
-  for (loc = 1 ; loc < DADDR_SIZE ; loc++)
-      dMem[loc] = 0 ;
+  int loc, lineNo;
+  int first, last, srcLine;
+  tmReset(tm) ;
   for (loc = 0 ; loc < IADDR_SIZE ; loc++)
-  { iMem[loc].iop = opHALT ;
-    iMem[loc].iarg1 = 0 ;
-    iMem[loc].iarg2 = 0 ;
-    iMem[loc].iarg3 = 0 ;
+  { tm->iMem[loc].iop = opHALT ;
+    tm->iMem[loc].iarg1 = 0 ;
+    tm->iMem[loc].iarg2 = 0 ;
+    tm->iMem[loc].iarg3 = 0 ;
   }
   lineNo = 0 ;
   while (! feof(pgm))
@@ -241,11 +168,17 @@ int readInstructions (void)
     lineLen = strlen(in_Line)-1 ;
     if (in_Line[lineLen]=='\n') in_Line[lineLen] = '\0' ;
     else in_Line[++lineLen] = '\0';
-    if ( (nonBlank()) && (in_Line[inCol] != '*') )
+    /* the source lines of the code, as comments */
+    if (sscanf(in_Line," * loc %d-%d: line %d",&first,&last,&srcLine) == 3)
+    { for (loc = first ; loc <= last ; loc++)
+        if (! tmSetLine(tm,loc,srcLine))
+          return error("Bad source line location",lineNo,loc);
+    }
+    else if ( (nonBlank()) && (in_Line[inCol] != '*') )
     { if (! getNum())
         return error("Bad location", lineNo,-1);
       loc = num;
-      if (loc > IADDR_SIZE)
+      if (loc >= IADDR_SIZE)
         return error("Location too large",lineNo,loc);
       if (! skipCh(':'))
         return error("Missing colon", lineNo,loc);
@@ -293,10 +226,10 @@ int readInstructions (void)
         arg3 = num;
         break;
         }
-      iMem[loc].iop = op;
-      iMem[loc].iarg1 = arg1;
-      iMem[loc].iarg2 = arg2;
-      iMem[loc].iarg3 = arg3;
+      tm->iMem[loc].iop = op;
+      tm->iMem[loc].iarg1 = arg1;
+      tm->iMem[loc].iarg2 = arg2;
+      tm->iMem[loc].iarg3 = arg3;
     }
   }
   return TRUE;
@@ -304,96 +237,39 @@ int readInstructions (void)
 
 
 /********************************************/
-STEPRESULT stepTM (void)
-{ INSTRUCTION currentinstruction  ;
-  int pc  ;
-  int r,s,t,m  ;
-  int ok ;
-
-  pc = reg[PC_REG] ;
-  if ( (pc < 0) || (pc > IADDR_SIZE)  )
-      return srIMEM_ERR ;
-  reg[PC_REG] = pc + 1 ;
-  currentinstruction = iMem[ pc ] ;
-  switch (opClass(currentinstruction.iop) )
-  { case opclRR :
-    /***********************************/
-      r = currentinstruction.iarg1 ;
-      s = currentinstruction.iarg2 ;
-      t = currentinstruction.iarg3 ;
-      break;
-
-    case opclRM :
-    /***********************************/
-      r = currentinstruction.iarg1 ;
-      s = currentinstruction.iarg3 ;
-      m = currentinstruction.iarg2 + reg[s] ;
-      if ( (m < 0) || (m > DADDR_SIZE))
-         return srDMEM_ERR ;
-      break;
-
-    case opclRA :
-    /***********************************/
-      r = currentinstruction.iarg1 ;
-      s = currentinstruction.iarg3 ;
-      m = currentinstruction.iarg2 + reg[s] ;
-      break;
-  } /* case */
-
-  switch ( currentinstruction.iop)
-  { /* RR instructions */
-    case opHALT :
-    /***********************************/
-      printf("HALT: %1d,%1d,%1d\n",r,s,t);
-      return srHALT ;
-      /* break; */
-
-    case opIN :
-    /***********************************/
-      do
-      { printf("Enter value for IN instruction: ") ;
-        fflush (stdin);
-        fflush (stdout);
-        gets(in_Line);
-        lineLen = strlen(in_Line) ;
-        inCol = 0;
-        ok = getNum();
-        if ( ! ok ) printf ("Illegal value\n");
-        else reg[r] = num;
-      }
-      while (! ok);
-      break;
-
-    case opOUT :  
-      printf ("OUT instruction prints: %d\n", reg[r] ) ;
-      break;
-    case opADD :  reg[r] = reg[s] + reg[t] ;  break;
-    case opSUB :  reg[r] = reg[s] - reg[t] ;  break;
-    case opMUL :  reg[r] = reg[s] * reg[t] ;  break;
+/* IN prompts for a value until it gets one */
+int tmInput ( TM * tm, int * value )
+{ int ok;
+  do
+  { printf("Enter value for IN instruction: ") ;
+    fflush (stdin);
+    fflush (stdout);
+    gets(in_Line);
+    lineLen = strlen(in_Line) ;
+    inCol = 0;
+    ok = getNum();
+    if ( ! ok ) printf ("Illegal value\n");
+    else *value = num;
+  }
+  while (! ok);
+  return TRUE;
+} /* tmInput */
 
-    case opDIV :
-    /***********************************/
-      if ( reg[t] != 0 ) reg[r] = reg[s] / reg[t];
-      else return srZERODIVIDE ;
-      break;
+/********************************************/
+void tmOutput ( TM * tm, int value )
+{ printf ("OUT instruction prints: %d\n", value ) ;
+} /* tmOutput */
 
-    /*************** RM instructions ********************/
-    case opLD :    reg[r] = dMem[m] ;  break;
-    case opST :    dMem[m] = reg[r] ;  break;
-
-    /*************** RA instructions ********************/
-    case opLDA :    reg[r] = m ; break;
-    case opLDC :    reg[r] = currentinstruction.iarg2 ;   break;
-    case opJLT :    if ( reg[r] <  0 ) reg[PC_REG] = m ; break;
-    case opJLE :    if ( reg[r] <=  0 ) reg[PC_REG] = m ; break;
-    case opJGT :    if ( reg[r] >  0 ) reg[PC_REG] = m ; break;
-    case opJGE :    if ( reg[r] >=  0 ) reg[PC_REG] = m ; break;
-    case opJEQ :    if ( reg[r] == 0 ) reg[PC_REG] = m ; break;
-    case opJNE :    if ( reg[r] != 0 ) reg[PC_REG] = m ; break;
-
-    /* end of legal instructions */
-  } /* case */
-  return srOKAY ;
+/********************************************/
+/* stepTM executes one instruction, reporting
+   a HALT as the simulator always has */
+STEPRESULT stepTM (void)
+{ int pc = tm->reg[PC_REG] ;
+  STEPRESULT result = tmStep(tm) ;
+  if (result == srHALT)
+    printf("HALT: %1d,%1d,%1d\n",tm->iMem[pc].iarg1,
+           tm->iMem[pc].iarg2,tm->iMem[pc].iarg3);
+  return result ;
 } /* stepTM */
 
 /********************************************/
@@ -402,7 +278,6 @@ int doCommand (void)
   int stepcnt=0, i;
   int printcnt;
   int stepResult;
-  int regNo, loc;
   do
   { printf ("Enter command: ");
     fflush (stdin);
@@ -440,6 +315,9 @@ int doCommand (void)
       printf("   p(rint         "\
              "Toggle print of total instructions executed"\
              " ('go' only)\n");
+      printf("   l(ines         "\
+             "Print the instructions executed for each"\
+             " source line (-lines)\n");
       printf("   c(lear         "\
              "Reset simulator for new execution of program\n");
       printf("   h(elp          "\
@@ -467,7 +345,7 @@ int doCommand (void)
     case 'r' :
     /***********************************/
       for (i = 0; i < NO_REGS; i++)
-      { printf("%1d: %4d    ", i,reg[i]);
+      { printf("%1d: %4d    ", i,tm->reg[i]);
         if ( (i % 4) == 3 ) printf ("\n");
       }
       break;
@@ -503,23 +381,25 @@ int doCommand (void)
       else
       { while ((dloc >= 0) && (dloc < DADDR_SIZE)
                   && (printcnt > 0))
-        { printf("%5d: %5d\n",dloc,dMem[dloc]);
+        { printf("%5d: %5d\n",dloc,tm->dMem[dloc]);
           dloc++;
           printcnt--;
         }
       }
       break;
 
+    case 'l' :
+    /***********************************/
+      if ( linesflag ) tmLineReport(tm,stdout);
+      else printf("Lines are counted only with -lines\n");
+      break;
+
     case 'c' :
     /***********************************/
       iloc = 0;
       dloc = 0;
       stepcnt = 0;
-      for (regNo = 0;  regNo < NO_REGS ; regNo++)
-            reg[regNo] = 0 ;
-      dMem[0] = DADDR_SIZE - 1 ;
-      for (loc = 1 ; loc < DADDR_SIZE ; loc++)
-            dMem[loc] = 0 ;
+      tmReset(tm) ;
       break;
 
     case 'q' : return FALSE;  /* break; */
@@ -531,7 +411,7 @@ int doCommand (void)
   { if ( cmd == 'g' )
     { stepcnt = 0;
       while (stepResult == srOKAY)
-      { iloc = reg[PC_REG] ;
+      { iloc = tm->reg[PC_REG] ;
         if ( traceflag ) writeInstruction( iloc ) ;
         stepResult = stepTM ();
         stepcnt++;
@@ -541,7 +421,7 @@ int doCommand (void)
     }
     else
     { while ((stepcnt > 0) && (stepResult == srOKAY))
-      { iloc = reg[PC_REG] ;
+      { iloc = tm->reg[PC_REG] ;
         if ( traceflag ) writeInstruction( iloc ) ;
         stepResult = stepTM ();
         stepcnt-- ;
@@ -553,13 +433,45 @@ int doCommand (void)
 } /* doCommand */
 
 
+/********************************************/
+/* runProgram runs the program to the end, IN
+   reading stdin and OUT writing stdout, and
+   reports a fault on stderr; with -lines, also
+   the instructions run for each source line, and
+   with -perf the host's counters over the run */
+int runProgram (void)
+{ TMPERF perf;
+  STEPRESULT result;
+  long steps;
+  if ( perfflag ) tmPerfStart(&perf);
+  result = tmRun(tm,&steps);
+  if ( perfflag ) tmPerfStop(&perf);
+  fflush(stdout);
+  if ( result != srHALT )
+    fprintf(stderr,"%s at location %d\n",stepResultTab[result],
+            tm->reg[PC_REG]-1);
+  if ( linesflag ) tmLineReport(tm,stderr);
+  if ( perfflag ) tmPerfReport(&perf,steps,stderr);
+  return result == srHALT;
+} /* runProgram */
+
 /********************************************/
 /* E X E C U T I O N   B E G I N S   H E R E */
 /********************************************/
 
 main( int argc, char * argv[] )
-{ if (argc != 2)
-  { printf("usage: %s <filename>\n",argv[0]);
+{ char * name = argv[0];
+  while (argc > 2)
+  { if (strcmp(argv[1],"-O") == 0) rewriteflag = TRUE;
+    else if (strcmp(argv[1],"-run") == 0) runflag = TRUE;
+    else if (strcmp(argv[1],"-perf") == 0) perfflag = TRUE;
+    else if (strcmp(argv[1],"-lines") == 0) linesflag = TRUE;
+    else break;
+    argv++;
+    argc--;
+  }
+  if ((argc != 2) || (perfflag && ! runflag))
+  { printf("usage: %s [-O] [-lines] [-run [-perf]] <filename>\n",name);
     exit(1);
   }
   strcpy(pgmName,argv[1]) ;
@@ -571,9 +483,32 @@ main( int argc, char * argv[] )
     exit(1);
   }
 
+  tm = tmNew(IADDR_SIZE);
+  if (tm == NULL)
+  { printf("out of memory\n");
+    exit(1);
+  }
+  /* -run keeps the plain I/O of tmNew */
+  if (! runflag)
+  { tm->input = tmInput;
+    tm->output = tmOutput;
+  }
+  /* count the instructions executed, for l(ines)
+     or the report of -run; nothing else is */
+  if (linesflag && ! tmProfile(tm))
+  { printf("out of memory\n");
+    exit(1);
+  }
+
   /* read the program */
   if ( ! readInstructions ())
          exit(1) ;
+  /* shorten it (see rewrite.h) */
+  if (rewriteflag)
+    fprintf(runflag ? stderr : stdout,
+            "Rewrote %d instruction sequences\n",tmRewrite(tm));
+  if (runflag)
+    return runProgram() ? 0 : 1;
   /* switch input file to terminal */
   /* reset( input ); */
   /* read-eval-print */
@@ -0,0 +1,324 @@
+/****************************************************/
+/* File: tmeng.c                                    */
+/* The TM ("Tiny Machine") engine                   */
+/* Compiler Construction: Principles and Practice   */
+/* Kenneth C. Louden                                */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tmeng.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+char * opCodeTab[]
+        = {"HALT","IN","OUT","ADD","SUB","MUL","DIV","????",
+            /* RR opcodes */
+           "LD","ST","????", /* RM opcodes */
+           "LDA","LDC","JLT","JLE","JGT","JGE","JEQ","JNE","????"
+           /* RA opcodes */
+          };
+
+char * stepResultTab[]
+        = {"OK","Halted","Instruction Memory Fault",
+           "Data Memory Fault","Division by 0","Input Error"
+          };
+
+/********************************************/
+int opClass( int c )
+{ if      ( c <= opRRLim) return ( opclRR );
+  else if ( c <= opRMLim) return ( opclRM );
+  else                    return ( opclRA );
+} /* opClass */
+
+/********************************************/
+int tmOpcode( const char * name )
+{ int op;
+  for (op = opHALT ; op < opRALim ; op++)
+    if ((op != opRRLim) && (op != opRMLim)
+        && (strncmp(opCodeTab[op], name, 4) == 0))
+      return op;
+  return -1;
+} /* tmOpcode */
+
+/* the I/O of a new machine: IN reads an
+   integer from stdin, OUT writes one line
+   to stdout */
+static int stdInput( TM * tm, int * value )
+{ return scanf("%d",value) == 1; }
+
+static void stdOutput( TM * tm, int value )
+{ printf("%d\n",value); }
+
+/********************************************/
+TM * tmNew( int isize )
+{ TM * tm = (TM *) malloc(sizeof(TM));
+  if (tm == NULL) return NULL;
+  /* all zeroes is HALT 0,0,0 */
+  tm->iMem = (INSTRUCTION *) calloc(isize,sizeof(INSTRUCTION));
+  if (tm->iMem == NULL)
+  { free(tm);
+    return NULL;
+  }
+  tm->isize = isize;
+  tm->input = stdInput;
+  tm->output = stdOutput;
+  tm->profile = NULL;
+  tm->srcLine = NULL;
+  tm->user = NULL;
+  tmReset(tm);
+  return tm;
+} /* tmNew */
+
+/********************************************/
+void tmFree( TM * tm )
+{ if (tm->profile != NULL) tmFreeProfile(tm->profile);
+  free(tm->srcLine);
+  free(tm->iMem);
+  free(tm);
+} /* tmFree */
+
+/********************************************/
+void tmReset( TM * tm )
+{ int regNo, loc;
+  for (regNo = 0 ; regNo < NO_REGS ; regNo++)
+      tm->reg[regNo] = 0 ;
+  tm->dMem[0] = DADDR_SIZE - 1 ;
+  for (loc = 1 ; loc < DADDR_SIZE ; loc++)
+      tm->dMem[loc] = 0 ;
+  if (tm->profile != NULL)
+  { memset(tm->profile->counts,0,tm->profile->size*sizeof(long));
+    memset(tm->profile->taken,0,tm->profile->size*sizeof(long));
+  }
+} /* tmReset */
+
+/********************************************/
+STEPRESULT tmStep( TM * tm )
+{ INSTRUCTION currentinstruction  ;
+  int * reg = tm->reg ;
+  int pc  ;
+  int r,s,t,m  ;
+
+  pc = reg[PC_REG] ;
+  if ( (pc < 0) || (pc >= tm->isize)  )
+      return srIMEM_ERR ;
+  reg[PC_REG] = pc + 1 ;
+  if (tm->profile != NULL) tm->profile->counts[pc]++ ;
+  currentinstruction = tm->iMem[ pc ] ;
+  switch (opClass(currentinstruction.iop) )
+  { case opclRR :
+    /***********************************/
+      r = currentinstruction.iarg1 ;
+      s = currentinstruction.iarg2 ;
+      t = currentinstruction.iarg3 ;
+      break;
+
+    case opclRM :
+    /***********************************/
+      r = currentinstruction.iarg1 ;
+      s = currentinstruction.iarg3 ;
+      m = currentinstruction.iarg2 + reg[s] ;
+      if ( (m < 0) || (m >= DADDR_SIZE))
+         return srDMEM_ERR ;
+      break;
+
+    case opclRA :
+    /***********************************/
+      r = currentinstruction.iarg1 ;
+      s = currentinstruction.iarg3 ;
+      m = currentinstruction.iarg2 + reg[s] ;
+      break;
+  } /* case */
+
+  switch ( currentinstruction.iop)
+  { /* RR instructions */
+    case opHALT :
+    /***********************************/
+      return srHALT ;
+      /* break; */
+
+    case opIN :
+    /***********************************/
+      if (! tm->input(tm,&reg[r]))
+        return srIN_ERR ;
+      break;
+
+    case opOUT :
+      tm->output(tm,reg[r]);
+      break;
+    case opADD :  reg[r] = reg[s] + reg[t] ;  break;
+    case opSUB :  reg[r] = reg[s] - reg[t] ;  break;
+    case opMUL :  reg[r] = reg[s] * reg[t] ;  break;
+
+    case opDIV :
+    /***********************************/
+      if ( reg[t] != 0 ) reg[r] = reg[s] / reg[t];
+      else return srZERODIVIDE ;
+      break;
+
+    /*************** RM instructions ********************/
+    case opLD :    reg[r] = tm->dMem[m] ;  break;
+    case opST :    tm->dMem[m] = reg[r] ;  break;
+
+    /*************** RA instructions ********************/
+    case opLDA :    reg[r] = m ; break;
+    case opLDC :    reg[r] = currentinstruction.iarg2 ;   break;
+    case opJLT :    if ( reg[r] <  0 ) reg[PC_REG] = m ; break;
+    case opJLE :    if ( reg[r] <=  0 ) reg[PC_REG] = m ; break;
+    case opJGT :    if ( reg[r] >  0 ) reg[PC_REG] = m ; break;
+    case opJGE :    if ( reg[r] >=  0 ) reg[PC_REG] = m ; break;
+    case opJEQ :    if ( reg[r] == 0 ) reg[PC_REG] = m ; break;
+    case opJNE :    if ( reg[r] != 0 ) reg[PC_REG] = m ; break;
+
+    /* end of legal instructions */
+  } /* case */
+  if ((tm->profile != NULL) && (reg[PC_REG] != pc + 1))
+    tm->profile->taken[pc]++ ;
+  return srOKAY ;
+} /* tmStep */
+
+/********************************************/
+STEPRESULT tmRun( TM * tm, long * steps )
+{ STEPRESULT result;
+  long n = 0;
+  do
+  { result = tmStep(tm);
+    n++;
+  } while (result == srOKAY);
+  if (steps != NULL) *steps = n;
+  return result;
+} /* tmRun */
+
+/********************************************/
+TMPROFILE * tmNewProfile( int size )
+{ TMPROFILE * p = (TMPROFILE *) malloc(sizeof(TMPROFILE));
+  if (p == NULL) return NULL;
+  p->size = size;
+  p->counts = (long *) calloc(size,sizeof(long));
+  p->taken = (long *) calloc(size,sizeof(long));
+  if ((p->counts == NULL) || (p->taken == NULL))
+  { tmFreeProfile(p);
+    return NULL;
+  }
+  return p;
+} /* tmNewProfile */
+
+/********************************************/
+void tmFreeProfile( TMPROFILE * p )
+{ free(p->counts);
+  free(p->taken);
+  free(p);
+} /* tmFreeProfile */
+
+/********************************************/
+int tmProfile( TM * tm )
+{ if (tm->profile == NULL)
+    tm->profile = tmNewProfile(tm->isize);
+  return tm->profile != NULL;
+} /* tmProfile */
+
+/********************************************/
+void tmWriteProfile( TMPROFILE * p, FILE * f )
+{ int loc;
+  fprintf(f,"TMPROFILE %d\n",p->size);
+  for (loc = 0 ; loc < p->size ; loc++)
+    if (p->counts[loc] != 0)
+      fprintf(f,"%d %ld %ld\n",loc,p->counts[loc],p->taken[loc]);
+} /* tmWriteProfile */
+
+/********************************************/
+TMPROFILE * tmReadProfile( FILE * f )
+{ TMPROFILE * p;
+  int size, loc;
+  long runs, jumps;
+  if ((fscanf(f," TMPROFILE %d",&size) != 1) || (size <= 0))
+    return NULL;
+  p = tmNewProfile(size);
+  if (p == NULL) return NULL;
+  while (fscanf(f,"%d %ld %ld",&loc,&runs,&jumps) == 3)
+    if ((loc >= 0) && (loc < size))
+    { p->counts[loc] = runs;
+      p->taken[loc] = jumps;
+    }
+  if (!feof(f))
+  { tmFreeProfile(p);
+    return NULL;
+  }
+  return p;
+} /* tmReadProfile */
+
+/********************************************/
+int tmSetLine( TM * tm, int loc, int line )
+{ if ((loc < 0) || (loc >= tm->isize)) return FALSE;
+  if (tm->srcLine == NULL)
+  { tm->srcLine = (int *) calloc(tm->isize,sizeof(int));
+    if (tm->srcLine == NULL) return FALSE;
+  }
+  tm->srcLine[loc] = line;
+  return TRUE;
+} /* tmSetLine */
+
+/* a line of the report of tmLineReport */
+typedef struct
+   { int line;
+     long runs;
+     int locs; /* locations that ran */
+   } LINEROW;
+
+static int hotter( const void * a, const void * b )
+{ const LINEROW * x = (const LINEROW *) a;
+  const LINEROW * y = (const LINEROW *) b;
+  if (x->runs != y->runs) return (x->runs < y->runs) ? 1 : -1;
+  return x->line - y->line;
+}
+
+/********************************************/
+void tmLineReport( TM * tm, FILE * f )
+{ TMPROFILE * p = tm->profile;
+  LINEROW * rows;
+  long total = 0;
+  int maxLine = 0, n = 0;
+  int loc, line, size;
+  if ((p == NULL) || (tm->srcLine == NULL))
+  { fprintf(f,"No source lines to report on\n");
+    return;
+  }
+  size = (p->size < tm->isize) ? p->size : tm->isize;
+  for (loc = 0 ; loc < size ; loc++)
+    if (tm->srcLine[loc] > maxLine) maxLine = tm->srcLine[loc];
+  rows = (LINEROW *) calloc(maxLine+1,sizeof(LINEROW));
+  if (rows == NULL)
+  { fprintf(f,"Out of memory reporting source lines\n");
+    return;
+  }
+  /* rows[0] is the code of no source line */
+  for (loc = 0 ; loc < size ; loc++)
+  { line = tm->srcLine[loc];
+    if (line < 0) line = 0;
+    rows[line].runs += p->counts[loc];
+    if (p->counts[loc] > 0) rows[line].locs++;
+    total += p->counts[loc];
+  }
+  for (line = 0 ; line <= maxLine ; line++)
+    if (rows[line].runs > 0)
+    { rows[n] = rows[line];
+      rows[n].line = line;
+      n++;
+    }
+  qsort(rows,n,sizeof(LINEROW),hotter);
+  fprintf(f,"Instructions run by source line (%ld in all):\n",total);
+  fprintf(f,"%8s %12s %7s %6s\n","line","runs","%","locs");
+  for (loc = 0 ; loc < n ; loc++)
+  { if (rows[loc].line == 0) fprintf(f,"%8s","(none)");
+    else fprintf(f,"%8d",rows[loc].line);
+    fprintf(f," %12ld %6.1f%% %6d\n",rows[loc].runs,
+            100.0*rows[loc].runs/total,rows[loc].locs);
+  }
+  free(rows);
+} /* tmLineReport */
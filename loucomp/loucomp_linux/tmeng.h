@@ -0,0 +1,185 @@
+/****************************************************/
+/* File: tmeng.h                                    */
+/* The TM ("Tiny Machine") engine: the machine      */
+/* state and the execution of instructions, shared  */
+/* by the TM simulator and by tiny -run             */
+/* Compiler Construction: Principles and Practice   */
+/* Kenneth C. Louden                                */
+/****************************************************/
+
+#ifndef _TMENG_H_
+#define _TMENG_H_
+
+/******* const *******/
+#define   IADDR_SIZE  1024 /* increase for large programs */
+#define   DADDR_SIZE  1024 /* increase for large programs */
+#define   NO_REGS 8
+#define   PC_REG  7
+
+/******* type  *******/
+
+typedef enum {
+   opclRR,     /* reg operands r,s,t */
+   opclRM,     /* reg r, mem d+s */
+   opclRA      /* reg r, int d+s */
+   } OPCLASS;
+
+typedef enum {
+   /* RR instructions */
+   opHALT,    /* RR     halt, operands are ignored */
+   opIN,      /* RR     read into reg(r); s and t are ignored */
+   opOUT,     /* RR     write from reg(r), s and t are ignored */
+   opADD,    /* RR     reg(r) = reg(s)+reg(t) */
+   opSUB,    /* RR     reg(r) = reg(s)-reg(t) */
+   opMUL,    /* RR     reg(r) = reg(s)*reg(t) */
+   opDIV,    /* RR     reg(r) = reg(s)/reg(t) */
+   opRRLim,   /* limit of RR opcodes */
+
+   /* RM instructions */
+   opLD,      /* RM     reg(r) = mem(d+reg(s)) */
+   opST,      /* RM     mem(d+reg(s)) = reg(r) */
+   opRMLim,   /* Limit of RM opcodes */
+
+   /* RA instructions */
+   opLDA,     /* RA     reg(r) = d+reg(s) */
+   opLDC,     /* RA     reg(r) = d ; reg(s) is ignored */
+   opJLT,     /* RA     if reg(r)<0 then reg(7) = d+reg(s) */
+   opJLE,     /* RA     if reg(r)<=0 then reg(7) = d+reg(s) */
+   opJGT,     /* RA     if reg(r)>0 then reg(7) = d+reg(s) */
+   opJGE,     /* RA     if reg(r)>=0 then reg(7) = d+reg(s) */
+   opJEQ,     /* RA     if reg(r)==0 then reg(7) = d+reg(s) */
+   opJNE,     /* RA     if reg(r)!=0 then reg(7) = d+reg(s) */
+   opRALim    /* Limit of RA opcodes */
+   } OPCODE;
+
+typedef enum {
+   srOKAY,
+   srHALT,
+   srIMEM_ERR,
+   srDMEM_ERR,
+   srZERODIVIDE,
+   srIN_ERR
+   } STEPRESULT;
+
+typedef struct instruction {
+      int iop  ;
+      int iarg1  ;
+      int iarg2  ;
+      int iarg3  ;
+   } INSTRUCTION;
+
+/* the execution profile of a program: how many
+ * times the instruction at each of its size
+ * locations ran, and how many of those times it
+ * jumped (set the pc to other than the next
+ * location)
+ */
+typedef struct tmprofile
+   { int size;
+     long * counts;
+     long * taken;
+   } TMPROFILE;
+
+/* the state of one machine: its instruction
+ * memory (isize slots), data memory and
+ * registers. IN and OUT go through input and
+ * output, so that each user of the engine can
+ * do its own I/O, with user for its own state;
+ * input returns FALSE if no value could be read
+ */
+typedef struct tmachine
+   { INSTRUCTION * iMem;
+     int isize;
+     int dMem [DADDR_SIZE];
+     int reg [NO_REGS];
+     int (* input) (struct tmachine *, int *);
+     void (* output) (struct tmachine *, int);
+     TMPROFILE * profile; /* counts kept as it runs, or NULL */
+     int * srcLine; /* source line of each location (0 if
+                       none), or NULL */
+     void * user; /* for input and output, or NULL */
+   } TM;
+
+/* the names of the opcodes and of the results
+ * of a step, indexed by OPCODE and STEPRESULT
+ */
+extern char * opCodeTab[];
+extern char * stepResultTab[];
+
+/* Function opClass returns the class of opcode c */
+int opClass( int c );
+
+/* Function tmOpcode returns the opcode named
+ * name, or -1 if there is none
+ */
+int tmOpcode( const char * name );
+
+/* Function tmNew returns a machine with isize
+ * instruction slots, all holding HALT 0,0,0,
+ * and I/O through stdin and stdout; NULL if
+ * out of memory
+ */
+TM * tmNew( int isize );
+
+/* Procedure tmFree releases machine tm */
+void tmFree( TM * tm );
+
+/* Procedure tmReset clears the registers and
+ * the data memory of tm, except for location 0,
+ * which holds the highest data address, and the
+ * counts of its profile
+ */
+void tmReset( TM * tm );
+
+/* Function tmStep executes one instruction */
+STEPRESULT tmStep( TM * tm );
+
+/* Function tmRun executes instructions until
+ * one does not return srOKAY, and returns that
+ * result; *steps is set to the number of
+ * instructions executed, unless steps is NULL
+ */
+STEPRESULT tmRun( TM * tm, long * steps );
+
+/* Function tmProfile makes tm count, from now
+ * on, the runs and jumps of each instruction
+ * into tm->profile; FALSE if out of memory
+ */
+int tmProfile( TM * tm );
+
+/* Function tmSetLine notes that the code at
+ * location loc of tm was made for source line
+ * line; FALSE if loc is out of range or out of
+ * memory
+ */
+int tmSetLine( TM * tm, int loc, int line );
+
+/* Procedure tmLineReport writes to f how many
+ * instructions ran for each source line, from
+ * the profile and the source lines of tm,
+ * hottest line first
+ */
+void tmLineReport( TM * tm, FILE * f );
+
+/* Function tmNewProfile returns an empty profile
+ * of size locations; NULL if out of memory
+ */
+TMPROFILE * tmNewProfile( int size );
+
+/* Procedure tmFreeProfile releases profile p */
+void tmFreeProfile( TMPROFILE * p );
+
+/* Procedure tmWriteProfile writes profile p to
+ * f, as a "TMPROFILE" line and then one
+ * "location runs jumps" line for each location
+ * that ran
+ */
+void tmWriteProfile( TMPROFILE * p, FILE * f );
+
+/* Function tmReadProfile reads a profile written
+ * by tmWriteProfile from f; NULL if f does not
+ * hold one or out of memory
+ */
+TMPROFILE * tmReadProfile( FILE * f );
+
+#endif
@@ -0,0 +1,388 @@
+/****************************************************/
+/* File: tmjit.c                                    */
+/* The trace compiler of the TM engine (see         */
+/* tmjit.h)                                         */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "tmeng.h"
+#include "tmjit.h"
+
+#if defined(__x86_64__)
+#include <sys/mman.h>
+#define CANJIT 1
+#else
+#define CANJIT 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#if CANJIT
+
+/* CODESIZE is the bytes of native code there is
+   room for in one run */
+#define CODESIZE (1 << 20)
+
+/* a trace: it runs from the location it was
+   recorded at until an exit, adding to *steps the
+   instructions it ran, and returns srOKAY with the
+   pc where the interpreter goes on, or the result
+   of an IN that failed */
+typedef STEPRESULT (* TRACE) (TM *, long *);
+
+/* the state of tmJitRun */
+typedef struct
+   { TM * tm;
+     int * hits; /* backward jumps taken to each location */
+     TRACE * trace; /* the trace at each location, or NULL */
+     unsigned char * code; /* CODESIZE bytes */
+     int used; /* bytes of code written */
+     int full; /* TRUE when no more traces are made */
+   } JIT;
+
+/* the native code of a trace being compiled: n
+   bytes of buf, which has room for max */
+typedef struct
+   { unsigned char * buf;
+     int n, max;
+   } EMIT;
+
+/* an exit of a trace being compiled: the rel32 of
+   its jump at byte patch goes to code that stores
+   resume into the pc, adds steps to the count and
+   returns result */
+typedef struct
+   { int patch;
+     int resume;
+     int steps;
+     STEPRESULT result;
+   } EXIT;
+
+/* the host registers used; the trace keeps tm in
+   rbx and steps in r12, and the TM registers in
+   tm->reg */
+#define EAX 0
+#define ECX 1
+#define ESI 6
+
+/* the offsets in a TM of its parts */
+#define REGOFF(r) ((int) (offsetof(TM,reg) + (r)*sizeof(int)))
+#define DMEMOFF ((int) offsetof(TM,dMem))
+#define INPUTOFF ((int) offsetof(TM,input))
+#define OUTPUTOFF ((int) offsetof(TM,output))
+
+/* the condition codes of the x86 jumps: the jump
+   on the opposite condition is cc^1 */
+#define CCEQ 0x4
+#define CCNE 0x5
+#define CCLT 0xC
+#define CCGE 0xD
+#define CCLE 0xE
+#define CCGT 0xF
+
+static void byte( EMIT * e, int b )
+{ if (e->n < e->max) e->buf[e->n] = (unsigned char) b;
+  e->n++;
+}
+
+static void word( EMIT * e, int w )
+{ byte(e,w);
+  byte(e,w >> 8);
+  byte(e,w >> 16);
+  byte(e,w >> 24);
+}
+
+/* patch sets the rel32 at byte at to jump to
+   byte to */
+static void patch( EMIT * e, int at, int to )
+{ int rel = to - (at+4), k;
+  if (at+4 > e->max) return;
+  for (k = 0; k < 4; k++) e->buf[at+k] = (unsigned char) (rel >> (8*k));
+}
+
+/* loadReg loads TM register r into host register
+   h, at location pc, where the pc reads as pc+1 */
+static void loadReg( EMIT * e, int h, int r, int pc )
+{ if (r == PC_REG)
+  { byte(e,0xB8+h); /* mov h,pc+1 */
+    word(e,pc+1);
+  }
+  else
+  { byte(e,0x8B); /* mov h,[rbx+reg r] */
+    byte(e,0x80 | (h << 3) | 3);
+    word(e,REGOFF(r));
+  }
+}
+
+/* storeReg stores host register h into TM
+   register r */
+static void storeReg( EMIT * e, int h, int r )
+{ byte(e,0x89); /* mov [rbx+reg r],h */
+  byte(e,0x80 | (h << 3) | 3);
+  word(e,REGOFF(r));
+}
+
+/* guard jumps on condition cc to a new exit */
+static void guard( EMIT * e, int cc, EXIT * x, int resume, int steps,
+                   STEPRESULT result )
+{ byte(e,0x0F); /* jcc rel32 */
+  byte(e,0x80 | cc);
+  x->patch = e->n;
+  x->resume = resume;
+  x->steps = steps;
+  x->result = result;
+  word(e,0);
+}
+
+/* call calls the function at offset off of tm,
+   with tm as its first argument */
+static void call( EMIT * e, int off )
+{ byte(e,0x48); byte(e,0x89); byte(e,0xDF); /* mov rdi,rbx */
+  byte(e,0xFF); byte(e,0x93); /* call [rbx+off] */
+  word(e,off);
+}
+
+/* Function traceable is FALSE if the instruction
+ * at pc cannot be in a trace: a HALT, or one that
+ * computes the pc
+ */
+static int traceable( TM * tm, int pc )
+{ INSTRUCTION * i;
+  if ((pc < 0) || (pc >= tm->isize)) return FALSE;
+  i = &tm->iMem[pc];
+  switch (i->iop)
+  { case opHALT: return FALSE;
+    case opOUT: case opST: case opLDC: return TRUE;
+    case opLDA: return (i->iarg1 != PC_REG) || (i->iarg3 == PC_REG);
+    case opIN: case opADD: case opSUB: case opMUL: case opDIV:
+    case opLD:
+      return i->iarg1 != PC_REG;
+    default: /* the conditional jumps */
+      return i->iarg3 == PC_REG;
+  }
+}
+
+/* Function compile compiles the n instructions
+ * that ran from location rec[0] until it ran
+ * again, as a trace that loops until one of them
+ * goes another way; FALSE if there is no room
+ * for it
+ */
+static int compile( JIT * jit, int * rec, int n )
+{ EXIT exit[TRACEMAX];
+  EMIT e;
+  int nexit = 0, loop, epilogue, k, cc;
+  if (mprotect(jit->code,CODESIZE,PROT_READ | PROT_WRITE) != 0)
+    return FALSE;
+  e.buf = jit->code + jit->used;
+  e.n = 0;
+  e.max = CODESIZE - jit->used;
+  byte(&e,0x53); /* push rbx */
+  byte(&e,0x41); byte(&e,0x54); /* push r12 */
+  byte(&e,0x55); /* push rbp, to align the stack */
+  byte(&e,0x48); byte(&e,0x89); byte(&e,0xFB); /* mov rbx,rdi */
+  byte(&e,0x49); byte(&e,0x89); byte(&e,0xF4); /* mov r12,rsi */
+  loop = e.n;
+  for (k = 0; k < n; k++)
+  { int pc = rec[k];
+    int next = (k+1 < n) ? rec[k+1] : rec[0];
+    INSTRUCTION * i = &jit->tm->iMem[pc];
+    int r = i->iarg1, s = i->iarg2, t = i->iarg3, d = i->iarg2;
+    switch (i->iop)
+    { case opIN:
+        byte(&e,0x48); byte(&e,0x8D); byte(&e,0xB3); /* lea rsi,[rbx+reg r] */
+        word(&e,REGOFF(r));
+        call(&e,INPUTOFF);
+        byte(&e,0x85); byte(&e,0xC0); /* test eax,eax */
+        guard(&e,CCEQ,&exit[nexit++],pc+1,k+1,srIN_ERR);
+        break;
+      case opOUT:
+        loadReg(&e,EAX,r,pc);
+        byte(&e,0x89); byte(&e,0xC6); /* mov esi,eax */
+        call(&e,OUTPUTOFF);
+        break;
+      case opADD:
+      case opSUB:
+      case opMUL:
+        loadReg(&e,EAX,s,pc);
+        loadReg(&e,ECX,t,pc);
+        if (i->iop == opADD)
+        { byte(&e,0x01); byte(&e,0xC8); } /* add eax,ecx */
+        else if (i->iop == opSUB)
+        { byte(&e,0x29); byte(&e,0xC8); } /* sub eax,ecx */
+        else
+        { byte(&e,0x0F); byte(&e,0xAF); byte(&e,0xC1); } /* imul eax,ecx */
+        storeReg(&e,EAX,r);
+        break;
+      case opDIV:
+        loadReg(&e,EAX,s,pc);
+        loadReg(&e,ECX,t,pc);
+        byte(&e,0x85); byte(&e,0xC9); /* test ecx,ecx */
+        /* the interpreter reports the division by 0 */
+        guard(&e,CCEQ,&exit[nexit++],pc,k,srOKAY);
+        byte(&e,0x99); /* cdq */
+        byte(&e,0xF7); byte(&e,0xF9); /* idiv ecx */
+        storeReg(&e,EAX,r);
+        break;
+      case opLD:
+      case opST:
+        loadReg(&e,EAX,t,pc);
+        if (d != 0)
+        { byte(&e,0x05); /* add eax,d */
+          word(&e,d);
+        }
+        byte(&e,0x3D); /* cmp eax,DADDR_SIZE */
+        word(&e,DADDR_SIZE);
+        /* and the interpreter the fault */
+        guard(&e,0x3 /* jae */,&exit[nexit++],pc,k,srOKAY);
+        if (i->iop == opLD)
+        { byte(&e,0x8B); byte(&e,0x8C); byte(&e,0x83); /* mov ecx,[rbx+4*rax+dMem] */
+          word(&e,DMEMOFF);
+          storeReg(&e,ECX,r);
+        }
+        else
+        { loadReg(&e,ECX,r,pc);
+          byte(&e,0x89); byte(&e,0x8C); byte(&e,0x83); /* mov [rbx+4*rax+dMem],ecx */
+          word(&e,DMEMOFF);
+        }
+        break;
+      case opLDA:
+        /* a jump to d(7) needs no code */
+        if (r == PC_REG) break;
+        loadReg(&e,EAX,t,pc);
+        byte(&e,0x05); /* add eax,d */
+        word(&e,d);
+        storeReg(&e,EAX,r);
+        break;
+      case opLDC:
+        if (r == PC_REG) break;
+        byte(&e,0xC7); byte(&e,0x83); /* mov dword [rbx+reg r],d */
+        word(&e,REGOFF(r));
+        word(&e,d);
+        break;
+      default: /* the conditional jumps, to d(7) */
+      { int to = pc+1+d;
+        if (to == pc+1) break;
+        switch (i->iop)
+        { case opJLT: cc = CCLT; break;
+          case opJLE: cc = CCLE; break;
+          case opJGT: cc = CCGT; break;
+          case opJGE: cc = CCGE; break;
+          case opJEQ: cc = CCEQ; break;
+          default: cc = CCNE; break;
+        }
+        loadReg(&e,EAX,r,pc);
+        byte(&e,0x85); byte(&e,0xC0); /* test eax,eax */
+        /* leave where this trip goes the other way */
+        if (next == to) guard(&e,cc ^ 1,&exit[nexit++],pc+1,k+1,srOKAY);
+        else guard(&e,cc,&exit[nexit++],to,k+1,srOKAY);
+        break;
+      }
+    }
+  }
+  byte(&e,0x49); byte(&e,0x81); byte(&e,0x04); byte(&e,0x24); /* add qword [r12],n */
+  word(&e,n);
+  byte(&e,0xE9); /* jmp loop */
+  word(&e,loop - (e.n+4));
+  epilogue = e.n;
+  byte(&e,0x5D); /* pop rbp */
+  byte(&e,0x41); byte(&e,0x5C); /* pop r12 */
+  byte(&e,0x5B); /* pop rbx */
+  byte(&e,0xC3); /* ret */
+  for (k = 0; k < nexit; k++)
+  { patch(&e,exit[k].patch,e.n);
+    byte(&e,0xC7); byte(&e,0x83); /* mov dword [rbx+pc],resume */
+    word(&e,REGOFF(PC_REG));
+    word(&e,exit[k].resume);
+    byte(&e,0x49); byte(&e,0x81); byte(&e,0x04); byte(&e,0x24); /* add qword [r12],steps */
+    word(&e,exit[k].steps);
+    byte(&e,0xB8); /* mov eax,result */
+    word(&e,exit[k].result);
+    byte(&e,0xE9); /* jmp epilogue */
+    word(&e,epilogue - (e.n+4));
+  }
+  if (mprotect(jit->code,CODESIZE,PROT_READ | PROT_EXEC) != 0)
+  { /* none of the traces can run now */
+    memset(jit->trace,0,jit->tm->isize*sizeof(TRACE));
+    return FALSE;
+  }
+  if (e.n > e.max) return FALSE;
+  jit->trace[rec[0]] = (TRACE) (void *) e.buf;
+  jit->used += e.n;
+  return TRUE;
+} /* compile */
+
+#endif
+
+/********************************************/
+STEPRESULT tmJitRun( TM * tm, long * steps )
+{
+#if CANJIT
+  JIT jit;
+  STEPRESULT result;
+  int rec[TRACEMAX];
+  int head = -1, nrec = 0, pc, to;
+  long n = 0;
+  if (tm->profile != NULL) return tmRun(tm,steps);
+  jit.tm = tm;
+  jit.hits = (int *) calloc(tm->isize,sizeof(int));
+  jit.trace = (TRACE *) calloc(tm->isize,sizeof(TRACE));
+  jit.code = (unsigned char *) mmap(NULL,CODESIZE,PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+  jit.used = 0;
+  jit.full = FALSE;
+  if ((jit.hits == NULL) || (jit.trace == NULL) || (jit.code == MAP_FAILED))
+  { free(jit.hits);
+    free(jit.trace);
+    if (jit.code != MAP_FAILED) munmap(jit.code,CODESIZE);
+    return tmRun(tm,steps);
+  }
+  for (;;)
+  { pc = tm->reg[PC_REG];
+    if (head < 0)
+    { if ((pc >= 0) && (pc < tm->isize) && (jit.trace[pc] != NULL))
+      { result = jit.trace[pc](tm,&n);
+        if (result != srOKAY) break;
+        continue;
+      }
+    }
+    else if ((pc == head) && (nrec > 0))
+    { /* the loop came round: compile it */
+      if (! compile(&jit,rec,nrec)) jit.full = TRUE;
+      head = -1;
+      continue;
+    }
+    else if ((nrec == TRACEMAX) || ! traceable(tm,pc))
+    { /* try again after many more trips */
+      jit.hits[head] = -16*HOTLOOP;
+      head = -1;
+    }
+    else rec[nrec++] = pc;
+    result = tmStep(tm);
+    n++;
+    if (result != srOKAY) break;
+    /* a backward jump: a loop is at to */
+    to = tm->reg[PC_REG];
+    if ((to <= pc) && (to >= 0) && (head < 0) && ! jit.full
+        && (++jit.hits[to] == HOTLOOP))
+    { head = to;
+      nrec = 0;
+    }
+  }
+  free(jit.hits);
+  free(jit.trace);
+  munmap(jit.code,CODESIZE);
+  if (steps != NULL) *steps = n;
+  return result;
+#else
+  return tmRun(tm,steps);
+#endif
+} /* tmJitRun */
@@ -0,0 +1,31 @@
+/****************************************************/
+/* File: tmjit.h                                    */
+/* A trace compiler for the TM engine: while it     */
+/* interprets, it counts the backward jumps taken   */
+/* to each location, and once a loop is hot records */
+/* the instructions of one trip around it and       */
+/* compiles them to x86-64 code, with a guard that  */
+/* goes back to the interpreter wherever a later    */
+/* trip leaves that path                            */
+/****************************************************/
+
+#ifndef _TMJIT_H_
+#define _TMJIT_H_
+
+/* HOTLOOP is how many times a backward jump to a
+   location must be taken before the loop there is
+   recorded */
+#define HOTLOOP 50
+
+/* TRACEMAX is the most instructions in a trace */
+#define TRACEMAX 256
+
+/* Function tmJitRun runs tm as tmRun does, with
+ * the same results, but runs the hot loops as
+ * native code. It only interprets if tm keeps a
+ * profile, if the host is not x86-64, or if no
+ * executable memory can be had
+ */
+STEPRESULT tmJitRun( TM * tm, long * steps );
+
+#endif
@@ -0,0 +1,380 @@
+/****************************************************/
+/* File: tmlanes.c                                  */
+/* The multi-lane TM engine (see tmlanes.h)         */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tmeng.h"
+#include "tmlanes.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* the lane numbers, to make masks from bits */
+static const LANEVEC laneNumber = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+/* the vector helpers are macros: a function
+   taking a vector would change its calling
+   convention with -mavx2 */
+
+/* LANEMASK is the vector of -1 in the lanes whose
+   bit is set in bits, 0 in the others */
+#define LANEMASK(bits) \
+  (-((((LANEVEC) {0} + (int) (bits)) >> laneNumber) & 1))
+
+/* ALLLANES has the bit of every lane set */
+#define ALLLANES ((unsigned) ((1ULL << LANES) - 1))
+
+/* BLEND is v in the lanes of m, old in the
+   others */
+#define BLEND(v,old,m) (((v) & (m)) | ((old) & ~(m)))
+
+/* laneBits returns the bits of the lanes of *v
+   that are not 0 */
+static unsigned laneBits( const LANEVEC * v )
+{ unsigned bits = 0;
+  int l;
+  for (l = 0; l < LANES; l++)
+    if ((*v)[l] != 0) bits |= 1U << l;
+  return bits;
+}
+
+/* Function successors sets succ[0..1] to the
+ * locations that may run after the one at loc,
+ * size standing for the end (a HALT, a fault or a
+ * computed jump); returns how many there are
+ */
+static int successors( INSTRUCTION * code, int size, int loc, int succ[2] )
+{ INSTRUCTION * i = &code[loc];
+  int n = 0, to = -1, next = TRUE;
+  if (i->iop == opHALT) next = FALSE;
+  else if ((i->iop >= opJLT) && (i->iop <= opJNE))
+    to = (i->iarg3 == PC_REG) ? loc+1+i->iarg2 : size;
+  else if ((i->iarg1 == PC_REG) && (i->iop != opOUT) && (i->iop != opST))
+  { next = FALSE;
+    if ((i->iop == opLDA) && (i->iarg3 == PC_REG)) to = loc+1+i->iarg2;
+    else if (i->iop == opLDC) to = i->iarg2;
+    else to = size;
+  }
+  if (next) succ[n++] = (loc+1 < size) ? loc+1 : size;
+  if (to >= 0) succ[n++] = ((to >= 0) && (to < size)) ? to : size;
+  if (n == 0) succ[n++] = size;
+  return n;
+}
+
+/* Function postDominators returns the immediate
+ * post-dominator of each of the size locations of
+ * code, -1 for those that only the end follows
+ * on every way (Cooper, Harvey and Kennedy's
+ * algorithm, on the reversed control flow graph,
+ * whose entry is the end); NULL if out of memory
+ */
+static int * postDominators( INSTRUCTION * code, int size )
+{ int nodes = size+1; /* node size is the end */
+  int * succ = (int *) malloc(2*nodes*sizeof(int));
+  int * nsucc = (int *) calloc(nodes,sizeof(int));
+  int * npred = (int *) calloc(nodes+1,sizeof(int));
+  int * pred = (int *) malloc(2*nodes*sizeof(int));
+  int * order = (int *) malloc(nodes*sizeof(int));
+  int * number = (int *) malloc(nodes*sizeof(int));
+  int * stack = (int *) malloc(nodes*sizeof(int));
+  int * next = (int *) calloc(nodes,sizeof(int));
+  int * idom = (int *) malloc(nodes*sizeof(int));
+  int loc, k, n, top, count = 0, changed;
+  if (!succ || !nsucc || !npred || !pred || !order || !number
+      || !stack || !next || !idom)
+  { free(idom);
+    idom = NULL;
+    goto done;
+  }
+  for (loc = 0; loc < size; loc++)
+  { nsucc[loc] = successors(code,size,loc,&succ[2*loc]);
+    for (k = 0; k < nsucc[loc]; k++) npred[succ[2*loc+k]+1]++;
+  }
+  /* the predecessors of node v are pred[npred[v]..
+     npred[v+1]-1] */
+  for (n = 0; n < nodes; n++) npred[n+1] += npred[n];
+  for (loc = 0; loc < size; loc++)
+    for (k = 0; k < nsucc[loc]; k++)
+      pred[npred[succ[2*loc+k]]+next[succ[2*loc+k]]++] = loc;
+  /* the nodes in postorder of a search from the
+     end along the reversed edges */
+  for (n = 0; n < nodes; n++)
+  { number[n] = -1;
+    next[n] = 0;
+    idom[n] = -1;
+  }
+  top = 0;
+  stack[top++] = size;
+  number[size] = -2;
+  while (top > 0)
+  { int v = stack[top-1];
+    if (npred[v]+next[v] < npred[v+1])
+    { int p = pred[npred[v]+next[v]++];
+      if (number[p] == -1)
+      { number[p] = -2;
+        stack[top++] = p;
+      }
+    }
+    else
+    { number[v] = count;
+      order[count++] = v;
+      top--;
+    }
+  }
+  idom[size] = size;
+  do
+  { changed = FALSE;
+    /* in reverse postorder, skipping the end */
+    for (n = count-2; n >= 0; n--)
+    { int v = order[n], d = -1;
+      for (k = 0; k < nsucc[v]; k++)
+      { int s = succ[2*v+k];
+        if (idom[s] < 0) continue;
+        if (d < 0) d = s;
+        else
+        { int a = s, b = d;
+          while (a != b)
+          { while (number[a] < number[b]) a = idom[a];
+            while (number[b] < number[a]) b = idom[b];
+          }
+          d = a;
+        }
+      }
+      if (idom[v] != d)
+      { idom[v] = d;
+        changed = TRUE;
+      }
+    }
+  } while (changed);
+  for (loc = 0; loc < size; loc++)
+    if (idom[loc] == size) idom[loc] = -1;
+done:
+  free(succ);
+  free(nsucc);
+  free(npred);
+  free(pred);
+  free(order);
+  free(number);
+  free(stack);
+  free(next);
+  return idom;
+}
+
+/********************************************/
+TMLANES * tmLanesNew( INSTRUCTION * code, int isize )
+{ TMLANES * tm = (TMLANES *) calloc(1,sizeof(TMLANES));
+  if (tm == NULL) return NULL;
+  tm->iMem = code;
+  tm->isize = isize;
+  tm->ipdom = postDominators(code,isize);
+  tm->dMem = (LANEVEC *) malloc(DADDR_SIZE*sizeof(LANEVEC));
+  tm->maxpaths = 16;
+  tm->paths = (LANEPATH *) malloc(tm->maxpaths*sizeof(LANEPATH));
+  if ((tm->ipdom == NULL) || (tm->dMem == NULL) || (tm->paths == NULL))
+  { tmLanesFree(tm);
+    return NULL;
+  }
+  tmLanesReset(tm,LANES);
+  return tm;
+} /* tmLanesNew */
+
+/********************************************/
+void tmLanesFree( TMLANES * tm )
+{ free(tm->ipdom);
+  free(tm->dMem);
+  free(tm->paths);
+  free(tm);
+} /* tmLanesFree */
+
+/********************************************/
+void tmLanesReset( TMLANES * tm, int nlanes )
+{ int i, l;
+  for (i = 0; i < NO_REGS; i++) tm->reg[i] = (LANEVEC) {0};
+  tm->dMem[0] = (LANEVEC) {0} + (DADDR_SIZE - 1);
+  for (i = 1; i < DADDR_SIZE; i++) tm->dMem[i] = (LANEVEC) {0};
+  for (l = 0; l < LANES; l++)
+  { tm->result[l] = (l < nlanes) ? srOKAY : srHALT;
+    tm->stopLoc[l] = 0;
+  }
+  tm->paths[0].pc = 0;
+  tm->paths[0].rpc = -1;
+  tm->paths[0].mask = (nlanes >= LANES) ? ALLLANES : (1U << nlanes) - 1;
+  tm->npaths = 1;
+} /* tmLanesReset */
+
+/* stop stops the lanes in bits with result r at
+   location loc, taking them off every way */
+static void stop( TMLANES * tm, unsigned bits, STEPRESULT r, int loc )
+{ int l, p;
+  for (l = 0; l < LANES; l++)
+    if (bits & (1U << l))
+    { tm->result[l] = r;
+      tm->stopLoc[l] = loc;
+    }
+  for (p = 0; p < tm->npaths; p++) tm->paths[p].mask &= ~bits;
+}
+
+/* push adds a way for the lanes in bits, from pc
+   to rpc; FALSE if out of memory */
+static int push( TMLANES * tm, int pc, int rpc, unsigned bits )
+{ if (tm->npaths == tm->maxpaths)
+  { LANEPATH * p = (LANEPATH *) realloc(tm->paths,
+                     2*tm->maxpaths*sizeof(LANEPATH));
+    if (p == NULL) return FALSE;
+    tm->paths = p;
+    tm->maxpaths *= 2;
+  }
+  tm->paths[tm->npaths].pc = pc;
+  tm->paths[tm->npaths].rpc = rpc;
+  tm->paths[tm->npaths].mask = bits;
+  tm->npaths++;
+  return TRUE;
+}
+
+/* writesPc is TRUE if instruction i may set the pc
+   to other than the next location */
+static int writesPc( INSTRUCTION * i )
+{ if ((i->iop >= opJLT) && (i->iop <= opJNE)) return TRUE;
+  return (i->iarg1 == PC_REG) && (i->iop != opHALT)
+         && (i->iop != opOUT) && (i->iop != opST);
+}
+
+/* Procedure step executes the instruction at the
+ * pc of the top way on its lanes, as tmStep does
+ * on each of them, and moves the way on
+ */
+static void step( TMLANES * tm )
+{ LANEPATH * w = &tm->paths[tm->npaths-1];
+  LANEVEC * reg = tm->reg;
+  LANEVEC m, a, v;
+  INSTRUCTION in;
+  unsigned bits = w->mask, bad = 0, go;
+  int pc = w->pc, r, s, t, l, d, first;
+  if ((pc < 0) || (pc >= tm->isize))
+  { stop(tm,bits,srIMEM_ERR,pc);
+    return;
+  }
+  m = LANEMASK(bits);
+  reg[PC_REG] = BLEND((LANEVEC) {0} + (pc+1),reg[PC_REG],m);
+  in = tm->iMem[pc];
+  r = in.iarg1;
+  s = (opClass(in.iop) == opclRR) ? in.iarg2 : in.iarg3;
+  t = in.iarg3;
+  d = in.iarg2;
+  a = (LANEVEC) {0} + d + reg[s];
+  if (opClass(in.iop) == opclRM)
+  { v = m & ((a < 0) | (a >= DADDR_SIZE));
+    bad = laneBits(&v);
+    if (bad)
+    { stop(tm,bad,srDMEM_ERR,pc);
+      bits &= ~bad;
+      m = LANEMASK(bits);
+    }
+  }
+  switch (in.iop)
+  { case opHALT:
+      stop(tm,bits,srHALT,pc);
+      break;
+    case opIN:
+      for (l = 0; l < LANES; l++)
+        if (bits & (1U << l))
+        { int value;
+          if (tm->input(tm,l,&value)) reg[r][l] = value;
+          else bad |= 1U << l;
+        }
+      if (bad) stop(tm,bad,srIN_ERR,pc);
+      break;
+    case opOUT:
+      for (l = 0; l < LANES; l++)
+        if (bits & (1U << l)) tm->output(tm,l,reg[r][l]);
+      break;
+    case opADD: reg[r] = BLEND(reg[s] + reg[t],reg[r],m); break;
+    case opSUB: reg[r] = BLEND(reg[s] - reg[t],reg[r],m); break;
+    case opMUL: reg[r] = BLEND(reg[s] * reg[t],reg[r],m); break;
+    case opDIV:
+      /* there is no vector division */
+      v = reg[r];
+      for (l = 0; l < LANES; l++)
+        if (bits & (1U << l))
+        { if (reg[t][l] != 0) v[l] = reg[s][l] / reg[t][l];
+          else bad |= 1U << l;
+        }
+      reg[r] = v;
+      if (bad) stop(tm,bad,srZERODIVIDE,pc);
+      break;
+    case opLD:
+    case opST:
+      if (bits == 0) break;
+      /* TINY code addresses memory from gp and mp,
+         which are the same in every lane */
+      first = __builtin_ctz(bits);
+      v = m & (a != a[first]);
+      if (laneBits(&v) == 0)
+      { if (in.iop == opLD) reg[r] = BLEND(tm->dMem[a[first]],reg[r],m);
+        else tm->dMem[a[first]] = BLEND(reg[r],tm->dMem[a[first]],m);
+      }
+      else for (l = 0; l < LANES; l++)
+        if (bits & (1U << l))
+        { if (in.iop == opLD) reg[r][l] = tm->dMem[a[l]][l];
+          else tm->dMem[a[l]][l] = reg[r][l];
+        }
+      break;
+    case opLDA: reg[r] = BLEND(a,reg[r],m); break;
+    case opLDC: reg[r] = BLEND((LANEVEC) {0} + d,reg[r],m); break;
+    case opJLT: reg[PC_REG] = BLEND(a,reg[PC_REG],m & (reg[r] < 0)); break;
+    case opJLE: reg[PC_REG] = BLEND(a,reg[PC_REG],m & (reg[r] <= 0)); break;
+    case opJGT: reg[PC_REG] = BLEND(a,reg[PC_REG],m & (reg[r] > 0)); break;
+    case opJGE: reg[PC_REG] = BLEND(a,reg[PC_REG],m & (reg[r] >= 0)); break;
+    case opJEQ: reg[PC_REG] = BLEND(a,reg[PC_REG],m & (reg[r] == 0)); break;
+    case opJNE: reg[PC_REG] = BLEND(a,reg[PC_REG],m & (reg[r] != 0)); break;
+  }
+  /* the lanes still running go on: together if
+     they all go to the same location, else each
+     group in turn, to meet at the post-dominator */
+  bits = w->mask;
+  if (bits == 0) return;
+  if (!writesPc(&in))
+  { w->pc = pc+1;
+    return;
+  }
+  first = __builtin_ctz(bits);
+  m = LANEMASK(bits);
+  v = m & (reg[PC_REG] != reg[PC_REG][first]);
+  if (laneBits(&v) == 0)
+  { w->pc = reg[PC_REG][first];
+    return;
+  }
+  d = tm->ipdom[pc];
+  if (d == w->rpc) tm->npaths--;
+  else w->pc = d;
+  while (bits != 0)
+  { int to;
+    first = __builtin_ctz(bits);
+    to = reg[PC_REG][first];
+    go = 0;
+    for (l = first; l < LANES; l++)
+      if ((bits & (1U << l)) && (reg[PC_REG][l] == to)) go |= 1U << l;
+    bits &= ~go;
+    if ((to != d) && !push(tm,to,d,go))
+      stop(tm,go,srIMEM_ERR,to);
+  }
+} /* step */
+
+/********************************************/
+void tmLanesRun( TMLANES * tm )
+{ while (tm->npaths > 0)
+  { LANEPATH * w = &tm->paths[tm->npaths-1];
+    /* a way ends when its lanes have all stopped
+       or reached the location where it meets the
+       way below */
+    if ((w->mask == 0) || (w->pc == w->rpc)) tm->npaths--;
+    else step(tm);
+  }
+} /* tmLanesRun */
@@ -0,0 +1,78 @@
+/****************************************************/
+/* File: tmlanes.h                                  */
+/* A TM engine that runs one program on LANES       */
+/* inputs at once: each register and data location  */
+/* holds a vector of LANES values, one per run, and */
+/* each instruction works on all of them with the   */
+/* vector instructions of the host (AVX2 when built */
+/* with -mavx2). Where the runs take different ways */
+/* at a jump, the lanes of each way run in turn,    */
+/* the others masked off, until all meet again at   */
+/* the jump's immediate post-dominator              */
+/****************************************************/
+
+#ifndef _TMLANES_H_
+#define _TMLANES_H_
+
+/* LANES is the number of runs at once */
+#define LANES 8
+
+/* a register or data location: a value per lane.
+   It asks only the alignment of an int, as malloc
+   does not give that of the vector */
+typedef int LANEVEC __attribute__ ((vector_size (LANES*sizeof(int)),
+                                    aligned (sizeof(int))));
+
+/* a way some of the lanes take: they run from pc
+ * until they reach rpc, where the lanes of the
+ * entry below wait for them
+ */
+typedef struct
+   { int pc;
+     int rpc; /* -1 if there is none */
+     unsigned mask; /* bit l for lane l */
+   } LANEPATH;
+
+/* the state of a multi-lane machine. The result
+ * of each lane is srOKAY until it stops, at
+ * location stopLoc; IN and OUT go through input
+ * and output, per lane
+ */
+typedef struct tmlanes
+   { INSTRUCTION * iMem;
+     int isize;
+     int * ipdom; /* immediate post-dominator of each
+                     location, -1 if only the end */
+     LANEVEC * dMem; /* DADDR_SIZE locations */
+     LANEVEC reg [NO_REGS];
+     STEPRESULT result [LANES];
+     int stopLoc [LANES];
+     LANEPATH * paths; /* a stack of npaths ways */
+     int npaths, maxpaths;
+     int (* input) (struct tmlanes *, int, int *);
+     void (* output) (struct tmlanes *, int, int);
+     void * user; /* for input and output */
+   } TMLANES;
+
+/* Function tmLanesNew returns a machine for the
+ * isize instructions of code, which it keeps
+ * but does not copy; NULL if out of memory
+ */
+TMLANES * tmLanesNew( INSTRUCTION * code, int isize );
+
+/* Procedure tmLanesFree releases machine tm */
+void tmLanesFree( TMLANES * tm );
+
+/* Procedure tmLanesReset makes tm ready for runs
+ * on its first nlanes lanes, with the state
+ * tmReset gives each; the other lanes do not run
+ */
+void tmLanesReset( TMLANES * tm, int nlanes );
+
+/* Procedure tmLanesRun runs every lane of tm until
+ * it stops, leaving in tm->result[l] the result
+ * of the step that stopped lane l
+ */
+void tmLanesRun( TMLANES * tm );
+
+#endif
@@ -0,0 +1,150 @@
+/****************************************************/
+/* File: tmperf.c                                   */
+/* The performance counters of a TM run (see        */
+/* tmperf.h)                                        */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "tmperf.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define CANPERF 1
+#else
+#define CANPERF 0
+#endif
+
+/* the names of the counters, indexed as TMPERF */
+static char * perfName[NPERF]
+        = {"cycles","instructions","branch-misses",
+           "L1-dcache-load-misses","L1-icache-load-misses",
+           "task-clock (ns)"
+          };
+
+#if CANPERF
+/* the type and config of each counter for
+   perf_event_open */
+#define L1MISS(cache) ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) \
+                       | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+static struct { int type; long long config; } perfEvent[NPERF]
+        = {{PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES},
+           {PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS},
+           {PERF_TYPE_HARDWARE,PERF_COUNT_HW_BRANCH_MISSES},
+           {PERF_TYPE_HW_CACHE,L1MISS(PERF_COUNT_HW_CACHE_L1D)},
+           {PERF_TYPE_HW_CACHE,L1MISS(PERF_COUNT_HW_CACHE_L1I)},
+           {PERF_TYPE_SOFTWARE,PERF_COUNT_SW_TASK_CLOCK}
+          };
+#endif
+
+/********************************************/
+int tmPerfStart( TMPERF * p )
+{ int k, n = 0;
+  for (k = 0; k < NPERF; k++)
+  { p->fd[k] = -1;
+    p->error[k] = 0;
+    p->value[k] = 0;
+  }
+#if CANPERF
+  /* each is opened on its own, so that those the
+     host lacks do not keep the others from
+     counting */
+  for (k = 0; k < NPERF; k++)
+  { struct perf_event_attr attr;
+    memset(&attr,0,sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = perfEvent[k].type;
+    attr.config = perfEvent[k].config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+                       | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    p->fd[k] = syscall(SYS_perf_event_open,&attr,0,-1,-1,0);
+    if (p->fd[k] < 0)
+    { p->error[k] = errno;
+      p->fd[k] = -1;
+    }
+    else n++;
+  }
+  /* started last, and together, to count as
+     little of this as can be */
+  for (k = 0; k < NPERF; k++)
+    if (p->fd[k] >= 0) ioctl(p->fd[k],PERF_EVENT_IOC_ENABLE,0);
+#else
+  for (k = 0; k < NPERF; k++) p->error[k] = ENOSYS;
+#endif
+  return n;
+} /* tmPerfStart */
+
+/********************************************/
+void tmPerfStop( TMPERF * p )
+{
+#if CANPERF
+  int k;
+  for (k = 0; k < NPERF; k++)
+    if (p->fd[k] >= 0) ioctl(p->fd[k],PERF_EVENT_IOC_DISABLE,0);
+  for (k = 0; k < NPERF; k++)
+    if (p->fd[k] >= 0)
+    { /* the value, and the times enabled and
+         counting */
+      unsigned long long buf[3];
+      if (read(p->fd[k],buf,sizeof(buf)) != sizeof(buf))
+        p->error[k] = EIO;
+      else if (buf[2] == 0)
+        p->error[k] = EBUSY; /* never had a counter */
+      else p->value[k] = (double) buf[0] * ((double) buf[1] / buf[2]);
+      close(p->fd[k]);
+      p->fd[k] = -1;
+    }
+#endif
+} /* tmPerfStop */
+
+/* reason says why a counter was not counted,
+   from the errno err */
+static char * reason( int err )
+{ switch (err)
+  { case ENOENT: case EOPNOTSUPP: case ENOSYS:
+      return "not supported here";
+    case EACCES: case EPERM:
+      return "not allowed, see perf_event_paranoid";
+    default: return strerror(err);
+  }
+}
+
+/* counted is TRUE if counter k of p was read */
+#define counted(p,k) ((p)->error[k] == 0)
+
+/********************************************/
+void tmPerfReport( TMPERF * p, long steps, FILE * f )
+{ int k;
+  fprintf(f,"Performance counters (%ld TM instructions):\n",steps);
+  for (k = 0; k < NPERF; k++)
+    if (counted(p,k)) fprintf(f,"%24s %16.0f\n",perfName[k],p->value[k]);
+    else fprintf(f,"%24s %16s (%s)\n",perfName[k],"not counted",
+                 reason(p->error[k]));
+  if (steps <= 0) return;
+  if (counted(p,PERF_CYCLES))
+    fprintf(f,"%24s %16.2f\n","cycles per TM instr",
+            p->value[PERF_CYCLES]/steps);
+  if (counted(p,PERF_INSTRUCTIONS))
+    fprintf(f,"%24s %16.2f\n","instructions per TM instr",
+            p->value[PERF_INSTRUCTIONS]/steps);
+  if (counted(p,PERF_BRANCH_MISSES))
+    fprintf(f,"%24s %16.4f\n","mispredicts per dispatch",
+            p->value[PERF_BRANCH_MISSES]/steps);
+  if (counted(p,PERF_L1D_MISSES))
+    fprintf(f,"%24s %16.4f\n","L1d misses per TM instr",
+            p->value[PERF_L1D_MISSES]/steps);
+  if (counted(p,PERF_L1I_MISSES))
+    fprintf(f,"%24s %16.4f\n","L1i misses per TM instr",
+            p->value[PERF_L1I_MISSES]/steps);
+  if (counted(p,PERF_TASK_CLOCK))
+    fprintf(f,"%24s %16.2f\n","ns per TM instr",
+            p->value[PERF_TASK_CLOCK]/steps);
+} /* tmPerfReport */
@@ -0,0 +1,49 @@
+/****************************************************/
+/* File: tmperf.h                                   */
+/* The hardware performance counters of the host,   */
+/* read with perf_event_open around a run of the    */
+/* TM engine, and reported per TM instruction       */
+/****************************************************/
+
+#ifndef _TMPERF_H_
+#define _TMPERF_H_
+
+/* the counters, as indexes of TMPERF */
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+#define PERF_BRANCH_MISSES 2
+#define PERF_L1D_MISSES 3
+#define PERF_L1I_MISSES 4
+#define PERF_TASK_CLOCK 5 /* in ns; a software counter */
+#define NPERF 6
+
+/* the counters of one run: fd is -1 for one that
+ * could not be opened, with the reason in error
+ * (an errno); value is scaled up for the time it
+ * did not count, when the host had too few
+ * counters for all of them at once
+ */
+typedef struct
+   { int fd [NPERF];
+     int error [NPERF];
+     double value [NPERF];
+   } TMPERF;
+
+/* Function tmPerfStart opens and starts the
+ * counters of p, for this thread in user mode;
+ * returns how many are counting
+ */
+int tmPerfStart( TMPERF * p );
+
+/* Procedure tmPerfStop stops the counters of p,
+ * reads them into p->value and closes them
+ */
+void tmPerfStop( TMPERF * p );
+
+/* Procedure tmPerfReport writes the counters of
+ * p to f, and what they come to per TM
+ * instruction, steps having run
+ */
+void tmPerfReport( TMPERF * p, long steps, FILE * f );
+
+#endif
@@ -0,0 +1,382 @@
+/****************************************************/
+/* File: tmrules.c                                  */
+/* The TM rewrite rules (see rewrite.h), made by    */
+/* the superoptimizer superopt.c:                   */
+/*    make rules                                    */
+/* Do not edit                                      */
+/****************************************************/
+
+#include <stdio.h>
+#include "tmeng.h"
+#include "rewrite.h"
+
+TMRULE tmRules[] = {
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); ADD 0,1,0
+     => (nothing)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    0, {{0}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opST,{{'c',0},{'p',P_T},{'c',6}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6); LD 1,T(6) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); ADD 0,1,0
+     => LDA 0,1(0)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opLDA,{{'c',0},{'c',1},{'c',0}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6); LDA 0,1(0)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',1},{'c',0}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6); LD 1,T(6); LDA 0,1(0) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',1},{'c',0}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); ADD 0,1,0
+     => LDA 0,2(0)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opLDA,{{'c',0},{'c',2},{'c',0}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6); LDA 0,2(0)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',2},{'c',0}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6); LD 1,T(6); LDA 0,2(0) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',2},{'c',0}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); ADD 0,1,0
+     => LDA 0,K(0)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opLDA,{{'c',0},{'p',P_K},{'c',0}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6); LDA 0,K(0)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'p',P_K},{'c',0}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6); LD 1,T(6); LDA 0,K(0) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'p',P_K},{'c',0}}}},
+    0 },
+  /* ST 0,T(6); LD 0,X(5); LD 1,T(6); ADD 0,1,0
+     => LD 1,X(5); ADD 0,0,1
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',0},{'p',P_X},{'c',5}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opLD,{{'c',1},{'p',P_X},{'c',5}}},{opADD,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LD 0,X(5); LD 1,T(6); ADD 0,1,0
+     => LD 1,X(5); ST 0,T(6); ADD 0,0,1
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',0},{'p',P_X},{'c',5}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opLD,{{'c',1},{'p',P_X},{'c',5}}},{opST,{{'c',0},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); ADD 0,1,0
+     => ADD 0,0,R
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opADD,{{'c',0},{'c',0},{'p',P_R}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6); ADD 0,0,R
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',0},{'p',P_R}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); ADD 0,1,0
+     => ST 0,T(6); LD 1,T(6); ADD 0,0,R */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',0},{'p',P_R}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); SUB 0,1,0
+     => (nothing)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    0, {{0}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opST,{{'c',0},{'p',P_T},{'c',6}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6); LD 1,T(6) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); SUB 0,1,0
+     => LDA 0,-1(0)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opLDA,{{'c',0},{'c',-1},{'c',0}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6); LDA 0,-1(0)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',-1},{'c',0}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6); LD 1,T(6); LDA 0,-1(0) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',-1},{'c',0}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); SUB 0,1,0
+     => LDA 0,-2(0)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opLDA,{{'c',0},{'c',-2},{'c',0}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6); LDA 0,-2(0)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',-2},{'c',0}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6); LD 1,T(6); LDA 0,-2(0) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',-2},{'c',0}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); SUB 0,1,0
+     => LDA 0,-K(0)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opLDA,{{'c',0},{'n',P_K},{'c',0}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6); LDA 0,-K(0)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'n',P_K},{'c',0}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6); LD 1,T(6); LDA 0,-K(0) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'n',P_K},{'c',0}}}},
+    0 },
+  /* ST 0,T(6); LD 0,X(5); LD 1,T(6); SUB 0,1,0
+     => LD 1,X(5); SUB 0,0,1
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',0},{'p',P_X},{'c',5}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opLD,{{'c',1},{'p',P_X},{'c',5}}},{opSUB,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LD 0,X(5); LD 1,T(6); SUB 0,1,0
+     => LD 1,X(5); ST 0,T(6); SUB 0,0,1
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',0},{'p',P_X},{'c',5}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opLD,{{'c',1},{'p',P_X},{'c',5}}},{opST,{{'c',0},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); SUB 0,1,0
+     => SUB 0,0,R
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opSUB,{{'c',0},{'c',0},{'p',P_R}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6); SUB 0,0,R
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',0},{'p',P_R}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); SUB 0,1,0
+     => ST 0,T(6); LD 1,T(6); SUB 0,0,R */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opSUB,{{'c',0},{'c',0},{'p',P_R}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); MUL 0,1,0
+     => LDC 0,0(0)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opLDC,{{'c',0},{'c',0},{'c',0}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); MUL 0,1,0
+     => ST 0,T(6); LDC 0,0(0)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); MUL 0,1,0
+     => ST 0,T(6); LD 1,T(6); LDC 0,0(0) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); MUL 0,1,0
+     => (nothing)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    0, {{0}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); MUL 0,1,0
+     => ST 0,T(6)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opST,{{'c',0},{'p',P_T},{'c',6}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); MUL 0,1,0
+     => ST 0,T(6); LD 1,T(6) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); MUL 0,1,0
+     => ADD 0,0,0
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opADD,{{'c',0},{'c',0},{'c',0}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); MUL 0,1,0
+     => ST 0,T(6); ADD 0,0,0
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',0},{'c',0}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); MUL 0,1,0
+     => ST 0,T(6); LD 1,T(6); ADD 0,0,0 */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opADD,{{'c',0},{'c',0},{'c',0}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); MUL 0,1,0
+     => LDC 1,K(0); MUL 0,0,1
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opLDC,{{'c',1},{'p',P_K},{'c',0}}},{opMUL,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); MUL 0,1,0
+     => ST 0,T(6); LDC 1,K(0); MUL 0,0,1
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',1},{'p',P_K},{'c',0}}},{opMUL,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LD 0,X(5); LD 1,T(6); MUL 0,1,0
+     => LD 1,X(5); MUL 0,0,1
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',0},{'p',P_X},{'c',5}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opLD,{{'c',1},{'p',P_X},{'c',5}}},{opMUL,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LD 0,X(5); LD 1,T(6); MUL 0,1,0
+     => LD 1,X(5); ST 0,T(6); MUL 0,0,1
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',0},{'p',P_X},{'c',5}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opLD,{{'c',1},{'p',P_X},{'c',5}}},{opST,{{'c',0},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); MUL 0,1,0
+     => MUL 0,0,R
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opMUL,{{'c',0},{'c',0},{'p',P_R}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); MUL 0,1,0
+     => ST 0,T(6); MUL 0,0,R
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',0},{'p',P_R}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); MUL 0,1,0
+     => ST 0,T(6); LD 1,T(6); MUL 0,0,R */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opMUL,{{'c',0},{'c',0},{'p',P_R}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,0(0); LD 1,T(6); DIV 0,1,0
+     => LDC 0,0(0); DIV 0,0,0 */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',0},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opLDC,{{'c',0},{'c',0},{'c',0}}},{opDIV,{{'c',0},{'c',0},{'c',0}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); DIV 0,1,0
+     => (nothing)
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    0, {{0}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); DIV 0,1,0
+     => ST 0,T(6)
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opST,{{'c',0},{'p',P_T},{'c',6}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,1(0); LD 1,T(6); DIV 0,1,0
+     => ST 0,T(6); LD 1,T(6) */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',1},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}}},
+    0 },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); DIV 0,1,0
+     => LDC 1,2(0); DIV 0,0,1
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opLDC,{{'c',1},{'c',2},{'c',0}}},{opDIV,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,2(0); LD 1,T(6); DIV 0,1,0
+     => ST 0,T(6); LDC 1,2(0); DIV 0,0,1
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'c',2},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',1},{'c',2},{'c',0}}},{opDIV,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); DIV 0,1,0
+     => LDC 1,K(0); DIV 0,0,1
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opLDC,{{'c',1},{'p',P_K},{'c',0}}},{opDIV,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDC 0,K(0); LD 1,T(6); DIV 0,1,0
+     => ST 0,T(6); LDC 1,K(0); DIV 0,0,1
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',0},{'p',P_K},{'c',0}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDC,{{'c',1},{'p',P_K},{'c',0}}},{opDIV,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LD 0,X(5); LD 1,T(6); DIV 0,1,0
+     => LD 1,X(5); DIV 0,0,1
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',0},{'p',P_X},{'c',5}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opLD,{{'c',1},{'p',P_X},{'c',5}}},{opDIV,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LD 0,X(5); LD 1,T(6); DIV 0,1,0
+     => LD 1,X(5); ST 0,T(6); DIV 0,0,1
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',0},{'p',P_X},{'c',5}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opLD,{{'c',1},{'p',P_X},{'c',5}}},{opST,{{'c',0},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',0},{'c',1}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); DIV 0,1,0
+     => DIV 0,0,R
+     if ac1 and T(mp) dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    1, {{opDIV,{{'c',0},{'c',0},{'p',P_R}}}},
+    DEAD_AC1|DEAD_TMP },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); DIV 0,1,0
+     => ST 0,T(6); DIV 0,0,R
+     if ac1 dead */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    2, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',0},{'p',P_R}}}},
+    DEAD_AC1 },
+  /* ST 0,T(6); LDA 0,0(R); LD 1,T(6); DIV 0,1,0
+     => ST 0,T(6); LD 1,T(6); DIV 0,0,R */
+  { 4, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLDA,{{'c',0},{'c',0},{'p',P_R}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',1},{'c',0}}}},
+    3, {{opST,{{'c',0},{'p',P_T},{'c',6}}},{opLD,{{'c',1},{'p',P_T},{'c',6}}},{opDIV,{{'c',0},{'c',0},{'p',P_R}}}},
+    0 },
+  /* ST 0,X(5); LD 0,X(5)
+     => ST 0,X(5) */
+  { 2, {{opST,{{'c',0},{'p',P_X},{'c',5}}},{opLD,{{'c',0},{'p',P_X},{'c',5}}}},
+    1, {{opST,{{'c',0},{'p',P_X},{'c',5}}}},
+    0 },
+};
+
+int tmNRules = sizeof(tmRules)/sizeof(tmRules[0]);
@@ -0,0 +1,173 @@
+/****************************************************/
+/* File: tmsched.c                                  */
+/* The scheduler of TM tasks (see tmsched.h)        */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tmeng.h"
+#include "tmsched.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* taskInput is the IN of a task: the next value
+   given to it, else it blocks, unless closed */
+static int taskInput( TM * tm, int * value )
+{ TMTASK * t = (TMTASK *) tm->user;
+  if (t->qlen > 0)
+  { *value = t->queue[t->qhead];
+    t->qhead = (t->qhead+1) % t->qmax;
+    t->qlen--;
+    return TRUE;
+  }
+  if (! t->closed) t->state = tsBLOCKED;
+  return FALSE;
+}
+
+/* taskOutput is the OUT of a task */
+static void taskOutput( TM * tm, int value )
+{ TMTASK * t = (TMTASK *) tm->user;
+  t->sched->output(t,value);
+}
+
+/* the OUT of a scheduler that is not given one */
+static void stdOutput( TMTASK * t, int value )
+{ printf("%d: %d\n",t->id,value); }
+
+/********************************************/
+TMSCHED * tmSchedNew( int policy, long slice )
+{ TMSCHED * s = (TMSCHED *) malloc(sizeof(TMSCHED));
+  if (s == NULL) return NULL;
+  s->maxtasks = 16;
+  s->task = (TMTASK **) malloc(s->maxtasks*sizeof(TMTASK *));
+  if (s->task == NULL)
+  { free(s);
+    return NULL;
+  }
+  s->ntasks = 0;
+  s->policy = policy;
+  s->slice = (slice > 0) ? slice : 1;
+  s->last = -1;
+  s->output = stdOutput;
+  s->user = NULL;
+  return s;
+} /* tmSchedNew */
+
+/********************************************/
+void tmSchedFree( TMSCHED * s )
+{ int i;
+  for (i = 0; i < s->ntasks; i++)
+  { tmFree(s->task[i]->tm);
+    free(s->task[i]->queue);
+    free(s->task[i]);
+  }
+  free(s->task);
+  free(s);
+} /* tmSchedFree */
+
+/********************************************/
+TMTASK * tmSchedAdd( TMSCHED * s, TM * tm, int priority )
+{ TMTASK * t;
+  if (s->ntasks == s->maxtasks)
+  { TMTASK ** p = (TMTASK **) realloc(s->task,
+                     2*s->maxtasks*sizeof(TMTASK *));
+    if (p == NULL) return NULL;
+    s->task = p;
+    s->maxtasks *= 2;
+  }
+  t = (TMTASK *) calloc(1,sizeof(TMTASK));
+  if (t == NULL) return NULL;
+  t->tm = tm;
+  t->id = s->ntasks+1;
+  t->priority = priority;
+  t->state = tsREADY;
+  t->result = srOKAY;
+  t->sched = s;
+  tm->input = taskInput;
+  tm->output = taskOutput;
+  tm->user = t;
+  s->task[s->ntasks++] = t;
+  return t;
+} /* tmSchedAdd */
+
+/********************************************/
+int tmSchedFeed( TMTASK * t, int value )
+{ if (t->qlen == t->qmax)
+  { /* grow the ring, its values in order from 0 */
+    int max = (t->qmax > 0) ? 2*t->qmax : 8;
+    int * q = (int *) malloc(max*sizeof(int));
+    int k;
+    if (q == NULL) return FALSE;
+    for (k = 0; k < t->qlen; k++)
+      q[k] = t->queue[(t->qhead+k) % t->qmax];
+    free(t->queue);
+    t->queue = q;
+    t->qhead = 0;
+    t->qmax = max;
+  }
+  t->queue[(t->qhead+t->qlen) % t->qmax] = value;
+  t->qlen++;
+  if (t->state == tsBLOCKED) t->state = tsREADY;
+  return TRUE;
+} /* tmSchedFeed */
+
+/********************************************/
+void tmSchedClose( TMTASK * t )
+{ t->closed = TRUE;
+  /* its IN now fails */
+  if (t->state == tsBLOCKED) t->state = tsREADY;
+} /* tmSchedClose */
+
+/* Function next returns the index of the task of
+ * s to run next, going round from the one after
+ * the task that ran last; -1 if none is ready
+ */
+static int next( TMSCHED * s )
+{ int best = -1, k, i;
+  for (k = 1; k <= s->ntasks; k++)
+  { i = (s->last+k) % s->ntasks;
+    if (s->task[i]->state != tsREADY) continue;
+    if (s->policy == SCHED_ROUND) return i;
+    if ((best < 0) || (s->task[i]->priority > s->task[best]->priority))
+      best = i;
+  }
+  return best;
+}
+
+/********************************************/
+int tmSchedRun( TMSCHED * s )
+{ TMTASK * t;
+  STEPRESULT result;
+  int i, blocked = 0;
+  long k;
+  while ((i = next(s)) >= 0)
+  { TM * tm;
+    t = s->task[i];
+    tm = t->tm;
+    s->last = i;
+    result = srOKAY;
+    for (k = 0; (k < s->slice) && (result == srOKAY); k++)
+      result = tmStep(tm);
+    t->steps += k;
+    if (result == srOKAY) continue;
+    if (t->state == tsBLOCKED)
+    { /* the IN runs again once there is input */
+      int pc = --tm->reg[PC_REG];
+      if (tm->profile != NULL) tm->profile->counts[pc]--;
+      t->steps--;
+    }
+    else
+    { t->state = tsDONE;
+      t->result = result;
+    }
+  }
+  for (i = 0; i < s->ntasks; i++)
+    if (s->task[i]->state == tsBLOCKED) blocked++;
+  return blocked;
+} /* tmSchedRun */
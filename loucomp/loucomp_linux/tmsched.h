@@ -0,0 +1,93 @@
+/****************************************************/
+/* File: tmsched.h                                  */
+/* A scheduler that runs many TM machines, each a   */
+/* task of its own, on one thread: each takes turns */
+/* of at most a slice of instructions, and a task   */
+/* whose IN finds no input waiting is set aside     */
+/* until some is given to it                        */
+/****************************************************/
+
+#ifndef _TMSCHED_H_
+#define _TMSCHED_H_
+
+/* how the next task to run is chosen: in turn
+ * (SCHED_ROUND), or the one of highest priority,
+ * in turn among equals (SCHED_PRIORITY)
+ */
+#define SCHED_ROUND 0
+#define SCHED_PRIORITY 1
+
+typedef enum {
+   tsREADY,   /* can run */
+   tsBLOCKED, /* at an IN, waiting for input */
+   tsDONE     /* stopped, with result */
+   } TASKSTATE;
+
+/* a task: its machine, and the input given to it
+ * that its IN instructions have not read yet.
+ * Once closed, an IN with no input waiting fails
+ * with srIN_ERR instead of blocking
+ */
+typedef struct tmtask
+   { TM * tm;
+     int id; /* from 1, in the order added */
+     int priority;
+     TASKSTATE state;
+     STEPRESULT result; /* once tsDONE */
+     long steps; /* instructions run */
+     int * queue; /* the input, qlen values from qhead */
+     int qhead, qlen, qmax;
+     int closed;
+     struct tmsched * sched;
+   } TMTASK;
+
+/* the tasks of a scheduler, and what OUT does in
+ * any of them: by default it writes "id: value"
+ * to stdout
+ */
+typedef struct tmsched
+   { TMTASK ** task;
+     int ntasks, maxtasks;
+     int policy;
+     long slice; /* instructions in a turn */
+     int last; /* the index of the task that ran last */
+     void (* output) (TMTASK *, int);
+     void * user; /* for output */
+   } TMSCHED;
+
+/* Function tmSchedNew returns a scheduler with no
+ * tasks that chooses by policy and gives each
+ * task turns of slice instructions; NULL if out
+ * of memory
+ */
+TMSCHED * tmSchedNew( int policy, long slice );
+
+/* Procedure tmSchedFree releases s, its tasks and
+ * their machines
+ */
+void tmSchedFree( TMSCHED * s );
+
+/* Function tmSchedAdd adds a task, ready to run,
+ * for machine tm, which s then owns and whose I/O
+ * it takes over; NULL if out of memory
+ */
+TMTASK * tmSchedAdd( TMSCHED * s, TM * tm, int priority );
+
+/* Function tmSchedFeed gives value to the input
+ * of task t, making it ready if it was blocked;
+ * FALSE if out of memory
+ */
+int tmSchedFeed( TMTASK * t, int value );
+
+/* Procedure tmSchedClose notes that task t will
+ * be given no more input
+ */
+void tmSchedClose( TMTASK * t );
+
+/* Function tmSchedRun runs the tasks of s until
+ * none is ready, and returns how many are then
+ * blocked: 0 once all are done
+ */
+int tmSchedRun( TMSCHED * s );
+
+#endif
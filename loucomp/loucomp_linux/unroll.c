@@ -0,0 +1,428 @@
+/****************************************************/
+/* File: unroll.c                                   */
+/* Unrolling of counted repeat loops implementation */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "util.h"
+#include "unroll.h"
+#include "arena.h"
+#include <limits.h>
+
+/* A repeat is counted when its body stores into
+   one variable i, the counter, only by a top-level
+   statement i := i + c (or c + i, or i - c), c a
+   nonzero constant, and its test compares i with
+   an expression E that the body leaves alone and
+   that cannot fault:
+
+      E < i with c > 0, i < E with c < 0,
+      i = E or E = i with either.
+
+   If i is s as the body starts, the next k tests
+   see s+c, s+2c, ..., s+kc, and the first k-1 of
+   them cannot end the loop while s+(k-1)c has not
+   reached E. With k = ctx->unroll the loop becomes
+
+      repeat
+        if <i+(k-1)c has reached E> then body
+        else body; body; ... (k times)
+        end
+      until test
+
+   (the parts of the if swapped for the = tests),
+   so that trips with at least k to go run k
+   bodies for one test, and the remainder run one
+   body each, as before.
+
+   The TM adds with wraparound, and a < b is the
+   sign of the wrapped a - b, so E < s+(k-1)c may
+   fail while E < s+c holds, when s+c is about to
+   pass E the long way round. A < test therefore
+   guards the k bodies with both:
+
+      if <i+c has reached E> then body
+      else if <i+(k-1)c has reached E> then body
+      else body; body; ... (k times)
+      end end
+
+   An = test needs only the one guard, since the
+   counter cannot come round to E again within k
+   trips.
+
+   When the statement before the repeat sets i to
+   a constant and E is a constant, the number of
+   trips n is known, counting as the TM does, and
+   no guard is needed: the
+   n mod k trips of the remainder are run first,
+   by copies of the body placed before the repeat,
+   whose body becomes k copies; a repeat of no
+   more than k trips becomes n copies of its body */
+
+/* UNROLLNODES is the largest body, in nodes, that
+ * is unrolled; the body of an unrolled repeat
+ * grows to k+2 times its size
+ */
+#define UNROLLNODES 64
+
+/* Function countNodes returns the number of nodes
+ * of n, its children and its siblings
+ */
+static int countNodes( CompileCtx * ctx, NodeId n )
+{ int count = 0;
+  int i;
+  while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    count++;
+    for (i=0;i<MAXCHILDREN;i++) count += countNodes(ctx,t->child[i]);
+    n = t->sibling;
+  }
+  return count;
+}
+
+/* Function stores returns the number of statements
+ * in the statements n, at any depth, that store
+ * into the variable at location loc
+ */
+static int stores( CompileCtx * ctx, NodeId n, int loc )
+{ int count = 0;
+  while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    switch (t->kind.stmt) {
+      case IfK :
+        count += stores(ctx,t->child[1],loc) + stores(ctx,t->child[2],loc);
+        break;
+      case RepeatK :
+        count += stores(ctx,t->child[0],loc);
+        break;
+      case AssignK :
+      case ReadK :
+        if (st_lookup(ctx,t->attr.sym) == loc) count++;
+        break;
+      default :
+        break;
+    }
+    n = t->sibling;
+  }
+  return count;
+}
+
+/* Function invariant returns TRUE if expression n
+ * has the same value, without faulting, wherever
+ * it runs in the loop of body: its variables are
+ * not stored into by body, and it divides only by
+ * constants other than 0 and -1
+ */
+static int invariant( CompileCtx * ctx, NodeId n, NodeId body )
+{ TreeNode * t = NODE(ctx,n);
+  TreeNode * d;
+  switch (t->kind.exp) {
+    case ConstK :
+      return TRUE;
+    case IdK :
+      return stores(ctx,body,st_lookup(ctx,t->attr.sym)) == 0;
+    case OpK :
+      if (t->attr.op == OVER)
+      { d = NODE(ctx,t->child[1]);
+        if ((d->kind.exp != ConstK) || (d->attr.val == 0) || (d->attr.val == -1))
+          return FALSE;
+      }
+      return invariant(ctx,t->child[0],body) && invariant(ctx,t->child[1],body);
+    default :
+      return FALSE;
+  }
+}
+
+/* Function stepOf returns TRUE if statement n is
+ * i := i + c, c + i or i - c, with i the variable
+ * at location loc and c a nonzero constant, and
+ * sets *step to how much it adds to i
+ */
+static int stepOf( CompileCtx * ctx, NodeId n, int loc, int * step )
+{ TreeNode * t = NODE(ctx,n);
+  TreeNode * e, * a, * b, * s;
+  if ((t->kind.stmt != AssignK) || (st_lookup(ctx,t->attr.sym) != loc))
+    return FALSE;
+  e = NODE(ctx,t->child[0]);
+  if ((e->kind.exp != OpK) || ((e->attr.op != PLUS) && (e->attr.op != MINUS)))
+    return FALSE;
+  a = NODE(ctx,e->child[0]);
+  b = NODE(ctx,e->child[1]);
+  if ((e->attr.op == PLUS) && (a->kind.exp == ConstK))
+  { s = a; a = b; b = s; }
+  if ((a->kind.exp != IdK) || (st_lookup(ctx,a->attr.sym) != loc)
+      || (b->kind.exp != ConstK) || (b->attr.val == 0) || (b->attr.val == INT_MIN))
+    return FALSE;
+  *step = (e->attr.op == MINUS) ? -b->attr.val : b->attr.val;
+  return TRUE;
+}
+
+/* Function copyTree returns a copy of n, its
+ * children and its siblings; NIL_NODE if out of
+ * memory
+ */
+static NodeId copyTree( CompileCtx * ctx, NodeId n )
+{ TreeNode t;
+  NodeId m, c;
+  int i;
+  m = allocNode(ctx);
+  if (m == NIL_NODE) return NIL_NODE;
+  t = *NODE(ctx,n);
+  for (i=0;i<MAXCHILDREN;i++)
+    if (t.child[i] != NIL_NODE)
+    { c = copyTree(ctx,t.child[i]);
+      if (c == NIL_NODE) return NIL_NODE;
+      t.child[i] = c;
+    }
+  if (t.sibling != NIL_NODE)
+  { c = copyTree(ctx,t.sibling);
+    if (c == NIL_NODE) return NIL_NODE;
+    t.sibling = c;
+  }
+  *NODE(ctx,m) = t;
+  return m;
+}
+
+/* Function copies returns times copies of the
+ * statements body, one after the other, and sets
+ * *last to the last statement; NIL_NODE if out of
+ * memory
+ */
+static NodeId copies( CompileCtx * ctx, NodeId body, int times, NodeId * last )
+{ NodeId head = NIL_NODE, tail = NIL_NODE, c;
+  int i;
+  for (i = 0; i < times; i++)
+  { c = copyTree(ctx,body);
+    if (c == NIL_NODE) return NIL_NODE;
+    if (tail == NIL_NODE) head = c;
+    else NODE(ctx,tail)->sibling = c;
+    tail = c;
+    while (NODE(ctx,tail)->sibling != NIL_NODE) tail = NODE(ctx,tail)->sibling;
+  }
+  *last = tail;
+  return head;
+}
+
+/* Function lastOf returns the last of the
+ * statements n
+ */
+static NodeId lastOf( CompileCtx * ctx, NodeId n )
+{ while (NODE(ctx,n)->sibling != NIL_NODE) n = NODE(ctx,n)->sibling;
+  return n;
+}
+
+/* Function tripCount returns how many times a
+ * counted repeat runs when its counter starts at
+ * s, goes by step and is tested with op against
+ * the constant e, adding and comparing with
+ * wraparound as the TM does; 0 if an = test
+ * would end it only after the counter has gone
+ * round the integers
+ */
+static long tripCount( int op, int s, int step, int e )
+{ int a = (step > 0) ? step : -step;
+  /* how far the counter is from e, in the way
+     that it goes */
+  unsigned int u = (step > 0) ? (unsigned) e - (unsigned) s
+                              : (unsigned) s - (unsigned) e;
+  int left;
+  if (op == EQ)
+  { if ((u == 0) || (u % a != 0)) return 0;
+    return u / a;
+  }
+  /* the sign of what the first test takes the
+     sign of: the test ends the loop at the first
+     trip that takes it below 0 */
+  left = (int) (u - a);
+  if (left < 0) return 1;
+  return (long) (left / a) + 2;
+}
+
+/* Function unrollCounted unrolls repeat n, whose
+ * body runs trips times, and which follows the
+ * statement prev; returns the statement that now
+ * comes before the one after n
+ */
+static NodeId unrollCounted( CompileCtx * ctx, NodeId n, NodeId prev, long trips )
+{ NodeId body = NODE(ctx,n)->child[0];
+  int k = ctx->unroll;
+  NodeId head, last;
+  if (trips <= k)
+  { /* trips copies of the body replace the repeat */
+    if (trips > 1)
+    { head = copies(ctx,body,trips-1,&last);
+      if (head == NIL_NODE) return n;
+      NODE(ctx,last)->sibling = body;
+      body = head;
+    }
+    last = lastOf(ctx,body);
+    NODE(ctx,last)->sibling = NODE(ctx,n)->sibling;
+    NODE(ctx,prev)->sibling = body;
+    return last;
+  }
+  head = copies(ctx,body,k-1,&last);
+  if (head == NIL_NODE) return n;
+  if (trips % k != 0)
+  { /* the remainder, before the repeat */
+    NodeId peel = copies(ctx,body,trips % k,&last);
+    if (peel == NIL_NODE) return n;
+    NODE(ctx,last)->sibling = n;
+    NODE(ctx,prev)->sibling = peel;
+  }
+  NODE(ctx,lastOf(ctx,body))->sibling = head;
+  return n;
+}
+
+/* Function guardAt returns the test that the
+ * counter of repeat n, on side side of its test,
+ * has reached the bound E once dist is added to
+ * it: E < i+dist if boundFirst, else i+dist < E,
+ * or with a constant E, E-dist < i or i < E-dist;
+ * NIL_NODE if E-dist overflows or memory runs out
+ */
+static NodeId guardAt( CompileCtx * ctx, NodeId n, int side, int dist,
+                       int boundFirst )
+{ NodeId test = NODE(ctx,n)->child[1];
+  NodeId bound = NODE(ctx,test)->child[1-side];
+  NodeId counter, bcopy, sum, d, guard;
+  counter = copyTree(ctx,NODE(ctx,test)->child[side]);
+  if (counter == NIL_NODE) return NIL_NODE;
+  if (NODE(ctx,bound)->kind.exp == ConstK)
+  { long c = (long) NODE(ctx,bound)->attr.val - dist;
+    if ((c < INT_MIN) || (c > INT_MAX)) return NIL_NODE;
+    bcopy = newExpNode(ctx,ConstK);
+    if (bcopy == NIL_NODE) return NIL_NODE;
+    NODE(ctx,bcopy)->attr.val = (int) c;
+    NODE(ctx,bcopy)->type = Integer;
+    NODE(ctx,bcopy)->lineno = NODE(ctx,n)->lineno;
+    sum = counter;
+  }
+  else
+  { bcopy = copyTree(ctx,bound);
+    d = newExpNode(ctx,ConstK);
+    sum = newExpNode(ctx,OpK);
+    if ((bcopy == NIL_NODE) || (d == NIL_NODE) || (sum == NIL_NODE))
+      return NIL_NODE;
+    NODE(ctx,d)->attr.val = dist;
+    NODE(ctx,d)->type = Integer;
+    NODE(ctx,sum)->attr.op = PLUS;
+    NODE(ctx,sum)->child[0] = counter;
+    NODE(ctx,sum)->child[1] = d;
+    NODE(ctx,sum)->type = Integer;
+    NODE(ctx,d)->lineno = NODE(ctx,sum)->lineno = NODE(ctx,n)->lineno;
+  }
+  guard = newExpNode(ctx,OpK);
+  if (guard == NIL_NODE) return NIL_NODE;
+  NODE(ctx,guard)->attr.op = LT;
+  NODE(ctx,guard)->child[0] = boundFirst ? bcopy : sum;
+  NODE(ctx,guard)->child[1] = boundFirst ? sum : bcopy;
+  NODE(ctx,guard)->type = Boolean;
+  NODE(ctx,guard)->lineno = NODE(ctx,n)->lineno;
+  return guard;
+}
+
+/* Function unrollRepeat unrolls repeat n, which
+ * follows the statement prev (NIL_NODE if none),
+ * if it is counted; it is left as it is otherwise,
+ * or if memory runs out. Returns the statement
+ * that now comes before the one after n
+ */
+static NodeId unrollRepeat( CompileCtx * ctx, NodeId n, NodeId prev )
+{ NodeId body = NODE(ctx,n)->child[0];
+  NodeId test = NODE(ctx,n)->child[1];
+  TreeNode * e = NODE(ctx,test);
+  TreeNode * p;
+  int k = ctx->unroll;
+  int side, loc, step, op, d;
+  long trips;
+  NodeId s, bound, last, unrolled, guard, ifn;
+  if ((e->kind.exp != OpK) || ((e->attr.op != LT) && (e->attr.op != EQ)))
+    return n;
+  op = e->attr.op;
+  if (countNodes(ctx,body) > UNROLLNODES) return n;
+  /* find the counter, on either side of the test */
+  for (side = 0; side < 2; side++)
+  { TreeNode * v = NODE(ctx,e->child[side]);
+    if (v->kind.exp != IdK) continue;
+    loc = st_lookup(ctx,v->attr.sym);
+    if (stores(ctx,body,loc) != 1) continue;
+    for (s = body; s != NIL_NODE; s = NODE(ctx,s)->sibling)
+      if (stepOf(ctx,s,loc,&step)) break;
+    if (s == NIL_NODE) continue;
+    /* E < i waits for i to go up, i < E for it to go down */
+    if ((op == LT) && ((side == 1) != (step > 0))) continue;
+    if (invariant(ctx,e->child[1-side],body)) break;
+  }
+  if (side == 2) return n;
+  bound = e->child[1-side];
+  /* a known number of trips */
+  if ((prev != NIL_NODE) && (NODE(ctx,bound)->kind.exp == ConstK))
+  { p = NODE(ctx,prev);
+    if ((p->kind.stmt == AssignK) && (st_lookup(ctx,p->attr.sym) == loc)
+        && (NODE(ctx,p->child[0])->kind.exp == ConstK))
+    { trips = tripCount(op,NODE(ctx,p->child[0])->attr.val,step,
+                        NODE(ctx,bound)->attr.val);
+      if (trips > 1) return unrollCounted(ctx,n,prev,trips);
+      if (trips > 0) return n;
+    }
+  }
+  if ((step > 0 ? step : -step) > INT_MAX/(k-1)) return n;
+  d = (k-1)*step;
+  /* the k bodies of the unrolled part */
+  unrolled = copies(ctx,body,k,&last);
+  if (unrolled == NIL_NODE) return n;
+  guard = guardAt(ctx,n,side,d,(step > 0) == (op == LT));
+  ifn = newStmtNode(ctx,IfK);
+  if ((guard == NIL_NODE) || (ifn == NIL_NODE)) return n;
+  NODE(ctx,ifn)->child[0] = guard;
+  /* for =, the guard is TRUE while k trips are
+     sure to be left; for <, while they are not */
+  NODE(ctx,ifn)->child[1] = (op == EQ) ? unrolled : body;
+  NODE(ctx,ifn)->child[2] = (op == EQ) ? body : unrolled;
+  NODE(ctx,ifn)->lineno = NODE(ctx,n)->lineno;
+  if ((op == LT) && (k > 2))
+  { /* the first test must not end the loop either */
+    NodeId outer = newStmtNode(ctx,IfK);
+    NodeId once = copyTree(ctx,body);
+    guard = guardAt(ctx,n,side,step,(step > 0) == (op == LT));
+    if ((outer == NIL_NODE) || (once == NIL_NODE) || (guard == NIL_NODE))
+      return n;
+    NODE(ctx,outer)->child[0] = guard;
+    NODE(ctx,outer)->child[1] = once;
+    NODE(ctx,outer)->child[2] = ifn;
+    NODE(ctx,outer)->lineno = NODE(ctx,n)->lineno;
+    ifn = outer;
+  }
+  NODE(ctx,n)->child[0] = ifn;
+  return n;
+}
+
+/* Procedure unrollSeq unrolls the counted repeats
+ * of the statements n, inner ones first
+ */
+static void unrollSeq( CompileCtx * ctx, NodeId n )
+{ NodeId prev = NIL_NODE;
+  while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    if (t->kind.stmt == IfK)
+    { unrollSeq(ctx,t->child[1]);
+      unrollSeq(ctx,NODE(ctx,n)->child[2]);
+    }
+    else if (t->kind.stmt == RepeatK)
+    { unrollSeq(ctx,t->child[0]);
+      n = unrollRepeat(ctx,n,prev);
+    }
+    prev = n;
+    n = NODE(ctx,n)->sibling;
+  }
+}
+
+/* Procedure unrollLoops unrolls by ctx->unroll
+ * the counted repeats of the statements tree
+ * (inner ones first); the statements themselves
+ * stay where they are
+ */
+void unrollLoops( CompileCtx * ctx, NodeId tree )
+{ if (ctx->unroll > 1) unrollSeq(ctx,tree); }
@@ -0,0 +1,23 @@
+/****************************************************/
+/* File: unroll.h                                   */
+/* Unrolling of counted repeat loops for the TINY   */
+/* compiler                                         */
+/* With -O, a repeat whose test waits for a counter */
+/* to reach a bound runs several copies of its body */
+/* for each test, as long as enough trips are left  */
+/****************************************************/
+
+#ifndef _UNROLL_H_
+#define _UNROLL_H_
+
+/* UNROLLMAX is the largest factor -unroll takes */
+#define UNROLLMAX 16
+
+/* Procedure unrollLoops unrolls by ctx->unroll
+ * the counted repeats of the statements tree
+ * (inner ones first); the statements themselves
+ * stay where they are
+ */
+void unrollLoops( CompileCtx * ctx, NodeId tree );
+
+#endif
@@ -8,11 +8,18 @@
 
 #include "globals.h"
 #include "util.h"
+#include "arena.h"
+#include "symtab.h"
+#include "cse.h"
+#include "sccp.h"
+#include "cgen.h"
+#include "code.h"
+#include "tmeng.h"
 
 /* Procedure printToken prints a token 
  * and its lexeme to the listing file
  */
-void printToken( TokenType token, const char* tokenString )
+void printToken( CompileCtx * ctx, TokenType token, const char* tokenString )
 { switch (token)
   { case IF:
     case THEN:
@@ -22,156 +29,230 @@ void printToken( TokenType token, const char* tokenString )
     case UNTIL:
     case READ:
     case WRITE:
-      fprintf(listing,
+      fprintf(ctx->listing,
          "reserved word: %s\n",tokenString);
       break;
-    case ASSIGN: fprintf(listing,":=\n"); break;
-    case LT: fprintf(listing,"<\n"); break;
-    case EQ: fprintf(listing,"=\n"); break;
-    case LPAREN: fprintf(listing,"(\n"); break;
-    case RPAREN: fprintf(listing,")\n"); break;
-    case SEMI: fprintf(listing,";\n"); break;
-    case PLUS: fprintf(listing,"+\n"); break;
-    case MINUS: fprintf(listing,"-\n"); break;
-    case TIMES: fprintf(listing,"*\n"); break;
-    case OVER: fprintf(listing,"/\n"); break;
-    case ENDFILE: fprintf(listing,"EOF\n"); break;
+    case ASSIGN: fprintf(ctx->listing,":=\n"); break;
+    case LT: fprintf(ctx->listing,"<\n"); break;
+    case EQ: fprintf(ctx->listing,"=\n"); break;
+    case LPAREN: fprintf(ctx->listing,"(\n"); break;
+    case RPAREN: fprintf(ctx->listing,")\n"); break;
+    case SEMI: fprintf(ctx->listing,";\n"); break;
+    case PLUS: fprintf(ctx->listing,"+\n"); break;
+    case MINUS: fprintf(ctx->listing,"-\n"); break;
+    case TIMES: fprintf(ctx->listing,"*\n"); break;
+    case OVER: fprintf(ctx->listing,"/\n"); break;
+    case ENDFILE: fprintf(ctx->listing,"EOF\n"); break;
     case NUM:
-      fprintf(listing,
+      fprintf(ctx->listing,
           "NUM, val= %s\n",tokenString);
       break;
     case ID:
-      fprintf(listing,
+      fprintf(ctx->listing,
           "ID, name= %s\n",tokenString);
       break;
     case ERROR:
-      fprintf(listing,
+      fprintf(ctx->listing,
           "ERROR: %s\n",tokenString);
       break;
     default: /* should never happen */
-      fprintf(listing,"Unknown token: %d\n",token);
+      fprintf(ctx->listing,"Unknown token: %d\n",token);
   }
 }
 
 /* Function newStmtNode creates a new statement
- * node for syntax tree construction
+ * node in the node arena for syntax tree construction
  */
-TreeNode * newStmtNode(StmtKind kind)
-{ TreeNode * t = (TreeNode *) malloc(sizeof(TreeNode));
-  int i;
-  if (t==NULL)
-    fprintf(listing,"Out of memory error at line %d\n",lineno);
+NodeId newStmtNode(CompileCtx * ctx, StmtKind kind)
+{ NodeId n = allocNode(ctx);
+  if (n==NIL_NODE)
+    fprintf(ctx->listing,"Out of memory error at line %d\n",ctx->lineno);
   else {
-    for (i=0;i<MAXCHILDREN;i++) t->child[i] = NULL;
-    t->sibling = NULL;
+    TreeNode * t = NODE(ctx,n);
     t->nodekind = StmtK;
     t->kind.stmt = kind;
-    t->lineno = lineno;
+    t->attr.sym = -1; /* no identifier (yet) */
+    t->lineno = ctx->lineno;
   }
-  return t;
+  return n;
 }
 
 /* Function newExpNode creates a new expression 
- * node for syntax tree construction
+ * node in the node arena for syntax tree construction
  */
-TreeNode * newExpNode(ExpKind kind)
-{ TreeNode * t = (TreeNode *) malloc(sizeof(TreeNode));
-  int i;
-  if (t==NULL)
-    fprintf(listing,"Out of memory error at line %d\n",lineno);
+NodeId newExpNode(CompileCtx * ctx, ExpKind kind)
+{ NodeId n = allocNode(ctx);
+  if (n==NIL_NODE)
+    fprintf(ctx->listing,"Out of memory error at line %d\n",ctx->lineno);
   else {
-    for (i=0;i<MAXCHILDREN;i++) t->child[i] = NULL;
-    t->sibling = NULL;
+    TreeNode * t = NODE(ctx,n);
     t->nodekind = ExpK;
     t->kind.exp = kind;
-    t->lineno = lineno;
+    t->lineno = ctx->lineno;
     t->type = Void;
   }
-  return t;
+  return n;
 }
 
 /* Function copyString allocates and makes a new
- * copy of an existing string
+ * copy of an existing string in the string arena
  */
-char * copyString(char * s)
+char * copyString(CompileCtx * ctx, char * s)
 { int n;
   char * t;
   if (s==NULL) return NULL;
   n = strlen(s)+1;
-  t = malloc(n);
+  t = allocString(ctx,n);
   if (t==NULL)
-    fprintf(listing,"Out of memory error at line %d\n",lineno);
+    fprintf(ctx->listing,"Out of memory error at line %d\n",ctx->lineno);
   else strcpy(t,s);
   return t;
 }
 
-/* Variable indentno is used by printTree to
+/* ctx->indentno is used by printTree to
  * store current number of spaces to indent
  */
-static indentno = 0;
 
 /* macros to increase/decrease indentation */
-#define INDENT indentno+=2
-#define UNINDENT indentno-=2
+#define INDENT ctx->indentno+=2
+#define UNINDENT ctx->indentno-=2
 
 /* printSpaces indents by printing spaces */
-static void printSpaces(void)
+static void printSpaces(CompileCtx * ctx)
 { int i;
-  for (i=0;i<indentno;i++)
-    fprintf(listing," ");
+  for (i=0;i<ctx->indentno;i++)
+    fprintf(ctx->listing," ");
 }
 
 /* procedure printTree prints a syntax tree to the 
  * listing file using indentation to indicate subtrees
  */
-void printTree( TreeNode * tree )
+void printTree( CompileCtx * ctx, NodeId n )
 { int i;
   INDENT;
-  while (tree != NULL) {
-    printSpaces();
+  while (n != NIL_NODE) {
+    TreeNode * tree = NODE(ctx,n);
+    printSpaces(ctx);
     if (tree->nodekind==StmtK)
     { switch (tree->kind.stmt) {
         case IfK:
-          fprintf(listing,"If\n");
+          fprintf(ctx->listing,"If\n");
           break;
         case RepeatK:
-          fprintf(listing,"Repeat\n");
+          fprintf(ctx->listing,"Repeat\n");
           break;
         case AssignK:
-          fprintf(listing,"Assign to: %s\n",tree->attr.name);
+          fprintf(ctx->listing,"Assign to: %s\n",st_name(ctx,tree->attr.sym));
           break;
         case ReadK:
-          fprintf(listing,"Read: %s\n",tree->attr.name);
+          fprintf(ctx->listing,"Read: %s\n",st_name(ctx,tree->attr.sym));
           break;
         case WriteK:
-          fprintf(listing,"Write\n");
+          fprintf(ctx->listing,"Write\n");
           break;
         default:
-          fprintf(listing,"Unknown ExpNode kind\n");
+          fprintf(ctx->listing,"Unknown ExpNode kind\n");
           break;
       }
     }
     else if (tree->nodekind==ExpK)
     { switch (tree->kind.exp) {
         case OpK:
-          fprintf(listing,"Op: ");
-          printToken(tree->attr.op,"\0");
+          fprintf(ctx->listing,"Op: ");
+          printToken(ctx,tree->attr.op,"\0");
           break;
         case ConstK:
-          fprintf(listing,"Const: %d\n",tree->attr.val);
+          fprintf(ctx->listing,"Const: %d\n",tree->attr.val);
           break;
         case IdK:
-          fprintf(listing,"Id: %s\n",tree->attr.name);
+          fprintf(ctx->listing,"Id: %s\n",st_name(ctx,tree->attr.sym));
           break;
         default:
-          fprintf(listing,"Unknown ExpNode kind\n");
+          fprintf(ctx->listing,"Unknown ExpNode kind\n");
           break;
       }
     }
-    else fprintf(listing,"Unknown node kind\n");
+    else fprintf(ctx->listing,"Unknown node kind\n");
     for (i=0;i<MAXCHILDREN;i++)
-         printTree(tree->child[i]);
-    tree = tree->sibling;
+         printTree(ctx,tree->child[i]);
+    n = tree->sibling;
   }
   UNINDENT;
 }
+
+/* Function newContext allocates a context
+ * for one compilation, with every phase in
+ * its initial state
+ */
+CompileCtx * newContext(void)
+{ CompileCtx * ctx = (CompileCtx *) calloc(1,sizeof(CompileCtx));
+  if (ctx != NULL)
+  { ctx->Error = FALSE;
+    ctx->EOF_flag = FALSE;
+    ctx->nodeTop = 1; /* slot 0 is NIL_NODE */
+  }
+  return ctx;
+}
+
+/* Procedure resetContext puts a context used
+ * before back into the state newContext gives,
+ * keeping the memory of its node arena, symbol
+ * table, traversal stack and code image so that
+ * the next compilation need not allocate it again
+ */
+void resetContext(CompileCtx * ctx)
+{ CompileCtx old;
+  resetArena(ctx);
+  st_reset(ctx);
+  free(ctx->varHome);
+  free(ctx->globalSym);
+  cseFree(ctx);
+  propagateFree(ctx);
+  layoutFree(ctx);
+  peepFree(ctx);
+  /* an unloaded TM holds HALT 0,0,0 everywhere,
+     and locations not emitted have no line */
+  if (ctx->image != NULL)
+    memset(ctx->image,0,ctx->imageCap*sizeof(INSTRUCTION));
+  if (ctx->srcLines != NULL)
+    memset(ctx->srcLines,0,ctx->srcLinesCap*sizeof(int));
+  old = *ctx;
+  memset(ctx,0,sizeof(CompileCtx));
+  ctx->Error = FALSE;
+  ctx->EOF_flag = FALSE;
+  ctx->nodeTop = 1; /* slot 0 is NIL_NODE */
+  ctx->nodeArena = old.nodeArena;
+  ctx->nodeCap = old.nodeCap;
+  ctx->strBlocks = old.strBlocks;
+  ctx->symbols = old.symbols;
+  ctx->maxsymbols = old.maxsymbols;
+  ctx->hashTable = old.hashTable;
+  ctx->tableSize = old.tableSize;
+  ctx->stack = old.stack;
+  ctx->maxdepth = old.maxdepth;
+  ctx->typeErrors = old.typeErrors;
+  ctx->maxtypeErrors = old.maxtypeErrors;
+  ctx->image = old.image;
+  ctx->imageCap = old.imageCap;
+  ctx->srcLines = old.srcLines;
+  ctx->srcLinesCap = old.srcLinesCap;
+}
+
+/* Procedure freeContext releases a context
+ * and everything allocated through it
+ */
+void freeContext(CompileCtx * ctx)
+{ freeArena(ctx);
+  st_free(ctx);
+  free(ctx->stack);
+  free(ctx->typeErrors);
+  free(ctx->image);
+  free(ctx->srcLines);
+  free(ctx->varHome);
+  free(ctx->globalSym);
+  cseFree(ctx);
+  propagateFree(ctx);
+  layoutFree(ctx);
+  peepFree(ctx);
+  free(ctx);
+}
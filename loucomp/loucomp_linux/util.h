@@ -11,26 +11,45 @@
 /* Procedure printToken prints a token 
  * and its lexeme to the listing file
  */
-void printToken( TokenType, const char* );
+void printToken( CompileCtx *, TokenType, const char* );
 
 /* Function newStmtNode creates a new statement
- * node for syntax tree construction
+ * node in the node arena for syntax tree construction
  */
-TreeNode * newStmtNode(StmtKind);
+NodeId newStmtNode(CompileCtx *, StmtKind);
 
 /* Function newExpNode creates a new expression 
- * node for syntax tree construction
+ * node in the node arena for syntax tree construction
  */
-TreeNode * newExpNode(ExpKind);
+NodeId newExpNode(CompileCtx *, ExpKind);
 
 /* Function copyString allocates and makes a new
- * copy of an existing string
+ * copy of an existing string in the string arena
  */
-char * copyString( char * );
+char * copyString( CompileCtx *, char * );
 
 /* procedure printTree prints a syntax tree to the 
  * listing file using indentation to indicate subtrees
  */
-void printTree( TreeNode * );
+void printTree( CompileCtx *, NodeId );
+
+/* Function newContext allocates a context
+ * for one compilation, with every phase in
+ * its initial state
+ */
+CompileCtx * newContext(void);
+
+/* Procedure resetContext puts a context used
+ * before back into the state newContext gives,
+ * keeping the memory of its node arena, symbol
+ * table, traversal stack and code image so that
+ * the next compilation need not allocate it again
+ */
+void resetContext(CompileCtx *);
+
+/* Procedure freeContext releases a context
+ * and everything allocated through it
+ */
+void freeContext(CompileCtx *);
 
 #endif
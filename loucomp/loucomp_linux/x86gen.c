@@ -0,0 +1,392 @@
+/****************************************************/
+/* File: x86gen.c                                   */
+/* The x86-64 code generator implementation         */
+/* for the TINY compiler                            */
+/* (generates GNU assembler for Linux)              */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "x86gen.h"
+#include "arena.h"
+#include "stats.h"
+#include <stdarg.h>
+
+/* The program becomes the function main. Its
+   variables live in the callee-saved registers
+   below, the busiest ones first, and the rest in
+   4-byte slots of main's stack frame, under the
+   saved registers. Expressions are computed in
+   %eax, with the right operand of an operator in
+   %ecx or used straight from its home; a left
+   operand waiting for a complex right one is
+   pushed on the machine stack. Arithmetic is
+   32-bit and wraps, as on the TM, and a < b is
+   the sign of a - b, as in the code of cgen.c */
+
+#define NXREGS 5
+static const char * xreg[NXREGS] =
+   { "%ebx", "%r12d", "%r13d", "%r14d", "%r15d" };
+static const char * xreg64[NXREGS] =
+   { "%rbx", "%r12", "%r13", "%r14", "%r15" };
+
+/* ctx->varHome[loc] is the home of the variable at
+   memory location loc: -1 if it has none yet, a
+   register below NXREGS, or stack slot
+   varHome[loc]-NXREGS */
+#define NO_HOME (-1)
+
+/* Procedure emit prints one instruction */
+static void emit( CompileCtx * ctx, const char * fmt, ... )
+{ va_list args;
+  va_start(args,fmt);
+  putc('\t',ctx->code);
+  vfprintf(ctx->code,fmt,args);
+  putc('\n',ctx->code);
+  va_end(args);
+  ctx->ninstructions++;
+}
+
+/* Procedure emitLabel prints local label n */
+static void emitLabel( CompileCtx * ctx, int n )
+{ fprintf(ctx->code,".L%d:\n",n); }
+
+/* Procedure xComment prints a comment line */
+static void xComment( CompileCtx * ctx, char * c )
+{ if (TraceCode) fprintf(ctx->code,"# %s\n",c); }
+
+/* Function newHome gives the variable at location
+ * loc the next free register or stack slot
+ */
+static void newHome( CompileCtx * ctx, int loc )
+{ if (loc >= ctx->nhomes)
+  { int n = (ctx->nhomes == 0) ? 64 : 2*ctx->nhomes;
+    int i;
+    while (n <= loc) n *= 2;
+    ctx->varHome = (int *) realloc(ctx->varHome,n*sizeof(int));
+    countAlloc(ctx,n*sizeof(int));
+    for (i=ctx->nhomes;i<n;i++) ctx->varHome[i] = NO_HOME;
+    ctx->nhomes = n;
+  }
+  if (ctx->nregVars < NXREGS)
+    ctx->varHome[loc] = ctx->nregVars++;
+  else
+    ctx->varHome[loc] = NXREGS + ctx->nslots++;
+}
+
+/* Function home prints the operand for variable
+ * sym into buf and returns buf
+ */
+static char * home( CompileCtx * ctx, int sym, char * buf )
+{ int loc = st_lookup(ctx,sym);
+  int h;
+  if ((loc >= ctx->nhomes) || (ctx->varHome[loc] == NO_HOME))
+    newHome(ctx,loc);
+  h = ctx->varHome[loc];
+  if (h < NXREGS) strcpy(buf,xreg[h]);
+  /* the saved registers take -8 to -8*NXREGS */
+  else sprintf(buf,"%d(%%rbp)",-8*NXREGS-4*(h-NXREGS+1));
+  return buf;
+}
+
+/* Function simple returns TRUE if expression n
+ * can be used as an operand without computing it
+ */
+static int simple( CompileCtx * ctx, NodeId n )
+{ TreeNode * t = NODE(ctx,n);
+  return (t->nodekind == ExpK)
+      && ((t->kind.exp == ConstK) || (t->kind.exp == IdK));
+}
+
+/* Function operand prints simple expression n as
+ * an operand into buf and returns buf
+ */
+static char * operand( CompileCtx * ctx, NodeId n, char * buf )
+{ TreeNode * t = NODE(ctx,n);
+  if (t->kind.exp == ConstK)
+  { sprintf(buf,"$%d",t->attr.val);
+    return buf;
+  }
+  return home(ctx,t->attr.sym,buf);
+}
+
+static void genExp( CompileCtx * ctx, NodeId n );
+
+/* Procedure genOperands computes the left operand
+ * of operator t into %eax, and prints the right
+ * one as an operand into right
+ */
+static void genOperands( CompileCtx * ctx, TreeNode * t, char * right )
+{ NodeId p1 = t->child[0];
+  NodeId p2 = t->child[1];
+  if (simple(ctx,p2))
+  { genExp(ctx,p1);
+    operand(ctx,p2,right);
+  }
+  else
+  { genExp(ctx,p1);
+    emit(ctx,"pushq\t%%rax");
+    genExp(ctx,p2);
+    emit(ctx,"movl\t%%eax, %%ecx");
+    emit(ctx,"popq\t%%rax");
+    strcpy(right,"%ecx");
+  }
+}
+
+/* Procedure genExp generates code to compute
+ * expression n into %eax
+ */
+static void genExp( CompileCtx * ctx, NodeId n )
+{ TreeNode * t = NODE(ctx,n);
+  char right[32];
+  switch (t->kind.exp) {
+    case ConstK :
+      emit(ctx,"movl\t$%d, %%eax",t->attr.val);
+      break;
+    case IdK :
+      emit(ctx,"movl\t%s, %%eax",home(ctx,t->attr.sym,right));
+      break;
+    case OpK :
+      if (TraceCode) xComment(ctx,"-> Op");
+      genOperands(ctx,t,right);
+      switch (t->attr.op) {
+        case PLUS :
+          emit(ctx,"addl\t%s, %%eax",right);
+          break;
+        case MINUS :
+          emit(ctx,"subl\t%s, %%eax",right);
+          break;
+        case TIMES :
+          emit(ctx,"imull\t%s, %%eax",right);
+          break;
+        case OVER :
+          if (strcmp(right,"%ecx") != 0)
+            emit(ctx,"movl\t%s, %%ecx",right);
+          emit(ctx,"testl\t%%ecx, %%ecx");
+          emit(ctx,"je\t.Ldivzero");
+          emit(ctx,"cltd");
+          emit(ctx,"idivl\t%%ecx");
+          break;
+        case LT :
+          /* the sign bit of a - b */
+          emit(ctx,"subl\t%s, %%eax",right);
+          emit(ctx,"shrl\t$31, %%eax");
+          break;
+        case EQ :
+          emit(ctx,"cmpl\t%s, %%eax",right);
+          emit(ctx,"sete\t%%al");
+          emit(ctx,"movzbl\t%%al, %%eax");
+          break;
+        default:
+          xComment(ctx,"BUG: Unknown operator");
+          break;
+      }
+      if (TraceCode) xComment(ctx,"<- Op");
+      break;
+    default:
+      break;
+  }
+}
+
+/* Procedure genJumpFalse generates code to jump
+ * to label false when test expression n is 0; a
+ * comparison jumps on its flags without making
+ * its value
+ */
+static void genJumpFalse( CompileCtx * ctx, NodeId n, int label )
+{ TreeNode * t = NODE(ctx,n);
+  char right[32];
+  if ((t->kind.exp == OpK) && (t->attr.op == LT))
+  { genOperands(ctx,t,right);
+    emit(ctx,"subl\t%s, %%eax",right);
+    emit(ctx,"jns\t.L%d",label);
+  }
+  else if ((t->kind.exp == OpK) && (t->attr.op == EQ))
+  { genOperands(ctx,t,right);
+    emit(ctx,"cmpl\t%s, %%eax",right);
+    emit(ctx,"jne\t.L%d",label);
+  }
+  else
+  { genExp(ctx,n);
+    emit(ctx,"testl\t%%eax, %%eax");
+    emit(ctx,"je\t.L%d",label);
+  }
+}
+
+static void xGen( CompileCtx * ctx, NodeId n );
+
+/* Procedure genStmt generates code at a statement node */
+static void genStmt( CompileCtx * ctx, TreeNode * t )
+{ char dest[32];
+  int l1, l2;
+  switch (t->kind.stmt) {
+    case IfK :
+      if (TraceCode) xComment(ctx,"-> if");
+      l1 = ctx->nlabels++;
+      genJumpFalse(ctx,t->child[0],l1);
+      xGen(ctx,t->child[1]);
+      if (t->child[2] != NIL_NODE)
+      { l2 = ctx->nlabels++;
+        emit(ctx,"jmp\t.L%d",l2);
+        emitLabel(ctx,l1);
+        xGen(ctx,t->child[2]);
+        emitLabel(ctx,l2);
+      }
+      else emitLabel(ctx,l1);
+      if (TraceCode) xComment(ctx,"<- if");
+      break;
+    case RepeatK :
+      if (TraceCode) xComment(ctx,"-> repeat");
+      l1 = ctx->nlabels++;
+      emitLabel(ctx,l1);
+      xGen(ctx,t->child[0]);
+      genJumpFalse(ctx,t->child[1],l1);
+      if (TraceCode) xComment(ctx,"<- repeat");
+      break;
+    case AssignK :
+      if (TraceCode) xComment(ctx,"-> assign");
+      home(ctx,t->attr.sym,dest);
+      if (NODE(ctx,t->child[0])->kind.exp == ConstK)
+        emit(ctx,"movl\t$%d, %s",NODE(ctx,t->child[0])->attr.val,dest);
+      else
+      { genExp(ctx,t->child[0]);
+        emit(ctx,"movl\t%%eax, %s",dest);
+      }
+      if (TraceCode) xComment(ctx,"<- assign");
+      break;
+    case ReadK :
+      emit(ctx,"call\ttinyRead@PLT");
+      emit(ctx,"movl\t%%eax, %s",home(ctx,t->attr.sym,dest));
+      break;
+    case WriteK :
+      genExp(ctx,t->child[0]);
+      emit(ctx,"movl\t%%eax, %%edi");
+      emit(ctx,"call\ttinyWrite@PLT");
+      break;
+    default:
+      break;
+  }
+}
+
+/* Procedure xGen generates code for a sequence
+ * of statements
+ */
+static void xGen( CompileCtx * ctx, NodeId n )
+{ while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    if (t->nodekind == StmtK) genStmt(ctx,t);
+    n = t->sibling;
+  }
+}
+
+/* Procedure countUses adds to use[loc] the uses
+ * of each variable in tree n, a use inside d
+ * repeat loops counting 8^d times
+ */
+static void countUses( CompileCtx * ctx, NodeId n, long * use, int depth )
+{ while (n != NIL_NODE)
+  { TreeNode * t = NODE(ctx,n);
+    int i, d = depth;
+    if ((t->nodekind == StmtK) && (t->kind.stmt == RepeatK) && (d < 6)) d++;
+    if (((t->nodekind == ExpK) && (t->kind.exp == IdK))
+        || ((t->nodekind == StmtK)
+            && ((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK))))
+    { int loc = st_lookup(ctx,t->attr.sym);
+      if (loc >= 0) use[loc] += 1L << (3*d);
+    }
+    for (i=0;i<MAXCHILDREN;i++)
+      countUses(ctx,t->child[i],use,d);
+    n = t->sibling;
+  }
+}
+
+/* Procedure rankVariables gives the registers to
+ * the most used variables of the whole program
+ */
+static void rankVariables( CompileCtx * ctx, NodeId syntaxTree )
+{ long * use;
+  int i, k;
+  if (ctx->location == 0) return;
+  use = (long *) calloc(ctx->location,sizeof(long));
+  countAlloc(ctx,ctx->location*sizeof(long));
+  countUses(ctx,syntaxTree,use,0);
+  for (k=0;k<NXREGS;k++)
+  { int best = -1;
+    for (i=0;i<ctx->location;i++)
+      if ((use[i] > 0) && ((best < 0) || (use[i] > use[best])))
+        best = i;
+    if (best < 0) break;
+    newHome(ctx,best);
+    use[best] = 0;
+  }
+  free(use);
+}
+
+/**********************************************/
+/* the primary function of the code generator */
+/**********************************************/
+/* Procedure x86Gen generates x86-64 assembly to
+ * the code file by traversal of the syntax tree.
+ * The second parameter (codefile) is the file
+ * name of the code file, and is used to print
+ * the file name as a comment in the code file
+ */
+void x86Gen(CompileCtx * ctx, NodeId syntaxTree, char * codefile)
+{  rankVariables(ctx,syntaxTree);
+   x86GenBegin(ctx,codefile);
+   xGen(ctx,syntaxTree);
+   x86GenEnd(ctx);
+}
+
+/* Procedure x86GenBegin emits the heading and
+ * the prologue of main to the code file
+ */
+void x86GenBegin(CompileCtx * ctx, char * codefile)
+{  int i;
+   fprintf(ctx->code,"# TINY Compilation to x86-64 assembly\n");
+   fprintf(ctx->code,"# File: %s\n",codefile);
+   fprintf(ctx->code,"\t.text\n\t.globl\tmain\n\t.type\tmain, @function\n");
+   fprintf(ctx->code,"main:\n");
+   emit(ctx,"pushq\t%%rbp");
+   emit(ctx,"movq\t%%rsp, %%rbp");
+   for (i=0;i<NXREGS;i++)
+     emit(ctx,"pushq\t%s",xreg64[i]);
+   for (i=0;i<NXREGS;i++)
+     emit(ctx,"xorl\t%s, %s",xreg[i],xreg[i]);
+   /* the stack slots are known only at the end */
+   emit(ctx,"jmp\t.Lframe");
+   fprintf(ctx->code,".Lbody:\n");
+}
+
+/* Procedure x86GenStmt emits the code of one
+ * top-level statement
+ */
+void x86GenStmt(CompileCtx * ctx, NodeId stmt)
+{  xGen(ctx,stmt); }
+
+/* Procedure x86GenEnd emits the epilogue of
+ * main and the size of its stack frame
+ */
+void x86GenEnd(CompileCtx * ctx)
+{  int i, size;
+   xComment(ctx,"End of execution.");
+   emit(ctx,"xorl\t%%eax, %%eax");
+   emit(ctx,"leaq\t%d(%%rbp), %%rsp",-8*NXREGS);
+   for (i=NXREGS-1;i>=0;i--)
+     emit(ctx,"popq\t%s",xreg64[i]);
+   emit(ctx,"popq\t%%rbp");
+   emit(ctx,"ret");
+   /* the frame keeps %rsp 16-byte aligned at calls;
+      every variable starts out as 0 */
+   size = (4*ctx->nslots+8+15)/16*16 - 8;
+   fprintf(ctx->code,".Lframe:\n");
+   emit(ctx,"subq\t$%d, %%rsp",size);
+   for (i=0;i<ctx->nslots;i++)
+     emit(ctx,"movl\t$0, %d(%%rbp)",-8*NXREGS-4*(i+1));
+   emit(ctx,"jmp\t.Lbody");
+   fprintf(ctx->code,".Ldivzero:\n");
+   emit(ctx,"andq\t$-16, %%rsp");
+   emit(ctx,"call\ttinyDivZero@PLT");
+   fprintf(ctx->code,"\t.size\tmain, .-main\n");
+   fprintf(ctx->code,"\t.section\t.note.GNU-stack,\"\",@progbits\n");
+}
@@ -0,0 +1,42 @@
+/****************************************************/
+/* File: x86gen.h                                   */
+/* The x86-64 code generator interface to the       */
+/* TINY compiler                                    */
+/* The code is GNU assembler (AT&T syntax) for      */
+/* Linux; read and write call the runtime in        */
+/* tinyrt.c, so a program is built with            */
+/*    cc -o prog prog.s tinyrt.o                    */
+/****************************************************/
+
+#ifndef _X86GEN_H_
+#define _X86GEN_H_
+
+/* Procedure x86Gen generates x86-64 assembly to
+ * the code file by traversal of the syntax tree.
+ * The second parameter (codefile) is the file
+ * name of the code file, and is used to print
+ * the file name as a comment in the code file
+ */
+void x86Gen(CompileCtx * ctx, NodeId syntaxTree, char * codefile);
+
+/* x86Gen is x86GenBegin, then x86GenStmt for each
+ * top-level statement, then x86GenEnd; the
+ * streaming mode calls these as it goes
+ */
+
+/* Procedure x86GenBegin emits the heading and
+ * the prologue of main to the code file
+ */
+void x86GenBegin(CompileCtx * ctx, char * codefile);
+
+/* Procedure x86GenStmt emits the code of one
+ * top-level statement
+ */
+void x86GenStmt(CompileCtx * ctx, NodeId stmt);
+
+/* Procedure x86GenEnd emits the epilogue of
+ * main and the size of its stack frame
+ */
+void x86GenEnd(CompileCtx * ctx);
+
+#endif
@@ -50,13 +50,7 @@
 /* Yacc/Bison generates its own integer values
  * for tokens
  */
-typedef int TokenType; 
-
-extern FILE* source; /* source code text file */
-extern FILE* listing; /* listing output text file */
-extern FILE* code; /* code text file for TM simulator */
-
-extern int lineno; /* source line number for listing */
+typedef int TokenType;
 
 /**************************************************/
 /***********   Syntax tree for parsing ************/
@@ -71,18 +65,170 @@ typedef enum {Void,Integer,Boolean} ExpType;
 
 #define MAXCHILDREN 3
 
+/* nodes are held in a contiguous arena (see arena.h)
+ * and refer to each other by 32-bit index; index
+ * NIL_NODE stands for "no node"
+ */
+typedef unsigned int NodeId;
+#define NIL_NODE 0
+
+/* the kinds and type are stored in single bytes
+ * to keep the node compact
+ */
 typedef struct treeNode
-   { struct treeNode * child[MAXCHILDREN];
-     struct treeNode * sibling;
-     int lineno;
-     NodeKind nodekind;
-     union { StmtKind stmt; ExpKind exp;} kind;
-     union { TokenType op;
+   { union { TokenType op;
              int val;
-             char * name; } attr;
-     ExpType type; /* for type checking of exps */
+             int sym; /* symbol id, see st_intern */ } attr;
+     NodeId child[MAXCHILDREN];
+     NodeId sibling;
+     int lineno;
+     unsigned char nodekind; /* NodeKind */
+     union { unsigned char stmt; /* StmtKind */
+             unsigned char exp; /* ExpKind */ } kind;
+     unsigned char type; /* ExpType, for type checking of exps */
    } TreeNode;
 
+/**************************************************/
+/***********   Compilation context     ************/
+/**************************************************/
+
+/* MAXTOKENLEN is the maximum size of a token */
+#define MAXTOKENLEN 40
+
+/* BUFLEN = length of the input buffer for
+   source code lines */
+#define BUFLEN 256
+
+/* the phases -stats reports on; scanning is
+ * driven by the parser and counts as parsing
+ */
+typedef enum { PH_PARSE, PH_ANALYZE, PH_CODEGEN } Phase;
+#define NPHASES 3
+
+/* PhaseStats holds what one phase did: the wall
+ * time it took, the tokens it scanned, the nodes
+ * it built, the symbols it entered in the
+ * symbol table, the number and size of its
+ * allocations, and the TM instructions it
+ * emitted
+ */
+typedef struct
+   { double seconds;
+     long tokens;
+     long nodes;
+     long symbols;
+     long allocs;
+     long allocBytes;
+     long instructions;
+   } PhaseStats;
+
+/* CompileCtx holds all of the state of one
+ * compilation, so that several programs can be
+ * compiled at once, one per thread. Every phase
+ * takes the context as its first parameter; the
+ * fields below a phase's heading belong to it
+ * and are not touched by the others
+ */
+typedef struct compileCtx
+   { FILE * source; /* source code text file */
+     FILE * listing; /* listing output text file */
+     FILE * code; /* code text file (TM, x86-64 or LLVM IR) */
+     int lineno; /* source line number for listing */
+     /* Error = TRUE prevents further passes if an error occurs */
+     int Error;
+
+     /* scanner (scan.c) */
+     char tokenString[MAXTOKENLEN+1]; /* lexeme of last token */
+     int tokenSym; /* symbol id of the last ID token */
+     char lineBuf[BUFLEN]; /* holds the current line */
+     int linepos; /* current position in lineBuf */
+     int bufsize; /* current size of buffer string */
+     int EOF_flag; /* corrects ungetNextChar behavior on EOF */
+
+     /* parser (parse.c) */
+     TokenType token; /* holds current token */
+     int topStmts; /* top-level statements handed out by parseNext */
+     int parseDone; /* TRUE once parseNext has reached the end */
+     int pipelined; /* TRUE to scan in a thread of its own (see pipe.c) */
+     struct PipeRec * pipe; /* that thread and its ring, while it runs */
+
+     /* tree printing (util.c) */
+     int indentno; /* current number of spaces to indent */
+
+     /* node and string arena (arena.c) */
+     TreeNode * nodeArena;
+     NodeId nodeTop; /* next free node slot */
+     NodeId nodeCap; /* number of slots in nodeArena */
+     long nodesReleased; /* nodes given back by resetNodes */
+     struct StrBlockRec * strBlocks;
+
+     /* symbol table (symtab.c) */
+     struct SymbolRec * symbols;
+     int nsymbols;
+     int maxsymbols;
+     int nvariables;
+     int * hashTable;
+     unsigned tableSize;
+     struct LineChunkRec * lineChunks;
+     int linesLeft;
+
+     /* semantic analyzer (analyze.c) */
+     int location; /* counter for variable memory locations */
+     struct FrameRec * stack; /* explicit traversal stack */
+     int maxdepth;
+     struct TypeErrorRec * typeErrors;
+     int ntypeErrors;
+     int maxtypeErrors;
+
+     /* constant propagation (sccp.c) */
+     struct PropRec * prop; /* its state, once it has run */
+
+     /* loop unrolling (unroll.c) */
+     int unroll; /* bodies per test of a counted repeat */
+
+     /* code generator (cgen.c) */
+     int tmpOffset; /* memory offset for temps */
+     int optimize; /* TRUE for -O: reuse computed values */
+     struct CseRec * cse; /* value numbering state (cse.c) */
+     struct tmprofile * profile; /* TM profile for the layout, or NULL */
+     struct LayoutRec * layout; /* the layout made from it */
+
+     /* x86-64 code generator (x86gen.c) */
+     int * varHome; /* register or stack slot of each variable */
+     int nhomes; /* number of entries in varHome */
+     int nregVars; /* variables given a register */
+     int nslots; /* variables given a stack slot */
+     int nlabels; /* local labels used */
+
+     /* LLVM IR code generator (llvmgen.c) */
+     int * globalSym; /* symbol of each variable location, or -1 */
+     int nglobals; /* number of entries in globalSym */
+     int ntemps; /* temporaries used */
+     int nblocks; /* blocks used */
+
+     /* code emitter (code.c) */
+     int emitLoc; /* TM location for current instruction */
+     int highEmitLoc; /* highest TM location emitted so far */
+     int keepImage; /* TRUE to keep the instructions in image */
+     struct instruction * image; /* the code, for tiny -run */
+     int imageCap; /* number of slots in image */
+     int codeLine; /* source line of the code being emitted */
+     int * srcLines; /* source line of each location, 0 if none */
+     int srcLinesCap; /* number of slots in srcLines */
+     int srcLinesBase; /* location of srcLines[0] */
+     struct PeepRec * peep; /* the code waiting to be written, with -O */
+
+     /* statistics (stats.c); the counters are kept
+        by every phase, and stats[] is filled in as
+        each phase ends */
+     long ntokens; /* tokens scanned */
+     long ninstructions; /* TM instructions emitted */
+     long nallocs; /* allocations made */
+     long allocBytes; /* bytes allocated */
+     PhaseStats phaseStart; /* the counters as the phase began */
+     PhaseStats stats[NPHASES];
+   } CompileCtx;
+
 /**************************************************/
 /***********   Flags for tracing       ************/
 /**************************************************/
@@ -115,6 +261,7 @@ extern int TraceAnalyze;
  */
 extern int TraceCode;
 
-/* Error = TRUE prevents further passes if an error occurs */
-extern int Error; 
+/* The tracing flags are shared by every compilation
+ * and must not change while a compilation runs
+ */
 #endif
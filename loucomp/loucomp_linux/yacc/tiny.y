@@ -11,11 +11,13 @@
 #include "util.h"
 #include "scan.h"
 #include "parse.h"
+#include "arena.h"
 
-#define YYSTYPE TreeNode *
-static char * savedName; /* for use in assignments */
+#define YYSTYPE NodeId
+static CompileCtx * ctx; /* context of the current parse */
+static int savedSym; /* for use in assignments */
 static int savedLineNo;  /* ditto */
-static TreeNode * savedTree; /* stores syntax tree for later return */
+static NodeId savedTree; /* stores syntax tree for later return */
 
 %}
 
@@ -31,10 +33,10 @@ program     : stmt_seq
             ;
 stmt_seq    : stmt_seq SEMI stmt
                  { YYSTYPE t = $1;
-                   if (t != NULL)
-                   { while (t->sibling != NULL)
-                        t = t->sibling;
-                     t->sibling = $3;
+                   if (t != NIL_NODE)
+                   { while (NODE(ctx,t)->sibling != NIL_NODE)
+                        t = NODE(ctx,t)->sibling;
+                     NODE(ctx,t)->sibling = $3;
                      $$ = $1; }
                      else $$ = $3;
                  }
@@ -45,108 +47,106 @@ stmt        : if_stmt { $$ = $1; }
             | assign_stmt { $$ = $1; }
             | read_stmt { $$ = $1; }
             | write_stmt { $$ = $1; }
-            | error  { $$ = NULL; }
+            | error  { $$ = NIL_NODE; }
             ;
 if_stmt     : IF exp THEN stmt_seq END
-                 { $$ = newStmtNode(IfK);
-                   $$->child[0] = $2;
-                   $$->child[1] = $4;
+                 { $$ = newStmtNode(ctx,IfK);
+                   NODE(ctx,$$)->child[0] = $2;
+                   NODE(ctx,$$)->child[1] = $4;
                  }
             | IF exp THEN stmt_seq ELSE stmt_seq END
-                 { $$ = newStmtNode(IfK);
-                   $$->child[0] = $2;
-                   $$->child[1] = $4;
-                   $$->child[2] = $6;
+                 { $$ = newStmtNode(ctx,IfK);
+                   NODE(ctx,$$)->child[0] = $2;
+                   NODE(ctx,$$)->child[1] = $4;
+                   NODE(ctx,$$)->child[2] = $6;
                  }
             ;
 repeat_stmt : REPEAT stmt_seq UNTIL exp
-                 { $$ = newStmtNode(RepeatK);
-                   $$->child[0] = $2;
-                   $$->child[1] = $4;
+                 { $$ = newStmtNode(ctx,RepeatK);
+                   NODE(ctx,$$)->child[0] = $2;
+                   NODE(ctx,$$)->child[1] = $4;
                  }
             ;
-assign_stmt : ID { savedName = copyString(tokenString);
-                   savedLineNo = lineno; }
+assign_stmt : ID { savedSym = ctx->tokenSym;
+                   savedLineNo = ctx->lineno; }
               ASSIGN exp
-                 { $$ = newStmtNode(AssignK);
-                   $$->child[0] = $4;
-                   $$->attr.name = savedName;
-                   $$->lineno = savedLineNo;
+                 { $$ = newStmtNode(ctx,AssignK);
+                   NODE(ctx,$$)->child[0] = $4;
+                   NODE(ctx,$$)->attr.sym = savedSym;
+                   NODE(ctx,$$)->lineno = savedLineNo;
                  }
             ;
 read_stmt   : READ ID
-                 { $$ = newStmtNode(ReadK);
-                   $$->attr.name =
-                     copyString(tokenString);
+                 { $$ = newStmtNode(ctx,ReadK);
+                   NODE(ctx,$$)->attr.sym = ctx->tokenSym;
                  }
             ;
 write_stmt  : WRITE exp
-                 { $$ = newStmtNode(WriteK);
-                   $$->child[0] = $2;
+                 { $$ = newStmtNode(ctx,WriteK);
+                   NODE(ctx,$$)->child[0] = $2;
                  }
             ;
 exp         : simple_exp LT simple_exp 
-                 { $$ = newExpNode(OpK);
-                   $$->child[0] = $1;
-                   $$->child[1] = $3;
-                   $$->attr.op = LT;
+                 { $$ = newExpNode(ctx,OpK);
+                   NODE(ctx,$$)->child[0] = $1;
+                   NODE(ctx,$$)->child[1] = $3;
+                   NODE(ctx,$$)->attr.op = LT;
                  }
             | simple_exp EQ simple_exp
-                 { $$ = newExpNode(OpK);
-                   $$->child[0] = $1;
-                   $$->child[1] = $3;
-                   $$->attr.op = EQ;
+                 { $$ = newExpNode(ctx,OpK);
+                   NODE(ctx,$$)->child[0] = $1;
+                   NODE(ctx,$$)->child[1] = $3;
+                   NODE(ctx,$$)->attr.op = EQ;
                  }
             | simple_exp { $$ = $1; }
             ;
 simple_exp  : simple_exp PLUS term 
-                 { $$ = newExpNode(OpK);
-                   $$->child[0] = $1;
-                   $$->child[1] = $3;
-                   $$->attr.op = PLUS;
+                 { $$ = newExpNode(ctx,OpK);
+                   NODE(ctx,$$)->child[0] = $1;
+                   NODE(ctx,$$)->child[1] = $3;
+                   NODE(ctx,$$)->attr.op = PLUS;
                  }
             | simple_exp MINUS term
-                 { $$ = newExpNode(OpK);
-                   $$->child[0] = $1;
-                   $$->child[1] = $3;
-                   $$->attr.op = MINUS;
+                 { $$ = newExpNode(ctx,OpK);
+                   NODE(ctx,$$)->child[0] = $1;
+                   NODE(ctx,$$)->child[1] = $3;
+                   NODE(ctx,$$)->attr.op = MINUS;
                  } 
             | term { $$ = $1; }
             ;
 term        : term TIMES factor 
-                 { $$ = newExpNode(OpK);
-                   $$->child[0] = $1;
-                   $$->child[1] = $3;
-                   $$->attr.op = TIMES;
+                 { $$ = newExpNode(ctx,OpK);
+                   NODE(ctx,$$)->child[0] = $1;
+                   NODE(ctx,$$)->child[1] = $3;
+                   NODE(ctx,$$)->attr.op = TIMES;
                  }
             | term OVER factor
-                 { $$ = newExpNode(OpK);
-                   $$->child[0] = $1;
-                   $$->child[1] = $3;
-                   $$->attr.op = OVER;
+                 { $$ = newExpNode(ctx,OpK);
+                   NODE(ctx,$$)->child[0] = $1;
+                   NODE(ctx,$$)->child[1] = $3;
+                   NODE(ctx,$$)->attr.op = OVER;
                  }
             | factor { $$ = $1; }
             ;
 factor      : LPAREN exp RPAREN
                  { $$ = $2; }
             | NUM
-                 { $$ = newExpNode(ConstK);
-                   $$->attr.val = atoi(tokenString);
+                 { $$ = newExpNode(ctx,ConstK);
+                   NODE(ctx,$$)->attr.val = atoi(ctx->tokenString);
                  }
-            | ID { $$ = newExpNode(IdK);
-                   $$->attr.name =
-                         copyString(tokenString);
+            | ID { $$ = newExpNode(ctx,IdK);
+                   NODE(ctx,$$)->attr.sym = ctx->tokenSym;
                  }
-            | error { $$ = NULL; }
+            | error { $$ = NIL_NODE; }
             ;
 
 %%
 
 int yyerror(char * message)
-{ fprintf(listing,"Syntax error at line %d: %s\n",lineno,message);
-  fprintf(listing,"Current token: ");
-  printToken(yychar,tokenString);
-  Error = TRUE;
+{ fprintf(ctx->listing,"Syntax error at line %d: %s\n",ctx->lineno,message);
+  fprintf(ctx->listing,"Current token: ");
+  printToken(ctx,yychar,ctx->tokenString);
+  ctx->Error = TRUE;
   return 0;
 }
 
@@ -154,10 +154,26 @@ int yyerror(char * message)
  * compatible with ealier versions of the TINY scanner
  */
 static int yylex(void)
-{ return getToken(); }
+{ return getToken(ctx); }
 
-TreeNode * parse(void)
-{ yyparse();
+/* the Yacc/Bison parser is not reentrant, so
+ * only one parse may run at a time
+ */
+NodeId parse(CompileCtx * c)
+{ ctx = c;
+  yyparse();
   return savedTree;
 }
 
+/* Function parseNext hands out the program for
+ * the streaming mode; yyparse only returns once
+ * the whole program is parsed, so the first call
+ * returns all of it as one statement sequence
+ * and later calls return NIL_NODE
+ */
+NodeId parseNext(CompileCtx * c)
+{ if (c->parseDone) return NIL_NODE;
+  c->parseDone = TRUE;
+  return parse(c);
+}
+
@@ -1,3 +1,3 @@
 #!/bin/sh 
 lex tiny.l
-yacc -d tiny.y
+bison -d -o y.tab.c tiny.y
@@ -29,13 +29,14 @@
 /* the name of the following file may change */
 #include "y.tab.h"
 
+#endif
+
 /* ENDFILE is implicitly defined by Yacc/Bison,
- * and not included in the tab.h file
+ * and not included in the tab.h file; the
+ * parser itself needs it to end its input
  */
 #define ENDFILE 0
 
-#endif
-
 #ifndef FALSE
 #define FALSE 0
 #endif
@@ -47,6 +48,9 @@
 /* MAXRESERVED = the number of reserved words */
 #define MAXRESERVED 8
 
+/* MAXTOKENLEN is the maximum size of a token */
+#define MAXTOKENLEN 40
+
 /* Yacc/Bison generates its own integer values
  * for tokens
  */
@@ -13,4 +13,38 @@
  */
 TreeNode * parse(void);
 
+/* parse is built on a push parser, which is
+ * handed the tokens of a program in chunks as
+ * they are scanned, so that a program can be
+ * parsed while it is still arriving
+ */
+
+/* a token as handed to the parser: its kind,
+ * its lexeme and the line it was found on
+ */
+typedef struct
+   { TokenType kind;
+     int lineno;
+     char text[MAXTOKENLEN+1];
+   } Token;
+
+typedef struct ParserRec * Parser;
+
+/* Function newParser returns a parser that
+ * has not yet been given any tokens
+ */
+Parser newParser(void);
+
+/* Function parseTokens hands the next n tokens
+ * of the program to parser p; the last token of
+ * the program is ENDFILE. Returns TRUE while p
+ * expects more tokens
+ */
+int parseTokens(Parser p, Token * tokens, int n);
+
+/* Function endParse releases parser p and
+ * returns the syntax tree it built
+ */
+TreeNode * endParse(Parser p);
+
 #endif
@@ -8,10 +8,9 @@
 #ifndef _SCAN_H_
 #define _SCAN_H_
 
-/* MAXTOKENLEN is the maximum size of a token */
-#define MAXTOKENLEN 40
-
-/* tokenString array stores the lexeme of each token */
+/* tokenString array stores the lexeme of each token
+ * (MAXTOKENLEN is in globals.h)
+ */
 extern char tokenString[MAXTOKENLEN+1];
 
 /* function getToken returns the 
@@ -1,6 +1,9 @@
 /****************************************************/
 /* File: tiny.y                                     */
 /* The TINY Yacc/Bison specification file           */
+/* A pure push parser: tokens are handed to it in   */
+/* chunks by parseTokens, and all of its state      */
+/* lives in a Parser record                         */
 /* Compiler Construction: Principles and Practice   */
 /* Kenneth C. Louden                                */
 /****************************************************/
@@ -12,33 +15,97 @@
 #include "scan.h"
 #include "parse.h"
 
-#define YYSTYPE TreeNode *
-static char * savedName; /* for use in assignments */
-static int savedLineNo;  /* ditto */
-static TreeNode * savedTree; /* stores syntax tree for later return */
-
 %}
 
+%code requires {
+/* this block is also copied to y.tab.h, which
+ * globals.h includes before TreeNode is defined
+ */
+struct treeNode;
+struct ParserRec;
+
+/* a statement sequence is kept with a pointer to
+ * its last statement, so that appending a
+ * statement takes constant time
+ */
+typedef struct
+   { struct treeNode * head;
+     struct treeNode * tail;
+   } StmtSeq;
+
+/* the semantic value of an ID or NUM token */
+typedef struct
+   { char * name;
+     int val;
+     int lineno;
+   } TokenVal;
+}
+
+%code {
+/* the state of a parse: bison's own state, the
+ * token being pushed (for error messages and for
+ * the line numbers of new nodes) and the tree
+ */
+struct ParserRec
+   { yypstate * ps;
+     Token * current;
+     TreeNode * tree;
+     int status; /* YYPUSH_MORE until the parse ends */
+   };
+
+static void yyerror(Parser p, const char * message);
+
+/* stmtNode and expNode create nodes carrying the
+ * line of the token being pushed, which is the
+ * last token the scanner had read when the node
+ * is built
+ */
+static TreeNode * stmtNode(Parser p, StmtKind kind)
+{ TreeNode * t = newStmtNode(kind);
+  if (t != NULL) t->lineno = p->current->lineno;
+  return t;
+}
+
+static TreeNode * expNode(Parser p, ExpKind kind)
+{ TreeNode * t = newExpNode(kind);
+  if (t != NULL) t->lineno = p->current->lineno;
+  return t;
+}
+}
+
+%define api.pure full
+%define api.push-pull push
+%parse-param {struct ParserRec * p}
+
+%union { struct treeNode * tree;
+         StmtSeq seq;
+         TokenVal tok;
+       }
+
 %token IF THEN ELSE END REPEAT UNTIL READ WRITE
-%token ID NUM 
+%token <tok> ID NUM
 %token ASSIGN EQ LT PLUS MINUS TIMES OVER LPAREN RPAREN SEMI
-%token ERROR 
+%token ERROR
+
+%type <seq> stmt_seq
+%type <tree> stmt if_stmt repeat_stmt assign_stmt read_stmt write_stmt
+%type <tree> exp simple_exp term factor
 
 %% /* Grammar for TINY */
 
 program     : stmt_seq
-                 { savedTree = $1;} 
+                 { p->tree = $1.head;}
             ;
 stmt_seq    : stmt_seq SEMI stmt
-                 { YYSTYPE t = $1;
-                   if (t != NULL)
-                   { while (t->sibling != NULL)
-                        t = t->sibling;
-                     t->sibling = $3;
-                     $$ = $1; }
-                     else $$ = $3;
+                 { $$ = $1;
+                   if ($3 != NULL)
+                   { if ($$.tail != NULL)
+                       $$.tail->sibling = $3;
+                     else $$.head = $3;
+                     $$.tail = $3;
+                   }
                  }
-            | stmt  { $$ = $1; }
+            | stmt  { $$.head = $$.tail = $1; }
             ;
 stmt        : if_stmt { $$ = $1; }
             | repeat_stmt { $$ = $1; }
@@ -48,79 +115,76 @@ stmt        : if_stmt { $$ = $1; }
             | error  { $$ = NULL; }
             ;
 if_stmt     : IF exp THEN stmt_seq END
-                 { $$ = newStmtNode(IfK);
+                 { $$ = stmtNode(p,IfK);
                    $$->child[0] = $2;
-                   $$->child[1] = $4;
+                   $$->child[1] = $4.head;
                  }
             | IF exp THEN stmt_seq ELSE stmt_seq END
-                 { $$ = newStmtNode(IfK);
+                 { $$ = stmtNode(p,IfK);
                    $$->child[0] = $2;
-                   $$->child[1] = $4;
-                   $$->child[2] = $6;
+                   $$->child[1] = $4.head;
+                   $$->child[2] = $6.head;
                  }
             ;
 repeat_stmt : REPEAT stmt_seq UNTIL exp
-                 { $$ = newStmtNode(RepeatK);
-                   $$->child[0] = $2;
+                 { $$ = stmtNode(p,RepeatK);
+                   $$->child[0] = $2.head;
                    $$->child[1] = $4;
                  }
             ;
-assign_stmt : ID { savedName = copyString(tokenString);
-                   savedLineNo = lineno; }
-              ASSIGN exp
-                 { $$ = newStmtNode(AssignK);
-                   $$->child[0] = $4;
-                   $$->attr.name = savedName;
-                   $$->lineno = savedLineNo;
+assign_stmt : ID ASSIGN exp
+                 { $$ = stmtNode(p,AssignK);
+                   $$->child[0] = $3;
+                   $$->attr.name = $1.name;
+                   $$->lineno = $1.lineno;
                  }
             ;
 read_stmt   : READ ID
-                 { $$ = newStmtNode(ReadK);
-                   $$->attr.name =
-                     copyString(tokenString);
+                 { $$ = stmtNode(p,ReadK);
+                   $$->attr.name = $2.name;
                  }
             ;
 write_stmt  : WRITE exp
-                 { $$ = newStmtNode(WriteK);
+                 { $$ = stmtNode(p,WriteK);
                    $$->child[0] = $2;
                  }
             ;
-exp         : simple_exp LT simple_exp 
-                 { $$ = newExpNode(OpK);
+exp         : simple_exp LT simple_exp
+                 { $$ = expNode(p,OpK);
                    $$->child[0] = $1;
                    $$->child[1] = $3;
                    $$->attr.op = LT;
                  }
             | simple_exp EQ simple_exp
-                 { $$ = newExpNode(OpK);
+                 { $$ = expNode(p,OpK);
                    $$->child[0] = $1;
                    $$->child[1] = $3;
                    $$->attr.op = EQ;
                  }
             | simple_exp { $$ = $1; }
             ;
-simple_exp  : simple_exp PLUS term 
-                 { $$ = newExpNode(OpK);
+simple_exp  : simple_exp PLUS term
+                 { $$ = expNode(p,OpK);
                    $$->child[0] = $1;
                    $$->child[1] = $3;
                    $$->attr.op = PLUS;
                  }
             | simple_exp MINUS term
-                 { $$ = newExpNode(OpK);
+                 { $$ = expNode(p,OpK);
                    $$->child[0] = $1;
                    $$->child[1] = $3;
                    $$->attr.op = MINUS;
-                 } 
+                 }
             | term { $$ = $1; }
             ;
-term        : term TIMES factor 
-                 { $$ = newExpNode(OpK);
+term        : term TIMES factor
+                 { $$ = expNode(p,OpK);
                    $$->child[0] = $1;
                    $$->child[1] = $3;
                    $$->attr.op = TIMES;
                  }
             | term OVER factor
-                 { $$ = newExpNode(OpK);
+                 { $$ = expNode(p,OpK);
                    $$->child[0] = $1;
                    $$->child[1] = $3;
                    $$->attr.op = OVER;
@@ -130,29 +194,95 @@ term        : term TIMES factor
 factor      : LPAREN exp RPAREN
                  { $$ = $2; }
             | NUM
-                 { $$ = newExpNode(ConstK);
-                   $$->attr.val = atoi(tokenString);
+                 { $$ = expNode(p,ConstK);
+                   $$->attr.val = $1.val;
                  }
-            | ID { $$ = newExpNode(IdK);
-                   $$->attr.name =
-                         copyString(tokenString);
+            | ID { $$ = expNode(p,IdK);
+                   $$->attr.name = $1.name;
                  }
             | error { $$ = NULL; }
             ;
 
 %%
 
-int yyerror(char * message)
-{ fprintf(listing,"Syntax error at line %d: %s\n",lineno,message);
+static void yyerror(Parser p, const char * message)
+{ fprintf(listing,"Syntax error at line %d: %s\n",
+          p->current->lineno,message);
   fprintf(listing,"Current token: ");
-  printToken(yychar,tokenString);
+  printToken(p->current->kind,p->current->text);
   Error = TRUE;
-  return 0;
 }
 
+/* Function newParser returns a parser that
+ * has not yet been given any tokens
+ */
+Parser newParser(void)
+{ Parser p = (Parser) malloc(sizeof(struct ParserRec));
+  if (p == NULL) return NULL;
+  p->ps = yypstate_new();
+  p->current = NULL;
+  p->tree = NULL;
+  p->status = YYPUSH_MORE;
+  if (p->ps == NULL)
+  { free(p);
+    return NULL;
+  }
+  return p;
+}
 
-TreeNode * parse(void)
-{ yyparse();
-  return savedTree;
+/* Function parseTokens hands the next n tokens
+ * of the program to parser p; the last token of
+ * the program is ENDFILE. Returns TRUE while p
+ * expects more tokens
+ */
+int parseTokens(Parser p, Token * tokens, int n)
+{ int i;
+  for (i=0;(i<n) && (p->status == YYPUSH_MORE);i++)
+  { YYSTYPE lval;
+    p->current = &tokens[i];
+    lval.tok.lineno = tokens[i].lineno;
+    lval.tok.name = NULL;
+    lval.tok.val = 0;
+    if (tokens[i].kind == ID)
+      lval.tok.name = copyString(tokens[i].text);
+    else if (tokens[i].kind == NUM)
+      lval.tok.val = atoi(tokens[i].text);
+    p->status = yypush_parse(p->ps,tokens[i].kind,&lval,p);
+  }
+  p->current = NULL;
+  return p->status == YYPUSH_MORE;
+}
+
+/* Function endParse releases parser p and
+ * returns the syntax tree it built
+ */
+TreeNode * endParse(Parser p)
+{ TreeNode * t = p->tree;
+  yypstate_delete(p->ps);
+  free(p);
+  return t;
 }
 
+/* TOKENCHUNK is the number of tokens the
+ * scanner reads before they are parsed
+ */
+#define TOKENCHUNK 256
+
+/* Function parse returns the newly
+ * constructed syntax tree
+ */
+TreeNode * parse(void)
+{ Token tokens[TOKENCHUNK];
+  Parser p = newParser();
+  int more = (p != NULL);
+  while (more)
+  { int n = 0;
+    do
+    { tokens[n].kind = getToken();
+      tokens[n].lineno = lineno;
+      strcpy(tokens[n].text,tokenString);
+    } while ((tokens[n++].kind != ENDFILE) && (n < TOKENCHUNK));
+    more = parseTokens(p,tokens,n) && (tokens[n-1].kind != ENDFILE);
+  }
+  return (p == NULL) ? NULL : endParse(p);
+}